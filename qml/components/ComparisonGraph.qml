@@ -72,6 +72,14 @@ ChartView {
         timeAxis.max = Math.max(15, comparisonModel.maxTime + 0.5)
     }
 
+    // Curves are decimated to the plot width (peaks kept)
+    Binding {
+        target: chart.comparisonModel
+        property: "viewportWidth"
+        value: Math.round(chart.plotArea.width)
+        when: chart.comparisonModel !== null
+    }
+
     onComparisonModelChanged: loadData()
     Component.onCompleted: loadData()
 
@@ -14,7 +14,9 @@ ChartView {
     margins.left: 0
     margins.right: 0
 
-    // Data to display (set from parent)
+    // Data to display (set from parent): either a ShotSeries, filled with one
+    // replace() per line, or point arrays appended one at a time
+    property ShotSeries shotSeries: null
     property var pressureData: []
     property var flowData: []
     property var temperatureData: []
@@ -24,6 +26,17 @@ ChartView {
 
     // Load data into series
     function loadData() {
+        if (shotSeries) {
+            shotSeries.fill(pressureSeries, "pressure")
+            shotSeries.fill(flowSeries, "flow")
+            shotSeries.fill(temperatureSeries, "temperature")
+            shotSeries.fill(weightSeries, "weight")
+            if (!shotSeries.empty) {
+                timeAxis.max = Math.max(5, maxTime + 2)
+            }
+            return
+        }
+
         pressureSeries.clear()
         flowSeries.clear()
         temperatureSeries.clear()
@@ -49,8 +62,14 @@ ChartView {
     }
 
     onPressureDataChanged: loadData()
+    onShotSeriesChanged: loadData()
     Component.onCompleted: loadData()
 
+    Connections {
+        target: chart.shotSeries
+        function onLoaded() { chart.loadData() }
+    }
+
     // Time axis
     ValueAxis {
         id: timeAxis
@@ -91,6 +110,7 @@ ChartView {
 
     // Weight axis (right Y) - scaled to max weight in data + 10%
     property double maxWeight: {
+        if (shotSeries) return Math.max(10, shotSeries.maxWeight * 1.1)
         var max = 0
         for (var i = 0; i < weightData.length; i++) {
             if (weightData[i].y > max) max = weightData[i].y
@@ -0,0 +1,116 @@
+import QtQuick
+import DecenzaDE1
+
+// Live shot graph drawn by ShotChartItem (scene graph geometry) instead of QtCharts.
+// Same data, axes ranges and phase labels as ShotGraph, much cheaper per frame.
+Item {
+    id: graph
+
+    property double minTime: 5.0
+    property double paddingPixels: Theme.scaled(5)
+    property double weightMax: Math.max(10, (MainController.targetWeight || 36) * 1.1)
+
+    // Same axis growth as ShotGraph: data fills the plot with a few pixels of padding
+    property double timeMax: Math.max(minTime, ShotDataModel.rawTime * plot.width / Math.max(1, plot.width - paddingPixels))
+    property int timeTicks: Math.min(7, Math.max(3, Math.floor(timeMax / 10) + 2))
+
+    Rectangle {
+        id: plot
+        x: Theme.scaled(28)
+        y: Theme.scaled(6)
+        width: parent.width - x - Theme.scaled(28)
+        height: parent.height - y - Theme.scaled(22)
+        color: Qt.darker(Theme.surfaceColor, 1.3)
+
+        // Horizontal grid (pressure axis ticks)
+        Repeater {
+            model: 5
+            delegate: Rectangle {
+                required property int index
+                width: plot.width
+                height: 1
+                y: plot.height - index * plot.height / 4
+                color: Qt.rgba(255, 255, 255, 0.1)
+            }
+        }
+
+        ShotChartItem {
+            anchors.fill: parent
+            model: ShotDataModel
+            timeMax: graph.timeMax
+            pressureMax: 12
+            temperatureMin: 80
+            temperatureMax: 100
+            weightMax: graph.weightMax
+            lineWidth: Theme.scaled(3)
+            goalLineWidth: Theme.scaled(2)
+            pressureColor: Theme.pressureColor
+            flowColor: Theme.flowColor
+            temperatureColor: Theme.temperatureColor
+            weightColor: Theme.weightColor
+            pressureGoalColor: Theme.pressureGoalColor
+            flowGoalColor: Theme.flowGoalColor
+            temperatureGoalColor: Theme.temperatureGoalColor
+            extractionMarkerColor: Theme.accentColor
+        }
+
+        // Frame marker labels
+        Repeater {
+            model: ShotDataModel.phaseMarkers
+
+            delegate: Text {
+                required property var modelData
+                property bool isStart: modelData.label === "Start"
+                x: (modelData.time / graph.timeMax) * plot.width + Theme.scaled(4)
+                y: Theme.scaled(8) + width
+                visible: modelData.time <= graph.timeMax
+                text: modelData.label
+                font.pixelSize: Theme.scaled(18)
+                font.bold: isStart
+                color: isStart ? Theme.accentColor : Qt.rgba(255, 255, 255, 0.8)
+                rotation: -90
+                transformOrigin: Item.TopLeft
+            }
+        }
+    }
+
+    // Pressure/flow axis labels (left)
+    Repeater {
+        model: 5
+        delegate: Text {
+            required property int index
+            x: plot.x - width - Theme.scaled(4)
+            y: plot.y + plot.height - index * plot.height / 4 - height / 2
+            text: index * 3
+            color: Theme.textSecondaryColor
+            font: Theme.captionFont
+        }
+    }
+
+    // Weight axis labels (right)
+    Repeater {
+        model: 5
+        delegate: Text {
+            required property int index
+            x: plot.x + plot.width + Theme.scaled(4)
+            y: plot.y + plot.height - index * plot.height / 4 - height / 2
+            text: Math.round(index * graph.weightMax / 4)
+            color: Theme.weightColor
+            font: Theme.captionFont
+        }
+    }
+
+    // Time axis labels
+    Repeater {
+        model: graph.timeTicks
+        delegate: Text {
+            required property int index
+            property double value: index * graph.timeMax / (graph.timeTicks - 1)
+            x: plot.x + index * plot.width / (graph.timeTicks - 1) - width / 2
+            y: plot.y + plot.height + Theme.scaled(2)
+            text: value.toFixed(0)
+            color: Theme.textSecondaryColor
+            font: Theme.captionFont
+        }
+    }
+}
@@ -33,6 +33,15 @@ ChartView {
     property double minTime: 5.0
     property double paddingPixels: Theme.scaled(5)
     property double plotWidth: Math.max(1, chart.plotArea.width)
+    onPlotWidthChanged: ShotDataModel.viewportWidth = Math.round(plotWidth)
+
+    // Flushes ride on this window's frames while the graph is on screen; hidden, nothing is flushed
+    // and the samples that arrive meanwhile go in with the first frame after it is shown again
+    Binding {
+        target: ShotDataModel
+        property: "graphWindow"
+        value: chart.visible ? chart.Window.window : null
+    }
     property double calculatedMax: ShotDataModel.rawTime * plotWidth / Math.max(1, plotWidth - paddingPixels)
 
     // Time axis - fills frame, expands only when data pushes against right edge
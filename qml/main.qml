@@ -1170,6 +1170,7 @@ ApplicationWindow {
             case "manual": return "Stopped manually"
             case "weight": return "Target weight reached"
             case "machine": return "Profile complete - DE1 stopped the shot"
+            case "saveFailed": return "Shot could not be saved to history"
             default: return "Shot ended"
         }
     }
@@ -1916,6 +1917,13 @@ ApplicationWindow {
             stopOverlayTimer.restart()
             goToShotMetadata(MainController.lastSavedShotId)
         }
+
+        function onShotSaveFailed() {
+            console.warn("Shot could not be saved to history")
+            root.stopReason = "saveFailed"
+            root.stopOverlayVisible = true
+            stopOverlayTimer.restart()
+        }
     }
 
     // Auto-wake: Exit screensaver when scheduled wake time is reached
@@ -246,12 +246,27 @@ Page {
 
     // ========== END ACCESSIBILITY ANNOUNCEMENTS ==========
 
-    // Full-screen shot graph
-    ShotGraph {
+    // Full-screen shot graph - the scene graph renderer is opt-in ("graph/nativeRenderer")
+    // for devices where QtCharts is too slow
+    Loader {
         id: shotGraph
         anchors.fill: parent
         anchors.topMargin: Theme.scaled(50)
         anchors.bottomMargin: Theme.scaled(100)
+        sourceComponent: {
+            var native = Settings.value("graph/nativeRenderer", false)
+            return (native === true || native === "true") ? nativeShotGraphComponent : shotGraphComponent
+        }
+    }
+
+    Component {
+        id: shotGraphComponent
+        ShotGraph {}
+    }
+
+    Component {
+        id: nativeShotGraphComponent
+        NativeShotGraph {}
     }
 
     // Status indicator for preheating
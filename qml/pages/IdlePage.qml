@@ -44,6 +44,12 @@ Page {
             id: fakeShowMetadataTimer
             interval: 300
             onTriggered: {
+                // DEV: Wait for a save still running on the storage worker
+                if (MainController.savingShot) {
+                    fakeSaveWait.enabled = true
+                    return
+                }
+                fakeSaveWait.enabled = false
                 // DEV: Show post-shot review with most recent shot (if any)
                 var shotId = MainController.lastSavedShotId
                 console.log("DEV: Opening PostShotReviewPage with shotId:", shotId)
@@ -51,6 +57,16 @@ Page {
             }
         }
 
+        Connections {
+            id: fakeSaveWait
+            target: MainController
+            enabled: false
+
+            function onSavingShotChanged() {
+                if (!MainController.savingShot) fakeShowMetadataTimer.triggered()
+            }
+        }
+
         MouseArea {
             anchors.fill: parent
             onPressed: fakeShortHoldTimer.start()
@@ -29,10 +29,18 @@ Page {
 
     function loadShot() {
         if (shotId > 0) {
-            shotData = MainController.shotHistory.getShot(shotId)
+            // Metadata only - the graph reads the curves through detailSeries, and the
+            // AI summary fetches the full record when it is requested
+            shotData = MainController.shotHistory.getShot(shotId, false)
         }
     }
 
+    ShotSeries {
+        id: detailSeries
+        storage: MainController.shotHistory
+        shotId: shotDetailPage.shotId
+    }
+
     function navigateToShot(index) {
         if (index >= 0 && index < shotIds.length) {
             currentIndex = index
@@ -104,10 +112,7 @@ Page {
                 HistoryShotGraph {
                     anchors.fill: parent
                     anchors.margins: Theme.spacingSmall
-                    pressureData: shotData.pressure || []
-                    flowData: shotData.flow || []
-                    temperatureData: shotData.temperature || []
-                    weightData: shotData.weight || []
+                    shotSeries: detailSeries
                     phaseMarkers: shotData.phases || []
                     maxTime: shotData.duration || 60
                 }
@@ -843,8 +848,9 @@ Page {
                 id: aiButtonArea
                 anchors.fill: parent
                 onClicked: {
-                    // Generate shot summary from historical data
-                    shotDetailPage.pendingShotSummary = MainController.aiManager.generateHistoryShotSummary(shotData)
+                    // Generate shot summary from historical data (needs the full record with curves)
+                    shotDetailPage.pendingShotSummary = MainController.aiManager.generateHistoryShotSummary(
+                        MainController.shotHistory.getShot(shotDetailPage.shotId))
                     // Open conversation overlay
                     conversationOverlay.visible = true
                 }
@@ -893,7 +899,9 @@ Page {
                 id: emailButtonArea
                 anchors.fill: parent
                 onClicked: {
-                    var prompt = MainController.aiManager.generateHistoryShotSummary(shotData)
+                    // The prompt's curve samples need the full record, not the metadata in shotData
+                    var prompt = MainController.aiManager.generateHistoryShotSummary(
+                        MainController.shotHistory.getShot(shotDetailPage.shotId))
                     var subject = "Espresso AI Analysis - " + (shotData.profileName || "Shot")
                     Qt.openUrlExternally("mailto:?subject=" + encodeURIComponent(subject) + "&body=" + encodeURIComponent(prompt))
                 }
@@ -34,10 +34,6 @@ Page {
     }
 
     property var selectedShots: []
-    property int currentOffset: 0
-    property int pageSize: 50
-    property bool hasMoreShots: true
-    property bool isLoadingMore: false
     property int filteredTotalCount: 0
 
     Component.onCompleted: {
@@ -53,31 +49,15 @@ Page {
     }
 
     function loadShots() {
-        currentOffset = 0
-        hasMoreShots = true
         var filter = buildFilter()
-        var shots = MainController.shotHistory.getShotsFiltered(filter, 0, pageSize)
-        shotListModel.clear()
-        for (var i = 0; i < shots.length; i++) {
-            shotListModel.append(shots[i])
-        }
-        currentOffset = shots.length
-        hasMoreShots = shots.length >= pageSize
+        // Pages are read off the GUI thread; assigning the filter always starts from the first page
+        shotListModel.filter = filter
         // Get total count matching current filter
         filteredTotalCount = MainController.shotHistory.getFilteredShotCount(filter)
     }
 
     function loadMoreShots() {
-        if (isLoadingMore || !hasMoreShots) return
-        isLoadingMore = true
-        var filter = buildFilter()
-        var shots = MainController.shotHistory.getShotsFiltered(filter, currentOffset, pageSize)
-        for (var i = 0; i < shots.length; i++) {
-            shotListModel.append(shots[i])
-        }
-        currentOffset += shots.length
-        hasMoreShots = shots.length >= pageSize
-        isLoadingMore = false
+        shotListModel.loadMore()
     }
 
     // Get filter values from the model arrays directly (more reliable than currentText)
@@ -207,11 +187,7 @@ Page {
             return selectedShots.slice().sort(function(a, b) { return a - b })
         } else {
             // Return all loaded shots from the model
-            var ids = []
-            for (var i = 0; i < shotListModel.count; i++) {
-                ids.push(shotListModel.get(i).id)
-            }
-            return ids
+            return shotListModel.shotIds()
         }
     }
 
@@ -223,8 +199,10 @@ Page {
         })
     }
 
-    ListModel {
+    ShotHistoryListModel {
         id: shotListModel
+        storage: MainController.shotHistory
+        pageSize: 50
     }
 
     // Filter bar
@@ -381,7 +359,7 @@ Page {
 
             // Infinite scroll - load more when near bottom
             onContentYChanged: {
-                if (!isLoadingMore && hasMoreShots && contentHeight > 0) {
+                if (!shotListModel.loading && shotListModel.hasMore && contentHeight > 0) {
                     var threshold = contentHeight - height - Theme.scaled(200)
                     if (contentY > threshold) {
                         loadMoreShots()
@@ -587,8 +565,8 @@ Page {
             // Loading indicator footer
             footer: Item {
                 width: shotListView.width
-                height: isLoadingMore ? Theme.scaled(50) : 0
-                visible: isLoadingMore
+                height: shotListModel.loading ? Theme.scaled(50) : 0
+                visible: shotListModel.loading
 
                 Text {
                     anchors.centerIn: parent
@@ -29,12 +29,14 @@ ShotSummary ShotSummarizer::summarize(const ShotDataModel* shotData,
         summary.profileType = profile->mode() == Profile::Mode::FrameBased ? "Frame-based" : "Direct Control";
     }
 
-    // Get the data vectors
-    const auto& pressureData = shotData->pressureData();
-    const auto& flowData = shotData->flowData();
-    const auto& tempData = shotData->temperatureData();
-    const auto& weightFlowData = shotData->weightData();  // Flow rate from scale (g/s)
-    const auto& cumulativeWeightData = shotData->cumulativeWeightData();  // Cumulative weight (g)
+    // Share the sample columns (no copy) and read them through views
+    summary.samples = shotData->samples();
+    const ShotSampleStore& samples = summary.samples;
+    const ShotSeriesView pressureData = samples.series(ShotSampleStore::Pressure);
+    const ShotSeriesView flowData = samples.series(ShotSampleStore::Flow);
+    const ShotSeriesView tempData = samples.series(ShotSampleStore::Temperature);
+    const ShotSeriesView weightFlowData = samples.weight(true);  // Flow rate from scale (g/s)
+    const ShotSeriesView cumulativeWeightData = samples.weight();  // Cumulative weight (g)
 
     if (pressureData.isEmpty()) {
         return summary;
@@ -47,9 +49,9 @@ ShotSummary ShotSummarizer::summarize(const ShotDataModel* shotData,
     summary.weightCurve = weightFlowData;  // Flow rate useful for AI analysis (detecting channeling spikes)
 
     // Store target/goal curves (what the profile intended)
-    summary.pressureGoalCurve = shotData->pressureGoalData();
-    summary.flowGoalCurve = shotData->flowGoalData();
-    summary.tempGoalCurve = shotData->temperatureGoalData();
+    summary.pressureGoalCurve = samples.goal(ShotSampleStore::PressureGoal);
+    summary.flowGoalCurve = samples.goal(ShotSampleStore::FlowGoal);
+    summary.tempGoalCurve = samples.series(ShotSampleStore::TemperatureGoal);
 
     // Overall metrics
     summary.totalDuration = pressureData.last().x();
@@ -73,7 +75,7 @@ ShotSummary ShotSummarizer::summarize(const ShotDataModel* shotData,
 
     // Temperature stability check - compare actual vs TARGET (not just variance)
     // A declining temperature profile is intentional, not "unstable"
-    const auto& tempGoalData = shotData->temperatureGoalData();
+    const ShotSeriesView& tempGoalData = summary.tempGoalCurve;
     if (!tempGoalData.isEmpty()) {
         // Calculate average deviation from target
         double deviationSum = 0;
@@ -389,7 +391,7 @@ If the shot tasted good (score 80+), acknowledge success! Suggest only minor ref
 Keep responses concise and practical. The goal is a better-tasting next shot, not a perfect analysis.)");
 }
 
-double ShotSummarizer::findValueAtTime(const QVector<QPointF>& data, double time) const
+double ShotSummarizer::findValueAtTime(const ShotSeriesView& data, double time) const
 {
     if (data.isEmpty()) return 0;
 
@@ -405,7 +407,7 @@ double ShotSummarizer::findValueAtTime(const QVector<QPointF>& data, double time
     return data.last().y();
 }
 
-double ShotSummarizer::calculateAverage(const QVector<QPointF>& data, double startTime, double endTime) const
+double ShotSummarizer::calculateAverage(const ShotSeriesView& data, double startTime, double endTime) const
 {
     if (data.isEmpty()) return 0;
 
@@ -420,7 +422,7 @@ double ShotSummarizer::calculateAverage(const QVector<QPointF>& data, double sta
     return count > 0 ? sum / count : 0;
 }
 
-double ShotSummarizer::calculateMax(const QVector<QPointF>& data, double startTime, double endTime) const
+double ShotSummarizer::calculateMax(const ShotSeriesView& data, double startTime, double endTime) const
 {
     if (data.isEmpty()) return 0;
 
@@ -433,7 +435,7 @@ double ShotSummarizer::calculateMax(const QVector<QPointF>& data, double startTi
     return maxVal == -std::numeric_limits<double>::infinity() ? 0 : maxVal;
 }
 
-double ShotSummarizer::calculateMin(const QVector<QPointF>& data, double startTime, double endTime) const
+double ShotSummarizer::calculateMin(const ShotSeriesView& data, double startTime, double endTime) const
 {
     if (data.isEmpty()) return 0;
 
@@ -446,7 +448,7 @@ double ShotSummarizer::calculateMin(const QVector<QPointF>& data, double startTi
     return minVal == std::numeric_limits<double>::infinity() ? 0 : minVal;
 }
 
-double ShotSummarizer::calculateStdDev(const QVector<QPointF>& data, double startTime, double endTime) const
+double ShotSummarizer::calculateStdDev(const ShotSeriesView& data, double startTime, double endTime) const
 {
     if (data.isEmpty()) return 0;
 
@@ -465,7 +467,7 @@ double ShotSummarizer::calculateStdDev(const QVector<QPointF>& data, double star
     return count > 1 ? std::sqrt(sumSquares / (count - 1)) : 0;
 }
 
-double ShotSummarizer::findTimeToFirstDrip(const QVector<QPointF>& flowData) const
+double ShotSummarizer::findTimeToFirstDrip(const ShotSeriesView& flowData) const
 {
     const double threshold = 0.5;  // mL/s - when we consider "drip" has started
     for (const auto& point : flowData) {
@@ -476,7 +478,7 @@ double ShotSummarizer::findTimeToFirstDrip(const QVector<QPointF>& flowData) con
     return 0;
 }
 
-bool ShotSummarizer::detectChanneling(const QVector<QPointF>& flowData, double afterTime) const
+bool ShotSummarizer::detectChanneling(const ShotSeriesView& flowData, double afterTime) const
 {
     if (flowData.size() < 10) return false;
 
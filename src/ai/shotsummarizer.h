@@ -6,6 +6,8 @@
 #include <QVector>
 #include <QPointF>
 
+#include "../models/shotsamplestore.h"
+
 class ShotDataModel;
 class Profile;
 struct ShotMetadata;
@@ -57,16 +59,18 @@ struct ShotSummary {
     // Phase breakdown
     QList<PhaseSummary> phases;
 
-    // Raw curve data for detailed analysis
-    QVector<QPointF> pressureCurve;
-    QVector<QPointF> flowCurve;
-    QVector<QPointF> tempCurve;
-    QVector<QPointF> weightCurve;
+    // Raw curve data for detailed analysis - views into samples, a shared (not copied)
+    // snapshot of the shot's sample columns that keeps them alive with the summary
+    ShotSampleStore samples;
+    ShotSeriesView pressureCurve;
+    ShotSeriesView flowCurve;
+    ShotSeriesView tempCurve;
+    ShotSeriesView weightCurve;
 
     // Target/goal curves (what the profile intended)
-    QVector<QPointF> pressureGoalCurve;
-    QVector<QPointF> flowGoalCurve;
-    QVector<QPointF> tempGoalCurve;
+    ShotSeriesView pressureGoalCurve;
+    ShotSeriesView flowGoalCurve;
+    ShotSeriesView tempGoalCurve;
 
     // Extraction indicators
     double timeToFirstDrip = 0;  // When flow > 0.5 mL/s
@@ -109,11 +113,11 @@ public:
 
 private:
     // Helper methods
-    double findValueAtTime(const QVector<QPointF>& data, double time) const;
-    double calculateAverage(const QVector<QPointF>& data, double startTime, double endTime) const;
-    double calculateMax(const QVector<QPointF>& data, double startTime, double endTime) const;
-    double calculateMin(const QVector<QPointF>& data, double startTime, double endTime) const;
-    double calculateStdDev(const QVector<QPointF>& data, double startTime, double endTime) const;
-    double findTimeToFirstDrip(const QVector<QPointF>& flowData) const;
-    bool detectChanneling(const QVector<QPointF>& flowData, double afterTime) const;
+    double findValueAtTime(const ShotSeriesView& data, double time) const;
+    double calculateAverage(const ShotSeriesView& data, double startTime, double endTime) const;
+    double calculateMax(const ShotSeriesView& data, double startTime, double endTime) const;
+    double calculateMin(const ShotSeriesView& data, double startTime, double endTime) const;
+    double calculateStdDev(const ShotSeriesView& data, double startTime, double endTime) const;
+    double findTimeToFirstDrip(const ShotSeriesView& flowData) const;
+    bool detectChanneling(const ShotSeriesView& flowData, double afterTime) const;
 };
@@ -14,6 +14,7 @@
 #include "../history/shothistorystorage.h"
 #include "../history/shotimporter.h"
 #include "../history/shotdebuglogger.h"
+#include "../history/shotjournal.h"
 #include "../network/shotserver.h"
 #include "../network/locationprovider.h"
 #include "../core/crashhandler.h"
@@ -110,6 +111,18 @@ MainController::MainController(Settings* settings, DE1Device* device,
     m_shotHistory = new ShotHistoryStorage(this);
     m_shotHistory->initialize();
 
+    // Journal every live sample so a crash mid-shot doesn't lose the shot
+    if (m_shotDataModel) {
+        m_shotDataModel->setJournal(m_shotHistory->journal());
+    }
+
+    // Database maintenance runs while the DE1 sleeps and yields as soon as it wakes
+    if (m_machineState) {
+        connect(m_machineState, &MachineState::phaseChanged, this, [this]() {
+            m_shotHistory->setMachineAsleep(m_machineState->phase() == MachineState::Phase::Sleep);
+        });
+    }
+
     // Create shot importer for importing .shot files from DE1 app
     m_shotImporter = new ShotImporter(m_shotHistory, this);
 
@@ -2137,6 +2150,9 @@ void MainController::onEspressoCycleStarted() {
         m_shotDataModel->clear();
         qDebug() << "[REFACTOR] ShotDataModel cleared";
     }
+    if (m_shotHistory && m_shotHistory->journal()) {
+        m_shotHistory->journal()->begin(m_currentProfile.title());
+    }
 
     // Start timing controller and tare via it
     if (m_timingController) {
@@ -2182,15 +2198,25 @@ void MainController::onShotEnded() {
         m_settings->clearTemperatureOverride();
     }
 
+    ShotJournal* journal = m_shotHistory ? m_shotHistory->journal() : nullptr;
+
     // Only process espresso shots that actually extracted
     if (!m_extractionStarted || !m_settings || !m_shotDataModel) {
         // Stop debug logging even if we don't save
         if (m_shotDebugLogger) {
             m_shotDebugLogger->stopCapture();
         }
+        if (journal) {
+            journal->discard();
+        }
         return;
     }
 
+    // Stop journaling; the file is removed once the shot is safely in shots.db.
+    // The shot is saved under the journal's UUID so recovery won't duplicate it.
+    QString journalUuid = journal ? journal->uuid() : QString();
+    QString journalPath = journal ? journal->close() : QString();
+
     double duration = m_shotDataModel->rawTime();  // Use rawTime, not maxTime (which is for graph axis)
 
     double doseWeight = m_settings->dyeBeanWeight();  // Use DYE bean weight as dose
@@ -2235,19 +2261,49 @@ void MainController::onShotEnded() {
     metadata.espressoNotes = m_settings->dyeShotNotes();
     metadata.barista = m_settings->dyeBarista();
 
+    // Check if we should show metadata page after shot (regardless of auto-upload)
+    // Show when: (extended metadata enabled AND show after shot) OR (AI configured AND show after shot)
+    bool hasAI = m_aiManager && m_aiManager->isConfigured();
+    bool showPostShot = m_settings->visualizerShowAfterShot() &&
+                        (m_settings->visualizerExtendedMetadata() || hasAI);
+
     // Always save shot to local history
     qDebug() << "[metadata] Saving shot - shotHistory:" << (m_shotHistory ? "exists" : "null")
              << "isReady:" << (m_shotHistory ? m_shotHistory->isReady() : false);
+    bool savingToHistory = false;
     if (m_shotHistory && m_shotHistory->isReady()) {
-        qint64 shotId = m_shotHistory->saveShot(
+        // Compression and disk I/O run on the storage worker thread so the
+        // post-shot page animation isn't blocked. The page opens once the ID is known.
+        savingToHistory = true;
+        m_savingShot = true;
+        emit savingShotChanged();
+        m_shotHistory->saveShotAsync(
             m_shotDataModel, &m_currentProfile,
             duration, finalWeight, doseWeight,
-            metadata, debugLog);
-        qDebug() << "[metadata] Shot saved to history with ID:" << shotId;
+            metadata, debugLog, journalUuid)
+            .then(this, [this, showPostShot, journalPath](qint64 shotId) {
+                m_savingShot = false;
+                emit savingShotChanged();
+
+                if (shotId <= 0) {
+                    // The journal stays on disk so the shot is recovered at next startup
+                    qWarning() << "[metadata] Failed to save shot to history, keeping journal:" << journalPath;
+                    emit shotSaveFailed();
+                    return;
+                }
 
-        // Store shot ID for post-shot review page (so it can edit the saved shot)
-        m_lastSavedShotId = shotId;
-        emit lastSavedShotIdChanged();
+                qDebug() << "[metadata] Shot saved to history with ID:" << shotId;
+                ShotJournal::remove(journalPath);
+
+                // Store shot ID for post-shot review page (so it can edit the saved shot)
+                m_lastSavedShotId = shotId;
+                emit lastSavedShotIdChanged();
+
+                if (showPostShot) {
+                    qDebug() << "  -> Showing metadata page";
+                    emit shotEndedShowMetadata();
+                }
+            });
 
         // Set shot date/time for display on metadata page
         QString shotDateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm");
@@ -2280,12 +2336,6 @@ void MainController::onShotEnded() {
              << "Final P:" << QString::number(finalPressure, 'f', 2) << "bar"
              << "Final F:" << QString::number(finalFlow, 'f', 2) << "ml/s";
 
-    // Check if we should show metadata page after shot (regardless of auto-upload)
-    // Show when: (extended metadata enabled AND show after shot) OR (AI configured AND show after shot)
-    bool hasAI = m_aiManager && m_aiManager->isConfigured();
-    bool showPostShot = m_settings->visualizerShowAfterShot() &&
-                        (m_settings->visualizerExtendedMetadata() || hasAI);
-
     // Auto-upload if enabled (do this first, before showing metadata page)
     if (m_settings->visualizerAutoUpload() && m_visualizer) {
         qDebug() << "  -> Auto-uploading to visualizer";
@@ -2300,8 +2350,11 @@ void MainController::onShotEnded() {
         m_pendingShotFinalWeight = finalWeight;
         m_pendingShotDoseWeight = doseWeight;
 
-        qDebug() << "  -> Showing metadata page";
-        emit shotEndedShowMetadata();
+        // When saving to history, the page is shown from the save completion above
+        if (!savingToHistory) {
+            qDebug() << "  -> Showing metadata page";
+            emit shotEndedShowMetadata();
+        }
     }
 
     // Reset extraction flag so that subsequent Steam/HotWater/Flush operations
@@ -81,6 +81,7 @@ class MainController : public QObject {
     Q_PROPERTY(DataMigrationClient* dataMigration READ dataMigration CONSTANT)
     Q_PROPERTY(bool isCurrentProfileRecipe READ isCurrentProfileRecipe NOTIFY currentProfileChanged)
     Q_PROPERTY(qint64 lastSavedShotId READ lastSavedShotId NOTIFY lastSavedShotIdChanged)
+    Q_PROPERTY(bool savingShot READ isSavingShot NOTIFY savingShotChanged)
     Q_PROPERTY(double profileTargetTemperature READ profileTargetTemperature NOTIFY currentProfileChanged)
 
 public:
@@ -128,6 +129,7 @@ public:
     ShotReporter* shotReporter() const { return m_shotReporter; }
     DataMigrationClient* dataMigration() const { return m_dataMigration; }
     qint64 lastSavedShotId() const { return m_lastSavedShotId; }
+    bool isSavingShot() const { return m_savingShot; }  // lastSavedShotId is stale while true
     double profileTargetTemperature() const { return m_currentProfile.espressoTemperature(); }
 
     const Profile& currentProfile() const { return m_currentProfile; }
@@ -233,6 +235,8 @@ signals:
     // DYE: emitted when shot ends and should show metadata page
     void shotEndedShowMetadata();
     void lastSavedShotIdChanged();
+    void savingShotChanged();
+    void shotSaveFailed();
 
     // Auto-wake: emitted when scheduled wake time is reached
     void autoWakeTriggered();
@@ -291,6 +295,7 @@ private:
     double m_pendingShotFinalWeight = 0;
     double m_pendingShotDoseWeight = 0;
     qint64 m_lastSavedShotId = 0;  // ID of most recently saved shot (for post-shot review)
+    bool m_savingShot = false;     // A save is queued on the storage worker
 
     // Shot history and comparison
     ShotHistoryStorage* m_shotHistory = nullptr;
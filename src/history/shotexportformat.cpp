@@ -0,0 +1,199 @@
+#include "shotexportformat.h"
+#include "shotsamplecodec.h"
+#include "shothistorystorage.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <vector>
+
+namespace {
+
+const char* const CHANNEL_NAMES[ShotSampleCodec::ChannelCount] = {
+    "pressure", "flow", "temperature", "pressureGoal", "flowGoal", "temperatureGoal", "weight", "weightFlow"
+};
+
+const char* const CSV_CHANNEL_COLUMNS[ShotSampleCodec::ChannelCount] = {
+    "pressure", "flow", "temperature", "pressure_goal", "flow_goal", "temperature_goal", "weight", "weight_flow"
+};
+
+QJsonObject curveToJson(const QVector<QPointF>& points)
+{
+    QJsonArray timeArr, valueArr;
+    for (const auto& pt : points) {
+        timeArr.append(pt.x());
+        valueArr.append(pt.y());
+    }
+    QJsonObject obj;
+    obj["t"] = timeArr;
+    obj["v"] = valueArr;
+    return obj;
+}
+
+QByteArray csvField(const QString& value)
+{
+    QByteArray utf8 = value.toUtf8();
+    if (!utf8.contains(',') && !utf8.contains('"') && !utf8.contains('\n') && !utf8.contains('\r')) {
+        return utf8;
+    }
+    utf8.replace("\"", "\"\"");
+    return "\"" + utf8 + "\"";
+}
+
+QByteArray csvNumber(double value)
+{
+    return QByteArray::number(value, 'g', 6);
+}
+
+// Walks one channel forward in time. Samples on the same clock are returned
+// directly; others are interpolated between neighbours.
+class ChannelCursor {
+public:
+    explicit ChannelCursor(const QVector<QPointF>& points) : m_points(points) {}
+
+    bool valueAt(double t, double* value)
+    {
+        if (m_points.isEmpty() || t < m_points.first().x() || t > m_points.last().x()) {
+            return false;
+        }
+        while (m_next < m_points.size() && m_points[m_next].x() < t) {
+            ++m_next;
+        }
+        const QPointF& b = m_points[m_next];
+        if (b.x() == t || m_next == 0) {
+            *value = b.y();
+            return true;
+        }
+        const QPointF& a = m_points[m_next - 1];
+        double span = b.x() - a.x();
+        *value = span > 0 ? a.y() + (t - a.x()) / span * (b.y() - a.y()) : b.y();
+        return true;
+    }
+
+private:
+    const QVector<QPointF>& m_points;
+    qsizetype m_next = 0;
+};
+
+}  // namespace
+
+bool ShotExportFormat::parse(const QString& name, Format* format)
+{
+    QString lower = name.toLower();
+    if (lower == "ndjson" || lower == "jsonl") {
+        *format = Ndjson;
+        return true;
+    }
+    if (lower == "csv") {
+        *format = Csv;
+        return true;
+    }
+    return false;
+}
+
+QString ShotExportFormat::fileExtension(Format format)
+{
+    return format == Csv ? "csv" : "ndjson";
+}
+
+QString ShotExportFormat::contentType(Format format)
+{
+    return format == Csv ? "text/csv; charset=utf-8" : "application/x-ndjson";
+}
+
+QByteArray ShotExportFormat::header(Format format)
+{
+    if (format != Csv) {
+        return QByteArray();
+    }
+    QByteArray line = "shot_id,uuid,timestamp,profile_name,bean_brand,bean_type,grinder_model,grinder_setting,"
+                      "dose_weight,final_weight,enjoyment,time";
+    for (const char* column : CSV_CHANNEL_COLUMNS) {
+        line += ',';
+        line += column;
+    }
+    return line + '\n';
+}
+
+QByteArray ShotExportFormat::encode(Format format, const ShotRecord& record)
+{
+    const QString timestamp = QDateTime::fromSecsSinceEpoch(record.summary.timestamp).toString(Qt::ISODate);
+
+    if (format == Ndjson) {
+        QJsonObject root;
+        root["id"] = record.summary.id;
+        root["uuid"] = record.summary.uuid;
+        root["timestamp"] = record.summary.timestamp;
+        root["dateTime"] = timestamp;
+        root["profileName"] = record.summary.profileName;
+        root["duration"] = record.summary.duration;
+        root["finalWeight"] = record.summary.finalWeight;
+        root["doseWeight"] = record.summary.doseWeight;
+        root["beanBrand"] = record.summary.beanBrand;
+        root["beanType"] = record.summary.beanType;
+        root["enjoyment"] = record.summary.enjoyment;
+        root["roastDate"] = record.roastDate;
+        root["roastLevel"] = record.roastLevel;
+        root["grinderModel"] = record.grinderModel;
+        root["grinderSetting"] = record.grinderSetting;
+        root["drinkTds"] = record.drinkTds;
+        root["drinkEy"] = record.drinkEy;
+        root["espressoNotes"] = record.espressoNotes;
+        root["barista"] = record.barista;
+        root["visualizerId"] = record.visualizerId;
+        root["profileJson"] = record.profileJson;
+
+        QJsonArray phases;
+        for (const auto& phase : record.phases) {
+            QJsonObject p;
+            p["time"] = phase.time;
+            p["label"] = phase.label;
+            p["frameNumber"] = phase.frameNumber;
+            p["isFlowMode"] = phase.isFlowMode;
+            phases.append(p);
+        }
+        root["phases"] = phases;
+
+        for (int c = 0; c < ShotSampleCodec::ChannelCount; ++c) {
+            root[CHANNEL_NAMES[c]] = curveToJson(ShotSampleCodec::series(record, static_cast<ShotSampleCodec::Channel>(c)));
+        }
+        return QJsonDocument(root).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    // CSV: metadata prefix shared by every row of this shot
+    QByteArray prefix = QByteArray::number(record.summary.id) + ','
+        + csvField(record.summary.uuid) + ','
+        + csvField(timestamp) + ','
+        + csvField(record.summary.profileName) + ','
+        + csvField(record.summary.beanBrand) + ','
+        + csvField(record.summary.beanType) + ','
+        + csvField(record.grinderModel) + ','
+        + csvField(record.grinderSetting) + ','
+        + csvNumber(record.summary.doseWeight) + ','
+        + csvNumber(record.summary.finalWeight) + ','
+        + QByteArray::number(record.summary.enjoyment) + ',';
+
+    std::vector<ChannelCursor> cursors;
+    cursors.reserve(ShotSampleCodec::ChannelCount);
+    for (int c = 0; c < ShotSampleCodec::ChannelCount; ++c) {
+        cursors.emplace_back(ShotSampleCodec::series(record, static_cast<ShotSampleCodec::Channel>(c)));
+    }
+
+    QByteArray out;
+    out.reserve(record.pressure.size() * (prefix.size() + 80));
+    for (const QPointF& sample : record.pressure) {
+        out += prefix;
+        out += csvNumber(sample.x());
+        for (auto& cursor : cursors) {
+            out += ',';
+            double value;
+            if (cursor.valueAt(sample.x(), &value)) {
+                out += csvNumber(value);
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+struct ShotRecord;
+
+/**
+ * Record encoders for bulk history export (ShotHistoryStorage::streamShots).
+ *
+ * Each call encodes exactly one shot, so an exporter only ever holds a single
+ * decoded shot no matter how large the history is.
+ *
+ *   Ndjson: one JSON object per line - the getShot() fields plus phases, with
+ *           every curve as { "t": [...], "v": [...] } in its own time base.
+ *   Csv:    "wide" table, one row per DE1 sample (pressure clock) with every
+ *           channel as a column. Channels on another clock (goals, scale) are
+ *           linearly interpolated and left empty outside their own time range.
+ *           Shot metadata is repeated on each row so the file loads as one frame.
+ */
+class ShotExportFormat {
+public:
+    enum Format {
+        Ndjson,
+        Csv
+    };
+
+    // "ndjson"/"jsonl" or "csv" (case-insensitive). Returns false otherwise.
+    static bool parse(const QString& name, Format* format);
+
+    static QString fileExtension(Format format);
+    static QString contentType(Format format);
+
+    // Written once before the first record (CSV column names; empty for NDJSON)
+    static QByteArray header(Format format);
+
+    static QByteArray encode(Format format, const ShotRecord& record);
+};
@@ -1,4 +1,11 @@
 #include "shothistorystorage.h"
+#include "shotstorageworker.h"
+#include "shotsamplecodec.h"
+#include "shotjournal.h"
+#include "shotmetrics.h"
+#include "shotserieslod.h"
+#include "shotsimilarity.h"
+#include "shotexportformat.h"
 #include "models/shotdatamodel.h"
 #include "profile/profile.h"
 #include "network/visualizeruploader.h"
@@ -7,21 +14,210 @@
 #include <QSqlError>
 #include <QStandardPaths>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QUuid>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QThread>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QPromise>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QDebug>
 
+#include <atomic>
+#include <limits>
+#include <memory>
+
 const QString ShotHistoryStorage::DB_CONNECTION_NAME = "ShotHistoryConnection";
 
+namespace {
+
+// Filterable columns with a facet table entry (value -> shot count).
+// The first three are also tracked together in shot_facet_combos for the cascading dropdowns.
+struct FacetColumn {
+    const char* key;
+    const char* column;
+    bool cascading;
+};
+
+const FacetColumn FACET_COLUMNS[] = {
+    { "profileName",    "profile_name",    true },
+    { "beanBrand",      "bean_brand",      true },
+    { "beanType",       "bean_type",       true },
+    { "grinderModel",   "grinder_model",   false },
+    { "grinderSetting", "grinder_setting", false },
+    { "barista",        "barista",         false },
+    { "roastLevel",     "roast_level",     false },
+};
+
+// Trigger body statements adding (sign = +1) or removing (sign = -1) one shot's
+// values, where row is "new" or "old"
+QString facetTriggerStatements(const QString& row, int sign)
+{
+    QString sql;
+    for (const auto& facet : FACET_COLUMNS) {
+        QString column = QString::fromLatin1(facet.column);
+        if (sign > 0) {
+            sql += QString(R"(
+            INSERT INTO shot_facets (facet, value, shot_count)
+                SELECT '%1', %2.%1, 1 WHERE COALESCE(%2.%1, '') != ''
+                ON CONFLICT(facet, value) DO UPDATE SET shot_count = shot_count + 1;)").arg(column, row);
+        } else {
+            sql += QString(R"(
+            UPDATE shot_facets SET shot_count = shot_count - 1 WHERE facet = '%1' AND value = %2.%1;
+            DELETE FROM shot_facets WHERE facet = '%1' AND value = %2.%1 AND shot_count <= 0;)").arg(column, row);
+        }
+    }
+
+    QString comboKey = QString("COALESCE(%1.profile_name, ''), COALESCE(%1.bean_brand, ''), COALESCE(%1.bean_type, '')").arg(row);
+    if (sign > 0) {
+        sql += QString(R"(
+            INSERT INTO shot_facet_combos (profile_name, bean_brand, bean_type, shot_count)
+                VALUES (%1, 1)
+                ON CONFLICT(profile_name, bean_brand, bean_type) DO UPDATE SET shot_count = shot_count + 1;)").arg(comboKey);
+    } else {
+        sql += QString(R"(
+            UPDATE shot_facet_combos SET shot_count = shot_count - 1
+                WHERE (profile_name, bean_brand, bean_type) = (%1);
+            DELETE FROM shot_facet_combos
+                WHERE (profile_name, bean_brand, bean_type) = (%1) AND shot_count <= 0;)").arg(comboKey);
+    }
+    return sql;
+}
+
+// Text columns indexed by shots_fts, with their bm25 weight (a hit in the bean
+// or profile name says more about a shot than one word in free-form notes)
+struct FtsColumn {
+    const char* column;
+    double weight;
+};
+
+const FtsColumn FTS_COLUMNS[] = {
+    { "espresso_notes",  1.0 },
+    { "bean_brand",      4.0 },
+    { "bean_type",       4.0 },
+    { "profile_name",    3.0 },
+    { "grinder_model",   2.0 },
+    { "grinder_setting", 1.0 },
+    { "barista",         2.0 },
+    { "roast_level",     1.0 },
+};
+
+// The trigram tokenizer can't match terms shorter than this
+constexpr int FTS_MIN_TERM_LENGTH = 3;
+
+QString ftsColumnList(const QString& prefix)
+{
+    QStringList columns;
+    for (const auto& fts : FTS_COLUMNS) {
+        columns << prefix + QString::fromLatin1(fts.column);
+    }
+    return columns.join(", ");
+}
+
+// Substring-capable (trigram) external-content index over every text column,
+// plus the triggers keeping it in sync with shots
+QStringList ftsSchemaStatements()
+{
+    const QString columns = ftsColumnList(QString());
+    const QString oldValues = ftsColumnList("old.");
+    const QString newValues = ftsColumnList("new.");
+    return {
+        QString(R"(
+            CREATE VIRTUAL TABLE IF NOT EXISTS shots_fts USING fts5(
+                %1,
+                content='shots',
+                content_rowid='id',
+                tokenize='trigram'
+            ))").arg(columns),
+        QString(R"(
+            CREATE TRIGGER IF NOT EXISTS shots_ai AFTER INSERT ON shots BEGIN
+                INSERT INTO shots_fts(rowid, %1) VALUES (new.id, %2);
+            END)").arg(columns, newValues),
+        QString(R"(
+            CREATE TRIGGER IF NOT EXISTS shots_ad AFTER DELETE ON shots BEGIN
+                INSERT INTO shots_fts(shots_fts, rowid, %1) VALUES ('delete', old.id, %2);
+            END)").arg(columns, oldValues),
+        QString(R"(
+            CREATE TRIGGER IF NOT EXISTS shots_au AFTER UPDATE ON shots BEGIN
+                INSERT INTO shots_fts(shots_fts, rowid, %1) VALUES ('delete', old.id, %2);
+                INSERT INTO shots_fts(rowid, %1) VALUES (new.id, %3);
+            END)").arg(columns, oldValues, newValues),
+    };
+}
+
+// bm25() call with the per-column weights, lower is better
+QString ftsRankExpression()
+{
+    QStringList weights;
+    for (const auto& fts : FTS_COLUMNS) {
+        weights << QString::number(fts.weight);
+    }
+    return QString("bm25(shots_fts, %1)").arg(weights.join(", "));
+}
+
+// All indexed text of a shot as one string, for terms too short for the index
+QString ftsConcatExpression()
+{
+    QStringList parts;
+    for (const auto& fts : FTS_COLUMNS) {
+        parts << QString("COALESCE(s.%1, '')").arg(QString::fromLatin1(fts.column));
+    }
+    return "(" + parts.join(" || ' ' || ") + ")";
+}
+
+// One thread's read connection. QThreadStorage deletes it on that thread as the thread
+// exits, which is where a thread-affine connection has to be closed and removed.
+struct ReadConnectionHolder {
+    QString name;
+    ~ReadConnectionHolder()
+    {
+        {
+            QSqlDatabase db = QSqlDatabase::database(name, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+QThreadStorage<ReadConnectionHolder*> s_readConnections;
+std::atomic_int s_readConnectionCount { 0 };
+
+}  // namespace
+
 ShotHistoryStorage::ShotHistoryStorage(QObject* parent)
     : QObject(parent)
+    , m_similarityIndex(new ShotSimilarityIndex())
+    , m_readPool(new QThreadPool(this))
 {
+    m_readPool->setMaxThreadCount(READ_POOL_SIZE);
+    m_readPool->setObjectName("ShotHistoryReadPool");
+
+    m_maintenanceTimer = new QTimer(this);
+    m_maintenanceTimer->setSingleShot(true);
+    m_maintenanceTimer->setInterval(MAINTENANCE_SLEEP_DELAY_MS);
+    connect(m_maintenanceTimer, &QTimer::timeout, this, [this]() {
+        if (QDateTime::currentSecsSinceEpoch() - m_lastMaintenance >= MAINTENANCE_INTERVAL_SECS) {
+            runMaintenance();
+        }
+    });
 }
 
 ShotHistoryStorage::~ShotHistoryStorage()
 {
+    emit closing();
+
+    // Let running read jobs finish; pooled threads drop their connections as they exit
+    m_readPool->waitForDone();
+
+    stopWorker();
+    delete m_journal;
+    delete m_similarityIndex;
+
     if (m_db.isOpen()) {
         m_db.close();
     }
@@ -46,6 +242,8 @@ bool ShotHistoryStorage::initialize(const QString& dbPath)
 
     m_db = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
     m_db.setDatabaseName(m_dbPath);
+    // The storage worker has its own connection - wait for its write lock instead of failing
+    m_db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
 
     if (!m_db.open()) {
         qWarning() << "ShotHistoryStorage: Failed to open database:" << m_db.lastError().text();
@@ -53,8 +251,10 @@ bool ShotHistoryStorage::initialize(const QString& dbPath)
         return false;
     }
 
-    // Enable WAL mode for better concurrent access
+    // Enable WAL mode for better concurrent access. Incremental auto-vacuum only takes
+    // effect on a new file; existing ones are converted by the first maintenance VACUUM.
     QSqlQuery pragma(m_db);
+    pragma.exec("PRAGMA auto_vacuum=INCREMENTAL");
     pragma.exec("PRAGMA journal_mode=WAL");
     pragma.exec("PRAGMA foreign_keys=ON");
 
@@ -68,6 +268,9 @@ bool ShotHistoryStorage::initialize(const QString& dbPath)
         return false;
     }
 
+    // Creates the archive file on first run, so read connections can always attach it
+    attachArchive(m_db, m_dbPath, true);
+
     // Checkpoint any existing WAL data from previous sessions
     // This ensures all data is in the main .db file
     QSqlQuery walQuery(m_db);
@@ -75,8 +278,20 @@ bool ShotHistoryStorage::initialize(const QString& dbPath)
         qDebug() << "ShotHistoryStorage: Startup WAL checkpoint completed";
     }
 
+    // Fold in any shot that was interrupted by a crash last session
+    m_journal = new ShotJournal(QFileInfo(m_dbPath).absolutePath() + "/shot_journal");
+    recoverJournals();
+
     updateTotalShots();
 
+    QSqlQuery lastRun(m_db);
+    if (lastRun.exec("SELECT MAX(started_at) FROM maintenance_log") && lastRun.next()) {
+        m_lastMaintenance = lastRun.value(0).toLongLong();
+    }
+
+    // Schema is in place - the worker connection can start taking jobs
+    startWorker();
+
     m_ready = true;
     emit readyChanged();
 
@@ -161,44 +376,21 @@ bool ShotHistoryStorage::createTables()
     }
 
     // Full-text search
-    QString createFts = R"(
-        CREATE VIRTUAL TABLE IF NOT EXISTS shots_fts USING fts5(
-            espresso_notes,
-            bean_brand,
-            bean_type,
-            content='shots',
-            content_rowid='id'
-        )
-    )";
-
-    if (!query.exec(createFts)) {
-        qWarning() << "Failed to create FTS table:" << query.lastError().text();
-        // FTS failure is not fatal
+    bool ftsExisted = query.exec("SELECT 1 FROM sqlite_master WHERE name = 'shots_fts'") && query.next();
+    query.finish();
+    bool ftsOk = true;
+    for (const QString& statement : ftsSchemaStatements()) {
+        if (ftsOk && !query.exec(statement)) {
+            qWarning() << "Failed to create FTS table:" << query.lastError().text();
+            ftsOk = false;  // FTS failure is not fatal
+        }
     }
-
-    // Triggers for FTS sync
-    query.exec(R"(
-        CREATE TRIGGER IF NOT EXISTS shots_ai AFTER INSERT ON shots BEGIN
-            INSERT INTO shots_fts(rowid, espresso_notes, bean_brand, bean_type)
-            VALUES (new.id, new.espresso_notes, new.bean_brand, new.bean_type);
-        END
-    )");
-
-    query.exec(R"(
-        CREATE TRIGGER IF NOT EXISTS shots_ad AFTER DELETE ON shots BEGIN
-            INSERT INTO shots_fts(shots_fts, rowid, espresso_notes, bean_brand, bean_type)
-            VALUES ('delete', old.id, old.espresso_notes, old.bean_brand, old.bean_type);
-        END
-    )");
-
-    query.exec(R"(
-        CREATE TRIGGER IF NOT EXISTS shots_au AFTER UPDATE ON shots BEGIN
-            INSERT INTO shots_fts(shots_fts, rowid, espresso_notes, bean_brand, bean_type)
-            VALUES ('delete', old.id, old.espresso_notes, old.bean_brand, old.bean_type);
-            INSERT INTO shots_fts(rowid, espresso_notes, bean_brand, bean_type)
-            VALUES (new.id, new.espresso_notes, new.bean_brand, new.bean_type);
-        END
-    )");
+    // Dropped earlier because this SQLite lacked the tokenizer: index the shots saved since
+    if (ftsOk && !ftsExisted && !query.exec("INSERT INTO shots_fts(shots_fts) VALUES ('rebuild')")) {
+        qWarning() << "Failed to build FTS index:" << query.lastError().text();
+        ftsOk = false;
+    }
+    m_searchAvailable = ftsOk;
 
     // Indexes
     query.exec("CREATE INDEX IF NOT EXISTS idx_shots_timestamp ON shots(timestamp DESC)");
@@ -221,8 +413,217 @@ bool ShotHistoryStorage::runMigrations()
     query.exec("SELECT version FROM schema_version LIMIT 1");
     int currentVersion = query.next() ? query.value(0).toInt() : 1;
 
-    // Future migrations go here
-    // if (currentVersion < 2) { ... }
+    if (currentVersion < 2) {
+        // Version 2: track sample blob encoding. Existing rows are legacy JSON and are
+        // rewritten to the columnar format in the background by the storage worker.
+        if (!query.exec("ALTER TABLE shot_samples ADD COLUMN encoding INTEGER NOT NULL DEFAULT 0")) {
+            qWarning() << "ShotHistoryStorage: Migration 2 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_samples_encoding ON shot_samples(encoding)");
+        query.exec("UPDATE schema_version SET version = 2");
+        currentVersion = 2;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 2 (sample encoding)";
+    }
+
+    if (currentVersion < 3) {
+        // Version 3: per-shot analytics, filled at save/import time and backfilled
+        // for existing history by the storage worker
+        QString createMetrics = R"(
+            CREATE TABLE IF NOT EXISTS shot_metrics (
+                shot_id INTEGER PRIMARY KEY REFERENCES shots(id) ON DELETE CASCADE,
+                peak_pressure REAL,
+                peak_flow REAL,
+                time_to_first_drop REAL,
+                mean_flow_pour REAL,
+                mean_pressure_pour REAL,
+                mean_temperature_pour REAL,
+                flow_stddev_pour REAL,
+                max_pressure_drop REAL,
+                ratio REAL
+            )
+        )";
+        if (!query.exec(createMetrics)) {
+            qWarning() << "ShotHistoryStorage: Migration 3 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_peak_pressure ON shot_metrics(peak_pressure)");
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_first_drop ON shot_metrics(time_to_first_drop)");
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_mean_flow ON shot_metrics(mean_flow_pour)");
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_flow_stddev ON shot_metrics(flow_stddev_pour)");
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_pressure_drop ON shot_metrics(max_pressure_drop)");
+        query.exec("CREATE INDEX IF NOT EXISTS idx_shot_metrics_ratio ON shot_metrics(ratio)");
+        query.exec("UPDATE schema_version SET version = 3");
+        currentVersion = 3;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 3 (shot metrics)";
+    }
+
+    if (currentVersion < 4) {
+        // Version 4: facet tables behind the filter dropdowns, so opening them
+        // reads a few hundred rows instead of a DISTINCT scan over all shots
+        m_db.transaction();
+        bool ok = query.exec(R"(
+            CREATE TABLE IF NOT EXISTS shot_facets (
+                facet TEXT NOT NULL,
+                value TEXT NOT NULL,
+                shot_count INTEGER NOT NULL,
+                PRIMARY KEY (facet, value)
+            ) WITHOUT ROWID
+        )") && query.exec(R"(
+            CREATE TABLE IF NOT EXISTS shot_facet_combos (
+                profile_name TEXT NOT NULL,
+                bean_brand TEXT NOT NULL,
+                bean_type TEXT NOT NULL,
+                shot_count INTEGER NOT NULL,
+                PRIMARY KEY (profile_name, bean_brand, bean_type)
+            ) WITHOUT ROWID
+        )");
+
+        QStringList facetColumns;
+        for (const auto& facet : FACET_COLUMNS) {
+            facetColumns << QString::fromLatin1(facet.column);
+        }
+        ok = ok && query.exec(QString("CREATE TRIGGER IF NOT EXISTS shots_facets_ai AFTER INSERT ON shots BEGIN%1\n        END")
+                                  .arg(facetTriggerStatements("new", +1)));
+        ok = ok && query.exec(QString("CREATE TRIGGER IF NOT EXISTS shots_facets_ad AFTER DELETE ON shots BEGIN%1\n        END")
+                                  .arg(facetTriggerStatements("old", -1)));
+        ok = ok && query.exec(QString("CREATE TRIGGER IF NOT EXISTS shots_facets_au AFTER UPDATE OF %1 ON shots BEGIN%2%3\n        END")
+                                  .arg(facetColumns.join(", "), facetTriggerStatements("old", -1),
+                                       facetTriggerStatements("new", +1)));
+
+        // Seed from existing history; the triggers keep them current from here on
+        for (const QString& column : std::as_const(facetColumns)) {
+            ok = ok && query.exec(QString(R"(
+                INSERT INTO shot_facets (facet, value, shot_count)
+                SELECT '%1', %1, COUNT(*) FROM shots
+                WHERE %1 IS NOT NULL AND %1 != ''
+                GROUP BY %1
+            )").arg(column));
+        }
+        ok = ok && query.exec(R"(
+            INSERT INTO shot_facet_combos (profile_name, bean_brand, bean_type, shot_count)
+            SELECT COALESCE(profile_name, ''), COALESCE(bean_brand, ''), COALESCE(bean_type, ''), COUNT(*)
+            FROM shots
+            GROUP BY 1, 2, 3
+        )");
+
+        if (!ok) {
+            qWarning() << "ShotHistoryStorage: Migration 4 failed:" << query.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+        query.exec("UPDATE schema_version SET version = 4");
+        m_db.commit();
+        currentVersion = 4;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 4 (facet tables)";
+    }
+
+    if (currentVersion < 5) {
+        // Version 5: downsampled curves for lists/overlays, backfilled by the storage worker
+        QString createLod = R"(
+            CREATE TABLE IF NOT EXISTS shot_series_lod (
+                shot_id INTEGER NOT NULL REFERENCES shots(id) ON DELETE CASCADE,
+                max_points INTEGER NOT NULL,
+                data_blob BLOB NOT NULL,
+                PRIMARY KEY (shot_id, max_points)
+            ) WITHOUT ROWID
+        )";
+        if (!query.exec(createLod)) {
+            qWarning() << "ShotHistoryStorage: Migration 5 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("UPDATE schema_version SET version = 5");
+        currentVersion = 5;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 5 (series LOD)";
+    }
+
+    if (currentVersion < 6) {
+        // Version 6: curve fingerprints for similarity search, backfilled by the storage worker
+        QString createFingerprints = R"(
+            CREATE TABLE IF NOT EXISTS shot_fingerprints (
+                shot_id INTEGER PRIMARY KEY REFERENCES shots(id) ON DELETE CASCADE,
+                version INTEGER NOT NULL,
+                vector BLOB NOT NULL
+            )
+        )";
+        if (!query.exec(createFingerprints)) {
+            qWarning() << "ShotHistoryStorage: Migration 6 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("UPDATE schema_version SET version = 6");
+        currentVersion = 6;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 6 (shot fingerprints)";
+    }
+
+    if (currentVersion < 7) {
+        // Version 7: covering index for aggregate(). Rows carry multi-KB profile JSON and
+        // debug logs; trend queries read only this narrow index instead of the table.
+        if (!query.exec(R"(
+            CREATE INDEX IF NOT EXISTS idx_shots_stats ON shots(
+                timestamp, bean_brand, bean_type, profile_name, grinder_model, grinder_setting,
+                duration_seconds, final_weight, dose_weight, enjoyment)
+        )")) {
+            qWarning() << "ShotHistoryStorage: Migration 7 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("UPDATE schema_version SET version = 7");
+        currentVersion = 7;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 7 (stats index)";
+    }
+
+    if (currentVersion < 8) {
+        // Version 8: shots_fts moves from unicode61 over notes/bean to a trigram index over
+        // every text column, so grinder, barista and mid-word fragments are searchable.
+        // The index is external-content, so it is rebuilt from shots in one pass.
+        QElapsedTimer timer;
+        timer.start();
+        m_db.transaction();
+        bool ok = query.exec("DROP TRIGGER IF EXISTS shots_ai")
+               && query.exec("DROP TRIGGER IF EXISTS shots_ad")
+               && query.exec("DROP TRIGGER IF EXISTS shots_au")
+               && query.exec("DROP TABLE IF EXISTS shots_fts");
+        for (const QString& statement : ftsSchemaStatements()) {
+            ok = ok && query.exec(statement);
+        }
+        ok = ok && query.exec("INSERT INTO shots_fts(shots_fts) VALUES ('rebuild')");
+        if (ok) {
+            query.exec("UPDATE schema_version SET version = 8");
+            m_db.commit();
+            qDebug() << "ShotHistoryStorage: Migrated schema to version 8 (trigram search) in"
+                     << timer.elapsed() << "ms";
+        } else {
+            // Not fatal (e.g. SQLite built without the trigram tokenizer): drop the index and
+            // its triggers, search falls back to LIKE, and createTables retries on a later start
+            qWarning() << "ShotHistoryStorage: Migration 8 failed, search index unavailable:"
+                       << query.lastError().text();
+            m_db.rollback();
+            query.exec("DROP TRIGGER IF EXISTS shots_ai");
+            query.exec("DROP TRIGGER IF EXISTS shots_ad");
+            query.exec("DROP TRIGGER IF EXISTS shots_au");
+            query.exec("DROP TABLE IF EXISTS shots_fts");
+            query.exec("UPDATE schema_version SET version = 8");
+            m_searchAvailable = false;
+        }
+        currentVersion = 8;
+    }
+
+    if (currentVersion < 9) {
+        // Version 9: history of background maintenance passes (stats is a JSON object)
+        if (!query.exec(R"(
+            CREATE TABLE IF NOT EXISTS maintenance_log (
+                id INTEGER PRIMARY KEY,
+                started_at INTEGER NOT NULL,
+                duration_ms INTEGER,
+                stats TEXT
+            )
+        )")) {
+            qWarning() << "ShotHistoryStorage: Migration 9 failed:" << query.lastError().text();
+            return false;
+        }
+        query.exec("UPDATE schema_version SET version = 9");
+        currentVersion = 9;
+        qDebug() << "ShotHistoryStorage: Migrated schema to version 9 (maintenance log)";
+    }
 
     m_schemaVersion = currentVersion;
     return true;
@@ -241,32 +642,44 @@ QJsonObject ShotHistoryStorage::pointsToJsonObject(const QVector<QPointF>& point
     return obj;
 }
 
-QByteArray ShotHistoryStorage::compressSampleData(ShotDataModel* shotData)
+QByteArray ShotHistoryStorage::encodeSampleData(const ShotRecord& record)
+{
+    return ShotSampleCodec::encode(record);
+}
+
+QByteArray ShotHistoryStorage::encodeLegacySampleData(const ShotRecord& record)
 {
     QJsonObject root;
 
-    root["pressure"] = pointsToJsonObject(shotData->pressureData());
-    root["flow"] = pointsToJsonObject(shotData->flowData());
-    root["temperature"] = pointsToJsonObject(shotData->temperatureData());
-    root["pressureGoal"] = pointsToJsonObject(shotData->pressureGoalData());
-    root["flowGoal"] = pointsToJsonObject(shotData->flowGoalData());
-    root["temperatureGoal"] = pointsToJsonObject(shotData->temperatureGoalData());
+    root["pressure"] = pointsToJsonObject(record.pressure);
+    root["flow"] = pointsToJsonObject(record.flow);
+    root["temperature"] = pointsToJsonObject(record.temperature);
+    root["pressureGoal"] = pointsToJsonObject(record.pressureGoal);
+    root["flowGoal"] = pointsToJsonObject(record.flowGoal);
+    root["temperatureGoal"] = pointsToJsonObject(record.temperatureGoal);
 
     // Weight data - store cumulative weight for history
-    root["weight"] = pointsToJsonObject(shotData->cumulativeWeightData());
+    root["weight"] = pointsToJsonObject(record.weight);
     // Also store flow rate from scale for future graph display
-    root["weightFlow"] = pointsToJsonObject(shotData->weightData());
+    if (!record.weightFlow.isEmpty()) {
+        root["weightFlow"] = pointsToJsonObject(record.weightFlow);
+    }
 
     QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
     return qCompress(json, 9);  // Max compression
 }
 
-void ShotHistoryStorage::decompressSampleData(const QByteArray& blob, ShotRecord* record)
+bool ShotHistoryStorage::decodeSampleData(const QByteArray& blob, ShotRecord* record)
 {
+    if (ShotSampleCodec::isBinaryBlob(blob)) {
+        return ShotSampleCodec::decode(blob, record);
+    }
+
+    // Legacy format: qCompress'd JSON with t/v arrays per channel
     QByteArray json = qUncompress(blob);
     if (json.isEmpty()) {
         qWarning() << "ShotHistoryStorage: Failed to decompress sample data";
-        return;
+        return false;
     }
 
     QJsonDocument doc = QJsonDocument::fromJson(json);
@@ -291,36 +704,77 @@ void ShotHistoryStorage::decompressSampleData(const QByteArray& blob, ShotRecord
     record->flowGoal = arrayToPoints(root["flowGoal"].toObject());
     record->temperatureGoal = arrayToPoints(root["temperatureGoal"].toObject());
     record->weight = arrayToPoints(root["weight"].toObject());
+    record->weightFlow = arrayToPoints(root["weightFlow"].toObject());
+    return true;
 }
 
-qint64 ShotHistoryStorage::saveShot(ShotDataModel* shotData,
-                                     const Profile* profile,
-                                     double duration,
-                                     double finalWeight,
-                                     double doseWeight,
-                                     const ShotMetadata& metadata,
-                                     const QString& debugLog)
+ShotRecord ShotHistoryStorage::buildShotRecord(ShotDataModel* shotData,
+                                               const Profile* profile,
+                                               double duration,
+                                               double finalWeight,
+                                               double doseWeight,
+                                               const ShotMetadata& metadata,
+                                               const QString& debugLog,
+                                               const QString& uuid)
 {
-    if (!m_ready || !shotData) {
-        qWarning() << "ShotHistoryStorage: Cannot save shot - not ready or no data";
-        return -1;
-    }
-
-    QString uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
-    qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    ShotRecord record;
+    record.summary.uuid = uuid.isEmpty() ? QUuid::createUuid().toString(QUuid::WithoutBraces) : uuid;
+    record.summary.timestamp = QDateTime::currentSecsSinceEpoch();
 
     // Serialize profile to JSON
-    QString profileJson;
-    QString profileName = "Unknown";
+    record.summary.profileName = "Unknown";
     if (profile) {
-        profileName = profile->title();
-        profileJson = QString::fromUtf8(profile->toJson().toJson(QJsonDocument::Compact));
+        record.summary.profileName = profile->title();
+        record.profileJson = QString::fromUtf8(profile->toJson().toJson(QJsonDocument::Compact));
+    }
+
+    record.summary.duration = duration;
+    record.summary.finalWeight = finalWeight;
+    record.summary.doseWeight = doseWeight;
+    record.summary.beanBrand = metadata.beanBrand;
+    record.summary.beanType = metadata.beanType;
+    record.summary.enjoyment = metadata.espressoEnjoyment;
+    record.roastDate = metadata.roastDate;
+    record.roastLevel = metadata.roastLevel;
+    record.grinderModel = metadata.grinderModel;
+    record.grinderSetting = metadata.grinderSetting;
+    record.drinkTds = metadata.drinkTds;
+    record.drinkEy = metadata.drinkEy;
+    record.espressoNotes = metadata.espressoNotes;
+    record.barista = metadata.barista;
+    record.debugLog = debugLog;
+
+    // One pass over the sample columns into the record's point series (the codec's input)
+    record.pressure = shotData->pressureData().toVector();
+    record.flow = shotData->flowData().toVector();
+    record.temperature = shotData->temperatureData().toVector();
+    record.pressureGoal = shotData->pressureGoalData().toVector();
+    record.flowGoal = shotData->flowGoalData().toVector();
+    record.temperatureGoal = shotData->temperatureGoalData().toVector();
+    record.weight = shotData->cumulativeWeightData().toVector();
+    record.weightFlow = shotData->weightData().toVector();
+
+    QVariantList markers = shotData->phaseMarkersVariant();
+    for (const QVariant& markerVar : markers) {
+        QVariantMap marker = markerVar.toMap();
+        HistoryPhaseMarker phase;
+        phase.time = marker["time"].toDouble();
+        phase.label = marker["label"].toString();
+        phase.frameNumber = marker["frameNumber"].toInt();
+        phase.isFlowMode = marker["isFlowMode"].toBool();
+        record.phases.append(phase);
     }
 
-    QSqlQuery query(m_db);
+    return record;
+}
+
+qint64 ShotHistoryStorage::insertShotRecord(QSqlDatabase& db, const ShotRecord& record,
+                                            QString* errorMessage)
+{
+    QSqlQuery query(db);
 
     // Begin transaction
-    m_db.transaction();
+    db.transaction();
 
     // Insert main shot record
     query.prepare(R"(
@@ -341,85 +795,421 @@ qint64 ShotHistoryStorage::saveShot(ShotDataModel* shotData,
         )
     )");
 
-    query.bindValue(":uuid", uuid);
-    query.bindValue(":timestamp", timestamp);
-    query.bindValue(":profile_name", profileName);
-    query.bindValue(":profile_json", profileJson);
-    query.bindValue(":duration", duration);
-    query.bindValue(":final_weight", finalWeight);
-    query.bindValue(":dose_weight", doseWeight);
-    query.bindValue(":bean_brand", metadata.beanBrand);
-    query.bindValue(":bean_type", metadata.beanType);
-    query.bindValue(":roast_date", metadata.roastDate);
-    query.bindValue(":roast_level", metadata.roastLevel);
-    query.bindValue(":grinder_model", metadata.grinderModel);
-    query.bindValue(":grinder_setting", metadata.grinderSetting);
-    query.bindValue(":drink_tds", metadata.drinkTds);
-    query.bindValue(":drink_ey", metadata.drinkEy);
-    query.bindValue(":enjoyment", metadata.espressoEnjoyment);
-    query.bindValue(":espresso_notes", metadata.espressoNotes);
-    query.bindValue(":barista", metadata.barista);
-    query.bindValue(":debug_log", debugLog);
+    query.bindValue(":uuid", record.summary.uuid);
+    query.bindValue(":timestamp", record.summary.timestamp);
+    query.bindValue(":profile_name", record.summary.profileName);
+    query.bindValue(":profile_json", record.profileJson);
+    query.bindValue(":duration", record.summary.duration);
+    query.bindValue(":final_weight", record.summary.finalWeight);
+    query.bindValue(":dose_weight", record.summary.doseWeight);
+    query.bindValue(":bean_brand", record.summary.beanBrand);
+    query.bindValue(":bean_type", record.summary.beanType);
+    query.bindValue(":roast_date", record.roastDate);
+    query.bindValue(":roast_level", record.roastLevel);
+    query.bindValue(":grinder_model", record.grinderModel);
+    query.bindValue(":grinder_setting", record.grinderSetting);
+    query.bindValue(":drink_tds", record.drinkTds);
+    query.bindValue(":drink_ey", record.drinkEy);
+    query.bindValue(":enjoyment", record.summary.enjoyment);
+    query.bindValue(":espresso_notes", record.espressoNotes);
+    query.bindValue(":barista", record.barista);
+    query.bindValue(":debug_log", record.debugLog);
 
     if (!query.exec()) {
         qWarning() << "ShotHistoryStorage: Failed to insert shot:" << query.lastError().text();
-        m_db.rollback();
-        emit errorOccurred("Failed to save shot: " + query.lastError().text());
+        if (errorMessage) *errorMessage = "Failed to save shot: " + query.lastError().text();
+        db.rollback();
         return -1;
     }
 
     qint64 shotId = query.lastInsertId().toLongLong();
 
-    // Insert compressed sample data
-    QByteArray compressedData = compressSampleData(shotData);
-    int sampleCount = shotData->pressureData().size();
+    // Insert encoded sample data
+    QByteArray sampleData = encodeSampleData(record);
+    int sampleCount = record.pressure.size();
 
-    query.prepare("INSERT INTO shot_samples (shot_id, sample_count, data_blob) VALUES (:id, :count, :blob)");
+    query.prepare("INSERT INTO shot_samples (shot_id, sample_count, data_blob, encoding) "
+                  "VALUES (:id, :count, :blob, :encoding)");
     query.bindValue(":id", shotId);
     query.bindValue(":count", sampleCount);
-    query.bindValue(":blob", compressedData);
+    query.bindValue(":blob", sampleData);
+    query.bindValue(":encoding", SAMPLE_ENCODING_COLUMNAR);
 
     if (!query.exec()) {
         qWarning() << "ShotHistoryStorage: Failed to insert samples:" << query.lastError().text();
-        m_db.rollback();
-        emit errorOccurred("Failed to save shot samples");
+        if (errorMessage) *errorMessage = "Failed to save shot samples";
+        db.rollback();
         return -1;
     }
 
     // Insert phase markers
-    QVariantList markers = shotData->phaseMarkersVariant();
-    for (const QVariant& markerVar : markers) {
-        QVariantMap marker = markerVar.toMap();
-        query.prepare(R"(
-            INSERT INTO shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode)
-            VALUES (:shot_id, :time, :label, :frame, :flow_mode)
-        )");
+    query.prepare(R"(
+        INSERT INTO shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode)
+        VALUES (:shot_id, :time, :label, :frame, :flow_mode)
+    )");
+    for (const auto& marker : record.phases) {
         query.bindValue(":shot_id", shotId);
-        query.bindValue(":time", marker["time"].toDouble());
-        query.bindValue(":label", marker["label"].toString());
-        query.bindValue(":frame", marker["frameNumber"].toInt());
-        query.bindValue(":flow_mode", marker["isFlowMode"].toBool() ? 1 : 0);
+        query.bindValue(":time", marker.time);
+        query.bindValue(":label", marker.label);
+        query.bindValue(":frame", marker.frameNumber);
+        query.bindValue(":flow_mode", marker.isFlowMode ? 1 : 0);
         query.exec();  // Non-critical if markers fail
     }
 
-    m_db.commit();
+    // Analytics row - computed from the in-memory series, so no blob decode later
+    writeShotMetrics(db, shotId, record);  // Non-critical, backfill retries missing rows
+    writeShotSeriesLod(db, shotId, record);
+    writeShotFingerprint(db, shotId, record);
 
-    m_lastSavedShotId = shotId;
-    updateTotalShots();
+    db.commit();
 
-    // Checkpoint WAL to main database file after each shot
-    // This ensures data is persisted to the .db file and not just in .db-wal
-    QSqlQuery walQuery(m_db);
-    walQuery.exec("PRAGMA wal_checkpoint(PASSIVE)");
+    return shotId;
+}
+
+bool ShotHistoryStorage::writeShotMetrics(QSqlDatabase& db, qint64 shotId, const ShotRecord& record)
+{
+    const QStringList& columns = ShotMetrics::columnNames();
+    QStringList placeholders;
+    for (int i = 0; i <= columns.size(); ++i) placeholders << "?";
+
+    QSqlQuery query(db);
+    query.prepare(QString("INSERT OR REPLACE INTO shot_metrics (shot_id, %1) VALUES (%2)")
+                      .arg(columns.join(", "), placeholders.join(", ")));
+    query.addBindValue(shotId);
+    const QVariantList values = ShotMetrics::compute(record).values();
+    for (const QVariant& value : values) {
+        query.addBindValue(value);
+    }
+
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Failed to write metrics for shot" << shotId
+                   << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ShotHistoryStorage::writeShotSeriesLod(QSqlDatabase& db, qint64 shotId, const ShotRecord& record)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO shot_series_lod (shot_id, max_points, data_blob) VALUES (?, ?, ?)");
+    for (int level : ShotSeriesLod::LEVELS) {
+        query.addBindValue(shotId);
+        query.addBindValue(level);
+        query.addBindValue(encodeSampleData(ShotSeriesLod::buildLevel(record, level)));
+        if (!query.exec()) {
+            qWarning() << "ShotHistoryStorage: Failed to write series LOD for shot" << shotId
+                       << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShotHistoryStorage::writeShotFingerprint(QSqlDatabase& db, qint64 shotId, const ShotRecord& record)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO shot_fingerprints (shot_id, version, vector) VALUES (?, ?, ?)");
+    query.addBindValue(shotId);
+    query.addBindValue(ShotFingerprint::VERSION);
+    query.addBindValue(ShotFingerprint::toBlob(ShotFingerprint::compute(record)));
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Failed to write fingerprint for shot" << shotId
+                   << query.lastError().text();
+        return false;
+    }
+    return true;
+}
 
-    qDebug() << "ShotHistoryStorage: Saved shot" << shotId
-             << "- Profile:" << profileName
-             << "- Duration:" << duration << "s"
-             << "- Samples:" << sampleCount
-             << "- Compressed size:" << compressedData.size() << "bytes";
+QFuture<qint64> ShotHistoryStorage::saveShotAsync(ShotDataModel* shotData,
+                                                   const Profile* profile,
+                                                   double duration,
+                                                   double finalWeight,
+                                                   double doseWeight,
+                                                   const ShotMetadata& metadata,
+                                                   const QString& debugLog,
+                                                   const QString& uuid)
+{
+    // QPromise is move-only; share it between the worker job and the GUI-thread completion
+    auto promise = std::make_shared<QPromise<qint64>>();
+    QFuture<qint64> future = promise->future();
+    promise->start();
 
+    if (!m_ready || !shotData || !m_worker) {
+        qWarning() << "ShotHistoryStorage: Cannot save shot - not ready or no data";
+        promise->addResult(-1);
+        promise->finish();
+        return future;
+    }
+
+    // Snapshot on the GUI thread so the model can be cleared for the next shot
+    ShotRecord record = buildShotRecord(shotData, profile, duration, finalWeight, doseWeight,
+                                        metadata, debugLog, uuid);
+
+    ShotStorageWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [this, worker, record, promise]() {
+        QString error;
+        qint64 shotId = worker->saveShot(record, &error);
+
+        // Back on the GUI thread: bookkeeping, signals, then resolve the future.
+        // The destructor joins the worker thread, so 'this' is alive here.
+        QMetaObject::invokeMethod(this, [this, shotId, error, promise]() {
+            if (shotId > 0) {
+                onShotPersisted(shotId);
+            } else {
+                emit errorOccurred(error);
+            }
+            promise->addResult(shotId > 0 ? shotId : -1);
+            promise->finish();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+
+    return future;
+}
+
+void ShotHistoryStorage::onShotPersisted(qint64 shotId)
+{
+    m_lastSavedShotId = shotId;
+    m_totalShots++;
+
+    // Keep a loaded similarity index current instead of reloading all of it
+    m_similarityStale = m_similarityStale || m_similarityLoading;
+    if (m_similarityIndex->isLoaded()) {
+        QSqlQuery query(m_db);
+        query.prepare("SELECT vector FROM shot_fingerprints WHERE shot_id = ? AND version = ?");
+        query.addBindValue(shotId);
+        query.addBindValue(ShotFingerprint::VERSION);
+        if (query.exec() && query.next()) {
+            m_similarityIndex->insert(shotId, ShotFingerprint::fromBlob(query.value(0).toByteArray()));
+        }
+    }
+
+    emit totalShotsChanged();
     emit shotSaved(shotId);
-    return shotId;
+}
+
+void ShotHistoryStorage::recoverJournals()
+{
+    const QStringList paths = m_journal->pendingJournals();
+    for (const QString& path : paths) {
+        ShotRecord record;
+        if (!ShotJournal::readJournal(path, &record)) {
+            qDebug() << "ShotHistoryStorage: Discarding journal without an extraction:" << path;
+            ShotJournal::remove(path);
+            continue;
+        }
+
+        // The app may have gone down after the shot was committed but before
+        // its journal was removed - don't save it a second time
+        QSqlQuery existing(m_db);
+        existing.prepare("SELECT id FROM shots WHERE uuid = ?");
+        existing.addBindValue(record.summary.uuid);
+        if (existing.exec() && existing.next()) {
+            qDebug() << "ShotHistoryStorage: Journal already saved as shot"
+                     << existing.value(0).toLongLong() << "- removing" << path;
+            ShotJournal::remove(path);
+            continue;
+        }
+
+        qint64 shotId = insertShotRecord(m_db, record);
+        if (shotId > 0) {
+            qDebug() << "ShotHistoryStorage: Recovered interrupted shot" << shotId
+                     << "from" << path << "-" << record.pressure.size() << "samples";
+            ShotJournal::remove(path);
+        } else {
+            qWarning() << "ShotHistoryStorage: Failed to recover journal, keeping it:" << path;
+        }
+    }
+}
+
+QSqlDatabase ShotHistoryStorage::readConnection() const
+{
+    // The GUI thread reads through the writer connection, so it always sees its own writes
+    if (QThread::currentThread() == thread()) {
+        return m_db;
+    }
+
+    // Any other thread gets its own read-only connection; WAL lets these read
+    // concurrently with the writer and with each other
+    if (ReadConnectionHolder* holder = s_readConnections.localData()) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(holder->name);
+            if (db.databaseName() == m_dbPath) {
+                return db;
+            }
+        }
+        s_readConnections.setLocalData(nullptr);  // Reopened at another path - deletes the old one
+    }
+
+    // Numbered, not named after the thread: a new thread can reuse an exited one's address
+    const QString name = QString("%1_Read_%2").arg(DB_CONNECTION_NAME).arg(++s_readConnectionCount);
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(m_dbPath);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+        qWarning() << "ShotHistoryStorage: Failed to open read connection:" << db.lastError().text();
+    } else {
+        attachArchive(db, m_dbPath, false);
+    }
+
+    s_readConnections.setLocalData(new ReadConnectionHolder{ name });
+    return db;
+}
+
+void ShotHistoryStorage::startWorker()
+{
+    if (m_workerThread) return;
+
+    m_workerThread = new QThread(this);
+    m_workerThread->setObjectName("ShotStorageWorker");
+    m_worker = new ShotStorageWorker(m_dbPath);
+    m_worker->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_workerThread->start(QThread::LowPriority);
+
+    // Open the connection on the worker thread (QSqlDatabase is thread-affine)
+    ShotStorageWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() { worker->open(); }, Qt::QueuedConnection);
+
+    // Rewrite legacy JSON sample blobs and backfill analytics in small batches behind any pending saves
+    QMetaObject::invokeMethod(worker, &ShotStorageWorker::migrateSampleEncoding, Qt::QueuedConnection);
+    QMetaObject::invokeMethod(worker, &ShotStorageWorker::backfillMetrics, Qt::QueuedConnection);
+    QMetaObject::invokeMethod(worker, &ShotStorageWorker::backfillSeriesLod, Qt::QueuedConnection);
+
+    // Backfilled fingerprints aren't in a loaded index yet - reload it on the next query
+    connect(worker, &ShotStorageWorker::fingerprintsWritten, this, [this]() {
+        invalidateSimilarityIndex();
+    });
+    QMetaObject::invokeMethod(worker, &ShotStorageWorker::backfillFingerprints, Qt::QueuedConnection);
+
+    // Move cold sample blobs out of shots.db once the backfills have read them
+    QMetaObject::invokeMethod(worker, &ShotStorageWorker::archiveSamples, Qt::QueuedConnection);
+
+    connect(worker, &ShotStorageWorker::maintenanceFinished, this, &ShotHistoryStorage::maintenanceFinished);
+}
+
+void ShotHistoryStorage::setMachineAsleep(bool asleep)
+{
+    m_machineAsleep = asleep;
+    if (asleep) {
+        if (!m_maintenanceTimer->isActive()) {
+            m_maintenanceTimer->start();
+        }
+        return;
+    }
+    m_maintenanceTimer->stop();
+    if (m_worker) {
+        m_worker->cancelMaintenance();  // Atomic generation, checked before and between steps
+    }
+}
+
+bool ShotHistoryStorage::runMaintenance()
+{
+    if (!m_ready || !m_worker || !m_machineAsleep) return false;
+
+    m_lastMaintenance = QDateTime::currentSecsSinceEpoch();
+    qDebug() << "ShotHistoryStorage: Queueing database maintenance";
+    // A wake between queueing and the start of the pass bumps the generation and skips it
+    ShotStorageWorker* worker = m_worker;
+    const int generation = worker->maintenanceGeneration();
+    QMetaObject::invokeMethod(worker, [worker, generation]() {
+        worker->runMaintenance(generation);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+QVariantMap ShotHistoryStorage::databaseStats()
+{
+    QVariantMap stats;
+    if (!m_ready) return stats;
+
+    QSqlQuery query(readConnection());
+    for (const char* pragma : { "page_size", "page_count", "freelist_count", "auto_vacuum" }) {
+        if (query.exec(QString("PRAGMA %1").arg(pragma)) && query.next()) {
+            stats[QString::fromLatin1(pragma)] = query.value(0).toLongLong();
+        }
+    }
+    stats["schemaVersion"] = m_schemaVersion;
+    stats["searchAvailable"] = m_searchAvailable;
+    stats["dbBytes"] = QFileInfo(m_dbPath).size();
+    stats["walBytes"] = QFileInfo(m_dbPath + "-wal").size();
+    stats["archiveBytes"] = QFileInfo(archivePath(m_dbPath)).size();
+
+    QVariantList runs;
+    if (query.exec("SELECT stats FROM maintenance_log ORDER BY id DESC LIMIT 5")) {
+        while (query.next()) {
+            runs.append(QJsonDocument::fromJson(query.value(0).toString().toUtf8()).object().toVariantMap());
+        }
+    }
+    stats["maintenance"] = runs;
+    return stats;
+}
+
+QString ShotHistoryStorage::archivePath(const QString& dbPath)
+{
+    QFileInfo info(dbPath);
+    return info.absolutePath() + "/" + info.completeBaseName() + "_archive.db";
+}
+
+bool ShotHistoryStorage::attachArchive(QSqlDatabase& db, const QString& dbPath, bool createSchema)
+{
+    QSqlQuery query(db);
+    const QString path = archivePath(dbPath);
+
+    // Read-only connections can't create the file, and an in-memory/benchmark database has none
+    bool attached = createSchema || QFileInfo::exists(path);
+    if (attached) {
+        query.prepare("ATTACH DATABASE ? AS archive");
+        query.addBindValue(path);
+        attached = query.exec();
+        if (!attached) {
+            qWarning() << "ShotHistoryStorage: Failed to attach sample archive:" << query.lastError().text();
+        }
+    }
+    if (attached && createSchema) {
+        query.exec("PRAGMA archive.journal_mode=WAL");
+        attached = query.exec(R"(
+            CREATE TABLE IF NOT EXISTS archive.shot_samples (
+                shot_id INTEGER PRIMARY KEY,
+                sample_count INTEGER NOT NULL,
+                data_blob BLOB NOT NULL,
+                encoding INTEGER NOT NULL
+            )
+        )");
+        if (!attached) {
+            qWarning() << "ShotHistoryStorage: Failed to create sample archive:" << query.lastError().text();
+        }
+    }
+
+    // tier 0 = shots.db, 1 = archive. A blob caught mid-move is in both files; readers
+    // ORDER BY tier so the hot copy wins (UNION ALL alone has no defined order).
+    QString view = "CREATE TEMP VIEW IF NOT EXISTS shot_samples_all AS "
+                   "SELECT shot_id, sample_count, data_blob, encoding, 0 AS tier FROM main.shot_samples";
+    if (attached) {
+        view += " UNION ALL SELECT shot_id, sample_count, data_blob, encoding, 1 AS tier FROM archive.shot_samples";
+    }
+    if (!query.exec(view)) {
+        qWarning() << "ShotHistoryStorage: Failed to create sample view:" << query.lastError().text();
+        return false;
+    }
+    return attached;
+}
+
+void ShotHistoryStorage::stopWorker()
+{
+    if (!m_workerThread) return;
+
+    // Queue the shutdown behind any pending jobs so in-flight saves are not lost
+    ShotStorageWorker* worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() {
+        worker->close();
+        QThread::currentThread()->quit();
+    }, Qt::QueuedConnection);
+    m_workerThread->wait();  // Worker is deleted via deleteLater when the thread finishes
+
+    m_worker = nullptr;
+    delete m_workerThread;
+    m_workerThread = nullptr;
 }
 
 bool ShotHistoryStorage::updateVisualizerInfo(qint64 shotId, const QString& visualizerId, const QString& visualizerUrl)
@@ -461,6 +1251,22 @@ ShotFilter ShotHistoryStorage::parseFilterMap(const QVariantMap& filterMap)
     filter.dateTo = filterMap.value("dateTo", 0).toLongLong();
     filter.searchText = filterMap.value("searchText").toString();
     filter.onlyWithVisualizer = filterMap.value("onlyWithVisualizer", false).toBool();
+
+    // Metric ranges: "minPeakPressure", "maxRatio", ... for any ShotMetrics key
+    for (auto it = filterMap.constBegin(); it != filterMap.constEnd(); ++it) {
+        bool isMin = it.key().startsWith("min");
+        if (!isMin && !it.key().startsWith("max")) continue;
+        QString key = it.key().mid(3);
+        if (key.isEmpty()) continue;
+        key[0] = key[0].toLower();
+        if (ShotMetrics::columnForKey(key).isEmpty()) continue;  // e.g. minEnjoyment
+        (isMin ? filter.metricMin : filter.metricMax).insert(key, it.value().toDouble());
+    }
+    QString sortBy = filterMap.value("sortBy").toString();
+    if (!ShotMetrics::columnForKey(sortBy).isEmpty()) {
+        filter.sortBy = sortBy;
+        filter.sortAscending = filterMap.value("sortAscending", false).toBool();
+    }
     return filter;
 }
 
@@ -469,47 +1275,66 @@ QString ShotHistoryStorage::buildFilterQuery(const ShotFilter& filter, QVariantL
     QStringList conditions;
 
     if (!filter.profileName.isEmpty()) {
-        conditions << "profile_name = ?";
+        conditions << "s.profile_name = ?";
         bindValues << filter.profileName;
     }
     if (!filter.beanBrand.isEmpty()) {
-        conditions << "bean_brand = ?";
+        conditions << "s.bean_brand = ?";
         bindValues << filter.beanBrand;
     }
     if (!filter.beanType.isEmpty()) {
-        conditions << "bean_type = ?";
+        conditions << "s.bean_type = ?";
         bindValues << filter.beanType;
     }
     if (!filter.grinderModel.isEmpty()) {
-        conditions << "grinder_model = ?";
+        conditions << "s.grinder_model = ?";
         bindValues << filter.grinderModel;
     }
     if (!filter.grinderSetting.isEmpty()) {
-        conditions << "grinder_setting = ?";
+        conditions << "s.grinder_setting = ?";
         bindValues << filter.grinderSetting;
     }
     if (!filter.roastLevel.isEmpty()) {
-        conditions << "roast_level = ?";
+        conditions << "s.roast_level = ?";
         bindValues << filter.roastLevel;
     }
     if (filter.minEnjoyment > 0) {
-        conditions << "enjoyment >= ?";
+        conditions << "s.enjoyment >= ?";
         bindValues << filter.minEnjoyment;
     }
     if (filter.maxEnjoyment < 100) {
-        conditions << "enjoyment <= ?";
+        conditions << "s.enjoyment <= ?";
         bindValues << filter.maxEnjoyment;
     }
     if (filter.dateFrom > 0) {
-        conditions << "timestamp >= ?";
+        conditions << "s.timestamp >= ?";
         bindValues << filter.dateFrom;
     }
     if (filter.dateTo > 0) {
-        conditions << "timestamp <= ?";
+        conditions << "s.timestamp <= ?";
         bindValues << filter.dateTo;
     }
     if (filter.onlyWithVisualizer) {
-        conditions << "visualizer_id IS NOT NULL";
+        conditions << "s.visualizer_id IS NOT NULL";
+    }
+    // Search terms the trigram index can't match are checked as plain substrings
+    if (!filter.searchText.isEmpty()) {
+        QStringList shortTerms;
+        formatFtsQuery(filter.searchText, &shortTerms);
+        for (QString term : shortTerms) {
+            term.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+            conditions << ftsConcatExpression() + " LIKE ? ESCAPE '\\'";
+            bindValues << "%" + term + "%";
+        }
+    }
+    // Metric columns come from the whitelist in ShotMetrics, never from user input
+    for (auto it = filter.metricMin.constBegin(); it != filter.metricMin.constEnd(); ++it) {
+        conditions << QString("m.%1 >= ?").arg(ShotMetrics::columnForKey(it.key()));
+        bindValues << it.value();
+    }
+    for (auto it = filter.metricMax.constBegin(); it != filter.metricMax.constEnd(); ++it) {
+        conditions << QString("m.%1 <= ?").arg(ShotMetrics::columnForKey(it.key()));
+        bindValues << it.value();
     }
 
     if (conditions.isEmpty()) {
@@ -518,10 +1343,22 @@ QString ShotHistoryStorage::buildFilterQuery(const ShotFilter& filter, QVariantL
     return " WHERE " + conditions.join(" AND ");
 }
 
-QString ShotHistoryStorage::formatFtsQuery(const QString& userInput)
+QString ShotHistoryStorage::buildOrderClause(const ShotFilter& filter)
 {
-    // FTS5 special characters that need quoting: " ( ) * : ^
-    // We'll wrap each word in quotes and add * for prefix matching
+    if (filter.sortBy.isEmpty()) {
+        return "s.timestamp DESC, s.id DESC";
+    }
+    // Shots without the metric (e.g. no scale) sort last in either direction
+    QString column = "m." + ShotMetrics::columnForKey(filter.sortBy);
+    return QString("%1 IS NULL, %1 %2, s.timestamp DESC, s.id DESC")
+        .arg(column, filter.sortAscending ? "ASC" : "DESC");
+}
+
+QString ShotHistoryStorage::formatFtsQuery(const QString& userInput, QStringList* shortTerms)
+{
+    // Each word becomes a quoted phrase, which the trigram tokenizer matches as a
+    // case-insensitive substring anywhere in any indexed column. Quoting also
+    // neutralises FTS5 syntax characters: " ( ) * : ^
 
     QString cleaned = userInput.simplified();
     if (cleaned.isEmpty()) {
@@ -532,12 +1369,14 @@ QString ShotHistoryStorage::formatFtsQuery(const QString& userInput)
     QStringList terms;
 
     for (const QString& word : words) {
+        if (word.size() < FTS_MIN_TERM_LENGTH || !m_searchAvailable) {
+            if (shortTerms) shortTerms->append(word);
+            continue;
+        }
         // Escape double quotes by doubling them
         QString escaped = word;
         escaped.replace('"', "\"\"");
-        // Use prefix matching with * for partial word matches
-        // Wrap in quotes to handle special characters
-        terms << QString("\"%1\"*").arg(escaped);
+        terms << QString("\"%1\"").arg(escaped);
     }
 
     // Join with AND (implicit in FTS5 when space-separated)
@@ -546,46 +1385,149 @@ QString ShotHistoryStorage::formatFtsQuery(const QString& userInput)
 
 QVariantList ShotHistoryStorage::getShotsFiltered(const QVariantMap& filterMap, int offset, int limit)
 {
-    QVariantList results;
-    if (!m_ready) return results;
+    if (!m_ready) return QVariantList();
+
+    return queryShotSummaries(parseFilterMap(filterMap), QString(), QVariantList(), offset, limit);
+}
+
+QVariantMap ShotHistoryStorage::getShotsPage(const QVariantMap& filterMap, const QString& cursor, int limit)
+{
+    QString nextCursor;
+    const QList<HistoryShotSummary> summaries = getShotSummariesPage(filterMap, cursor, limit, &nextCursor);
+
+    QVariantList shots;
+    shots.reserve(summaries.size());
+    for (const HistoryShotSummary& summary : summaries) {
+        shots.append(summaryToVariant(summary));
+    }
+
+    QVariantMap page;
+    page["shots"] = shots;
+    page["nextCursor"] = nextCursor;
+    page["hasMore"] = !nextCursor.isEmpty();
+    return page;
+}
+
+QList<HistoryShotSummary> ShotHistoryStorage::getShotSummariesPage(const QVariantMap& filterMap, const QString& cursor,
+                                                                   int limit, QString* nextCursor)
+{
+    nextCursor->clear();
+    if (!m_ready || limit <= 0) return {};
 
     ShotFilter filter = parseFilterMap(filterMap);
-    QVariantList bindValues;
+    filter.sortBy.clear();  // Keyset order is always (timestamp, id) DESC
+
+    // Seek past the cursor row instead of counting off OFFSET rows. The plain
+    // timestamp bound gives the planner a range on idx_shots_timestamp (which
+    // carries the rowid), the row value breaks ties between equal timestamps.
+    QString condition;
+    QVariantList cursorValues;
+    if (!cursor.isEmpty()) {
+        qint64 cursorTimestamp = 0;
+        qint64 cursorId = 0;
+        if (!decodeShotCursor(cursor, &cursorTimestamp, &cursorId)) {
+            qWarning() << "ShotHistoryStorage: Invalid shot cursor:" << cursor;
+            return {};
+        }
+        condition = "s.timestamp <= ? AND (s.timestamp, s.id) < (?, ?)";
+        cursorValues << cursorTimestamp << cursorTimestamp << cursorId;
+    }
+
+    // Fetch one extra row to know whether another page exists
+    QList<HistoryShotSummary> shots = queryShotSummaryRecords(filter, condition, cursorValues, 0, limit + 1);
+    bool hasMore = shots.size() > limit;
+    if (hasMore) {
+        shots.removeLast();
+    }
+
+    if (hasMore && !shots.isEmpty()) {
+        *nextCursor = encodeShotCursor(shots.last().timestamp, shots.last().id);
+    }
+    return shots;
+}
+
+bool ShotHistoryStorage::getShotSummary(const QVariantMap& filterMap, qint64 shotId, HistoryShotSummary* summary)
+{
+    if (!m_ready) return false;
+
+    ShotFilter filter = parseFilterMap(filterMap);
+    filter.sortBy.clear();
+    const QList<HistoryShotSummary> shots = queryShotSummaryRecords(filter, "s.id = ?", { shotId }, 0, 1);
+    if (shots.isEmpty()) return false;
+    *summary = shots.first();
+    return true;
+}
+
+QString ShotHistoryStorage::encodeShotCursor(qint64 timestamp, qint64 shotId)
+{
+    return QString("%1:%2").arg(timestamp).arg(shotId);
+}
+
+bool ShotHistoryStorage::decodeShotCursor(const QString& cursor, qint64* timestamp, qint64* shotId)
+{
+    QStringList parts = cursor.split(':');
+    if (parts.size() != 2) return false;
+
+    bool tsOk = false, idOk = false;
+    *timestamp = parts[0].toLongLong(&tsOk);
+    *shotId = parts[1].toLongLong(&idOk);
+    return tsOk && idOk;
+}
+
+QString ShotHistoryStorage::buildFromClause(const ShotFilter& filter, const QString& extraCondition,
+                                            const QVariantList& extraBindValues, QVariantList& bindValues,
+                                            bool joinMetrics)
+{
     QString whereClause = buildFilterQuery(filter, bindValues);
+    if (!extraCondition.isEmpty()) {
+        whereClause += (whereClause.isEmpty() ? " WHERE " : " AND ") + extraCondition;
+        bindValues << extraBindValues;
+    }
 
-    // Handle FTS search separately
-    QString sql;
-    if (!filter.searchText.isEmpty()) {
-        // Format search text for FTS5: escape special chars and add prefix wildcards
-        QString ftsQuery = formatFtsQuery(filter.searchText);
-
-        sql = QString(R"(
-            SELECT s.id, s.uuid, s.timestamp, s.profile_name, s.duration_seconds,
-                   s.final_weight, s.dose_weight, s.bean_brand, s.bean_type,
-                   s.enjoyment, s.visualizer_id
-            FROM shots s
-            JOIN shots_fts fts ON s.id = fts.rowid
-            WHERE shots_fts MATCH ?
-            %1
-            ORDER BY s.timestamp DESC
-            LIMIT ? OFFSET ?
-        )").arg(whereClause.isEmpty() ? "" : " AND " + whereClause.mid(7));  // Remove " WHERE "
+    // Metric filters/sorting only touch the shot_metrics table, never shot_samples
+    QString metricsJoin = (joinMetrics || filter.usesMetrics()) ? " LEFT JOIN shot_metrics m ON m.shot_id = s.id" : "";
+
+    // Handle FTS search separately (terms too short for the index are in whereClause)
+    QString ftsQuery = formatFtsQuery(filter.searchText);
+    if (!ftsQuery.isEmpty()) {
         bindValues.prepend(ftsQuery);
-    } else {
-        sql = QString(R"(
-            SELECT id, uuid, timestamp, profile_name, duration_seconds,
-                   final_weight, dose_weight, bean_brand, bean_type,
-                   enjoyment, visualizer_id
-            FROM shots
-            %1
-            ORDER BY timestamp DESC
-            LIMIT ? OFFSET ?
-        )").arg(whereClause);
+        return QString(" FROM shots s JOIN shots_fts fts ON s.id = fts.rowid%1 WHERE shots_fts MATCH ?%2")
+            .arg(metricsJoin, whereClause.isEmpty() ? "" : " AND " + whereClause.mid(7));  // Remove " WHERE "
     }
+    return " FROM shots s" + metricsJoin + whereClause;
+}
+
+QVariantList ShotHistoryStorage::queryShotSummaries(const ShotFilter& filter, const QString& extraCondition,
+                                                    const QVariantList& extraBindValues, int offset, int limit)
+{
+    QVariantList results;
+    for (const HistoryShotSummary& summary : queryShotSummaryRecords(filter, extraCondition, extraBindValues,
+                                                                     offset, limit)) {
+        results.append(summaryToVariant(summary));
+    }
+    return results;
+}
+
+QList<HistoryShotSummary> ShotHistoryStorage::queryShotSummaryRecords(const ShotFilter& filter,
+                                                                      const QString& extraCondition,
+                                                                      const QVariantList& extraBindValues,
+                                                                      int offset, int limit)
+{
+    QList<HistoryShotSummary> results;
+
+    QVariantList bindValues;
+    QString sql = QString(R"(
+        SELECT s.id, s.uuid, s.timestamp, s.profile_name, s.duration_seconds,
+               s.final_weight, s.dose_weight, s.bean_brand, s.bean_type,
+               s.enjoyment, s.visualizer_id
+        %1
+        ORDER BY %2
+        LIMIT ? OFFSET ?
+    )").arg(buildFromClause(filter, extraCondition, extraBindValues, bindValues), buildOrderClause(filter));
 
     bindValues << limit << offset;
 
-    QSqlQuery query(m_db);
+    QSqlQuery query(readConnection());
     query.prepare(sql);
     for (int i = 0; i < bindValues.size(); ++i) {
         query.bindValue(i, bindValues[i]);
@@ -597,30 +1539,176 @@ QVariantList ShotHistoryStorage::getShotsFiltered(const QVariantMap& filterMap,
     }
 
     while (query.next()) {
-        QVariantMap shot;
-        shot["id"] = query.value(0).toLongLong();
-        shot["uuid"] = query.value(1).toString();
-        shot["timestamp"] = query.value(2).toLongLong();
-        shot["profileName"] = query.value(3).toString();
-        shot["duration"] = query.value(4).toDouble();
-        shot["finalWeight"] = query.value(5).toDouble();
-        shot["doseWeight"] = query.value(6).toDouble();
-        shot["beanBrand"] = query.value(7).toString();
-        shot["beanType"] = query.value(8).toString();
-        shot["enjoyment"] = query.value(9).toInt();
-        shot["hasVisualizerUpload"] = !query.value(10).isNull();
-
-        // Format date for display
-        QDateTime dt = QDateTime::fromSecsSinceEpoch(query.value(2).toLongLong());
-        shot["dateTime"] = dt.toString("yyyy-MM-dd HH:mm");
-
-        results.append(shot);
+        results.append(summaryFromQuery(query));
     }
 
     return results;
 }
 
-QVariantMap ShotHistoryStorage::getShot(qint64 shotId)
+HistoryShotSummary ShotHistoryStorage::summaryFromQuery(const QSqlQuery& query)
+{
+    HistoryShotSummary shot;
+    shot.id = query.value(0).toLongLong();
+    shot.uuid = query.value(1).toString();
+    shot.timestamp = query.value(2).toLongLong();
+    shot.profileName = query.value(3).toString();
+    shot.duration = query.value(4).toDouble();
+    shot.finalWeight = query.value(5).toDouble();
+    shot.doseWeight = query.value(6).toDouble();
+    shot.beanBrand = query.value(7).toString();
+    shot.beanType = query.value(8).toString();
+    shot.enjoyment = query.value(9).toInt();
+    shot.hasVisualizerUpload = !query.value(10).isNull();
+    return shot;
+}
+
+QVariantMap ShotHistoryStorage::summaryToVariant(const HistoryShotSummary& summary)
+{
+    QVariantMap shot;
+    shot["id"] = summary.id;
+    shot["uuid"] = summary.uuid;
+    shot["timestamp"] = summary.timestamp;
+    shot["profileName"] = summary.profileName;
+    shot["duration"] = summary.duration;
+    shot["finalWeight"] = summary.finalWeight;
+    shot["doseWeight"] = summary.doseWeight;
+    shot["beanBrand"] = summary.beanBrand;
+    shot["beanType"] = summary.beanType;
+    shot["enjoyment"] = summary.enjoyment;
+    shot["hasVisualizerUpload"] = summary.hasVisualizerUpload;
+    shot["dateTime"] = formatShotDateTime(summary.timestamp);
+    return shot;
+}
+
+QString ShotHistoryStorage::formatShotDateTime(qint64 timestamp)
+{
+    // Format date for display
+    return QDateTime::fromSecsSinceEpoch(timestamp).toString("yyyy-MM-dd HH:mm");
+}
+
+QVariantMap ShotHistoryStorage::searchShots(const QString& text, const QVariantMap& filterMap,
+                                            const QString& cursor, int limit)
+{
+    QVariantMap page;
+    page["shots"] = QVariantList();
+    page["nextCursor"] = QString();
+    page["hasMore"] = false;
+    if (!m_ready || limit <= 0) return page;
+
+    ShotFilter filter = parseFilterMap(filterMap);
+    filter.searchText = text;
+    filter.sortBy.clear();
+
+    // Nothing the index can rank (empty or only 1-2 letter terms): newest first instead
+    QString ftsQuery = formatFtsQuery(text);
+    if (ftsQuery.isEmpty()) {
+        QVariantMap fallback = filterMap;
+        fallback["searchText"] = text;
+        return getShotsPage(fallback, cursor, limit);
+    }
+
+    // Keyset on (rank, id). Ranks depend on index-wide term statistics, so a shot
+    // saved between pages can shift later pages slightly; nothing is repeated or
+    // skipped within a stable index.
+    const QString rank = ftsRankExpression();
+    QString condition;
+    QVariantList cursorValues;
+    if (!cursor.isEmpty()) {
+        QStringList parts = cursor.split(':');
+        bool rankOk = false, idOk = false;
+        double cursorRank = parts.size() == 2 ? parts[0].toDouble(&rankOk) : 0.0;
+        qint64 cursorId = parts.size() == 2 ? parts[1].toLongLong(&idOk) : 0;
+        if (!rankOk || !idOk) {
+            qWarning() << "ShotHistoryStorage: Invalid search cursor:" << cursor;
+            return page;
+        }
+        condition = QString("(%1, s.id) > (?, ?)").arg(rank);
+        cursorValues << cursorRank << cursorId;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QSqlDatabase db = readConnection();
+
+    // Pass 1: rank only, so snippets are built for the page rather than every match
+    QVariantList bindValues;
+    QString sql = QString("SELECT s.id, %1%2 ORDER BY 2, s.id LIMIT ?")
+        .arg(rank, buildFromClause(filter, condition, cursorValues, bindValues));
+    bindValues << limit + 1;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (int i = 0; i < bindValues.size(); ++i) {
+        query.bindValue(i, bindValues[i]);
+    }
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Search failed:" << query.lastError().text();
+        return page;
+    }
+
+    QList<qint64> ids;
+    QHash<qint64, double> ranks;
+    while (query.next()) {
+        qint64 id = query.value(0).toLongLong();
+        ids.append(id);
+        ranks.insert(id, query.value(1).toDouble());
+    }
+    bool hasMore = ids.size() > limit;
+    if (hasMore) {
+        ids.removeLast();
+    }
+    if (ids.isEmpty()) return page;
+
+    // Pass 2: summaries and highlighted snippets for this page
+    QStringList placeholders;
+    for (int i = 0; i < ids.size(); ++i) {
+        placeholders << "?";
+    }
+    query.prepare(QString(R"(
+        SELECT s.id, s.uuid, s.timestamp, s.profile_name, s.duration_seconds,
+               s.final_weight, s.dose_weight, s.bean_brand, s.bean_type,
+               s.enjoyment, s.visualizer_id,
+               snippet(shots_fts, -1, '<b>', '</b>', '...', 12)
+        FROM shots s JOIN shots_fts fts ON s.id = fts.rowid
+        WHERE shots_fts MATCH ? AND s.id IN (%1)
+    )").arg(placeholders.join(", ")));
+    query.addBindValue(ftsQuery);
+    for (qint64 id : ids) {
+        query.addBindValue(id);
+    }
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Search snippets failed:" << query.lastError().text();
+        return page;
+    }
+
+    QHash<qint64, QVariantMap> rows;
+    while (query.next()) {
+        QVariantMap shot = summaryToVariant(summaryFromQuery(query));
+        shot["snippet"] = query.value(11).toString();
+        rows.insert(shot["id"].toLongLong(), shot);
+    }
+
+    QVariantList shots;
+    for (qint64 id : ids) {
+        QVariantMap shot = rows.value(id);
+        if (shot.isEmpty()) continue;
+        shot["rank"] = ranks.value(id);
+        shots.append(shot);
+    }
+    if (hasMore) {
+        page["nextCursor"] = QString("%1:%2").arg(QString::number(ranks.value(ids.last()), 'g', 17))
+                                              .arg(ids.last());
+    }
+    page["shots"] = shots;
+    page["hasMore"] = hasMore;
+
+    qDebug() << "ShotHistoryStorage: Search" << text << "returned" << shots.size() << "shots in"
+             << timer.elapsed() << "ms";
+    return page;
+}
+
+QVariantMap ShotHistoryStorage::getShot(qint64 shotId, bool includeSeries)
 {
     ShotRecord record = getShotRecord(shotId);
     QVariantMap result;
@@ -656,25 +1744,16 @@ QVariantMap ShotHistoryStorage::getShot(qint64 shotId)
     result["debugLog"] = record.debugLog;
     result["profileJson"] = record.profileJson;
 
-    // Convert time-series to variant lists
-    auto pointsToVariant = [](const QVector<QPointF>& points) {
-        QVariantList list;
-        for (const auto& pt : points) {
-            QVariantMap p;
-            p["x"] = pt.x();
-            p["y"] = pt.y();
-            list.append(p);
-        }
-        return list;
-    };
-
-    result["pressure"] = pointsToVariant(record.pressure);
-    result["flow"] = pointsToVariant(record.flow);
-    result["temperature"] = pointsToVariant(record.temperature);
-    result["pressureGoal"] = pointsToVariant(record.pressureGoal);
-    result["flowGoal"] = pointsToVariant(record.flowGoal);
-    result["temperatureGoal"] = pointsToVariant(record.temperatureGoal);
-    result["weight"] = pointsToVariant(record.weight);
+    // Convert time-series to variant lists (a map per point - charts should use ShotSeries instead)
+    if (includeSeries) {
+        result["pressure"] = pointsToVariantList(record.pressure);
+        result["flow"] = pointsToVariantList(record.flow);
+        result["temperature"] = pointsToVariantList(record.temperature);
+        result["pressureGoal"] = pointsToVariantList(record.pressureGoal);
+        result["flowGoal"] = pointsToVariantList(record.flowGoal);
+        result["temperatureGoal"] = pointsToVariantList(record.temperatureGoal);
+        result["weight"] = pointsToVariantList(record.weight);
+    }
 
     // Phase markers
     QVariantList phases;
@@ -695,12 +1774,68 @@ QVariantMap ShotHistoryStorage::getShot(qint64 shotId)
     return result;
 }
 
+QVariantList ShotHistoryStorage::pointsToVariantList(const QVector<QPointF>& points)
+{
+    QVariantList list;
+    list.reserve(points.size());
+    for (const auto& pt : points) {
+        QVariantMap p;
+        p["x"] = pt.x();
+        p["y"] = pt.y();
+        list.append(p);
+    }
+    return list;
+}
+
+QVariantMap ShotHistoryStorage::getShotSeries(qint64 shotId, int maxPoints)
+{
+    QVariantMap result;
+    if (!m_ready) return result;
+
+    // Cheapest stored level that still has maxPoints of detail; a shot whose
+    // level isn't backfilled yet falls back to the full blob
+    int level = ShotSeriesLod::levelFor(maxPoints);
+    ShotRecord record;
+    bool loaded = false;
+
+    QSqlQuery query(readConnection());
+    if (level > 0) {
+        query.prepare("SELECT data_blob FROM shot_series_lod WHERE shot_id = ? AND max_points = ?");
+        query.addBindValue(shotId);
+        query.addBindValue(level);
+        loaded = query.exec() && query.next() && decodeSampleData(query.value(0).toByteArray(), &record);
+    }
+    if (!loaded) {
+        level = 0;
+        query.prepare("SELECT data_blob FROM shot_samples_all WHERE shot_id = ? ORDER BY tier LIMIT 1");
+        query.addBindValue(shotId);
+        if (!query.exec() || !query.next() || !decodeSampleData(query.value(0).toByteArray(), &record)) {
+            return result;
+        }
+    }
+
+    // Trim a finer level (or full data) down to the requested size
+    if (maxPoints > 0 && maxPoints != level) {
+        record = ShotSeriesLod::buildLevel(record, maxPoints);
+    }
+
+    result["level"] = level;
+    result["pressure"] = pointsToVariantList(record.pressure);
+    result["flow"] = pointsToVariantList(record.flow);
+    result["temperature"] = pointsToVariantList(record.temperature);
+    result["pressureGoal"] = pointsToVariantList(record.pressureGoal);
+    result["flowGoal"] = pointsToVariantList(record.flowGoal);
+    result["temperatureGoal"] = pointsToVariantList(record.temperatureGoal);
+    result["weight"] = pointsToVariantList(record.weight);
+    return result;
+}
+
 ShotRecord ShotHistoryStorage::getShotRecord(qint64 shotId)
 {
     ShotRecord record;
     if (!m_ready) return record;
 
-    QSqlQuery query(m_db);
+    QSqlQuery query(readConnection());
     query.prepare(R"(
         SELECT id, uuid, timestamp, profile_name, profile_json,
                duration_seconds, final_weight, dose_weight,
@@ -741,12 +1876,12 @@ ShotRecord ShotHistoryStorage::getShotRecord(qint64 shotId)
     record.debugLog = query.value(21).toString();
     record.summary.hasVisualizerUpload = !record.visualizerId.isEmpty();
 
-    // Load sample data
-    query.prepare("SELECT data_blob FROM shot_samples WHERE shot_id = ?");
+    // Load sample data (hot, else archived)
+    query.prepare("SELECT data_blob FROM shot_samples_all WHERE shot_id = ? ORDER BY tier LIMIT 1");
     query.bindValue(0, shotId);
     if (query.exec() && query.next()) {
         QByteArray blob = query.value(0).toByteArray();
-        decompressSampleData(blob, &record);
+        decodeSampleData(blob, &record);
     }
 
     // Load phase markers
@@ -763,16 +1898,390 @@ ShotRecord ShotHistoryStorage::getShotRecord(qint64 shotId)
         }
     }
 
-    return record;
+    return record;
+}
+
+QVariantMap ShotHistoryStorage::getShotMetrics(qint64 shotId)
+{
+    QVariantMap result;
+    if (!m_ready) return result;
+
+    const QStringList& columns = ShotMetrics::columnNames();
+    QSqlQuery query(readConnection());
+    query.prepare(QString("SELECT %1 FROM shot_metrics WHERE shot_id = ?").arg(columns.join(", ")));
+    query.bindValue(0, shotId);
+    if (!query.exec() || !query.next()) {
+        return result;
+    }
+
+    // Report by the camelCase keys QML also uses for filtering
+    const QStringList& keys = ShotMetrics::keyNames();
+    for (int i = 0; i < keys.size(); ++i) {
+        if (!query.value(i).isNull()) {
+            result[keys[i]] = query.value(i).toDouble();
+        }
+    }
+    return result;
+}
+
+QVariantList ShotHistoryStorage::findSimilarShots(qint64 shotId, int k, const QVariantMap& filterMap)
+{
+    QVariantList results;
+    if (!m_ready || k <= 0) return results;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!m_similarityIndex->isLoaded()) {
+        loadSimilarityIndex();
+        return results;
+    }
+
+    // Not indexed yet (backfill still running, or an old fingerprint version): compute it
+    QVector<float> query = m_similarityIndex->fingerprint(shotId);
+    if (query.isEmpty()) {
+        ShotRecord record = getShotRecord(shotId);
+        if (record.summary.id == 0) return results;
+        query = ShotFingerprint::compute(record);
+    }
+
+    // Narrow the candidates with the usual history filter, resolved once in SQL
+    ShotFilter filter = parseFilterMap(filterMap);
+    filter.sortBy.clear();
+    QVariantList bindValues;
+    QString fromClause = buildFromClause(filter, QString(), QVariantList(), bindValues);
+    QSet<qint64> allowed;
+    bool filtered = !bindValues.isEmpty() || filter.onlyWithVisualizer;  // Every other condition binds a value
+    if (filtered) {
+        QSqlQuery idQuery(m_db);
+        idQuery.setForwardOnly(true);
+        idQuery.prepare("SELECT s.id" + fromClause);
+        for (int i = 0; i < bindValues.size(); ++i) {
+            idQuery.bindValue(i, bindValues[i]);
+        }
+        if (!idQuery.exec()) {
+            qWarning() << "ShotHistoryStorage: Similar shots filter failed:" << idQuery.lastError().text();
+            return results;
+        }
+        while (idQuery.next()) {
+            allowed.insert(idQuery.value(0).toLongLong());
+        }
+    }
+
+    const QList<QPair<qint64, float>> neighbours =
+        m_similarityIndex->nearest(query, k, shotId, filtered ? &allowed : nullptr);
+    if (neighbours.isEmpty()) return results;
+
+    QStringList placeholders;
+    QVariantList ids;
+    QHash<qint64, float> distances;
+    for (const auto& neighbour : neighbours) {
+        placeholders << "?";
+        ids << neighbour.first;
+        distances.insert(neighbour.first, neighbour.second);
+    }
+    const QVariantList shots = queryShotSummaries(ShotFilter(), "s.id IN (" + placeholders.join(", ") + ")",
+                                                  ids, 0, static_cast<int>(neighbours.size()));
+
+    // Nearest first
+    QHash<qint64, QVariantMap> shotById;
+    for (const QVariant& shot : shots) {
+        QVariantMap map = shot.toMap();
+        shotById.insert(map["id"].toLongLong(), map);
+    }
+    for (const auto& neighbour : neighbours) {
+        auto it = shotById.find(neighbour.first);
+        if (it == shotById.end()) continue;
+        it->insert("distance", neighbour.second);
+        results.append(*it);
+    }
+
+    qDebug() << "ShotHistoryStorage: Found" << results.size() << "shots similar to" << shotId
+             << "among" << m_similarityIndex->size() << "in" << timer.elapsed() << "ms";
+    return results;
+}
+
+void ShotHistoryStorage::loadSimilarityIndex()
+{
+    if (m_similarityLoading) return;
+    m_similarityLoading = true;
+    m_similarityStale = false;
+
+    runRead([this]() {
+        ShotSimilarityIndex index;
+        QSqlDatabase db = readConnection();
+        index.load(db);
+        return index;
+    }).then(this, [this](const ShotSimilarityIndex& index) {
+        m_similarityLoading = false;
+        if (m_similarityStale) {
+            loadSimilarityIndex();  // Shots were saved, deleted or backfilled meanwhile
+            return;
+        }
+        if (!index.isLoaded()) return;
+        *m_similarityIndex = index;
+        emit similarityIndexReady();
+    });
+}
+
+void ShotHistoryStorage::invalidateSimilarityIndex()
+{
+    m_similarityIndex->invalidate();
+    m_similarityStale = m_similarityLoading;
+}
+
+QVariantMap ShotHistoryStorage::aggregate(const QString& groupBy, const QString& bucket,
+                                          const QStringList& metrics, const QVariantMap& filterMap)
+{
+    QVariantMap result;
+    if (!m_ready) return result;
+
+    // Whitelists - nothing from the caller is spliced into SQL unchecked
+    static const QHash<QString, QString> groupColumns = {
+        {"profile", "s.profile_name"},
+        {"beanBrand", "s.bean_brand"},
+        {"beanType", "s.bean_type"},
+        {"bean", "s.bean_brand || ' ' || s.bean_type"},
+        {"grinder", "s.grinder_model"},
+        {"grinderSetting", "s.grinder_setting"},
+        {"barista", "s.barista"},
+        {"roastLevel", "s.roast_level"}
+    };
+    // Bucket start as an ISO date in local time; weeks start on Monday
+    static const QHash<QString, QString> bucketExpressions = {
+        {"day", "date(s.timestamp, 'unixepoch', 'localtime')"},
+        {"week", "date(s.timestamp, 'unixepoch', 'localtime', '-6 days', 'weekday 1')"},
+        {"month", "strftime('%Y-%m-01', s.timestamp, 'unixepoch', 'localtime')"},
+        {"year", "strftime('%Y-01-01', s.timestamp, 'unixepoch', 'localtime')"}
+    };
+    static const QHash<QString, QString> valueColumns = {
+        {"duration", "s.duration_seconds"},
+        {"finalWeight", "s.final_weight"},
+        {"doseWeight", "s.dose_weight"},
+        {"ratio", "s.final_weight / NULLIF(s.dose_weight, 0)"},
+        {"enjoyment", "NULLIF(s.enjoyment, 0)"},  // 0 = not rated
+        {"drinkTds", "NULLIF(s.drink_tds, 0)"},
+        {"drinkEy", "NULLIF(s.drink_ey, 0)"}
+    };
+    static const QStringList aggregateFunctions = {"avg", "min", "max", "sum"};
+
+    if (!groupBy.isEmpty() && !groupColumns.contains(groupBy)) {
+        qWarning() << "ShotHistoryStorage: Unknown aggregate groupBy:" << groupBy;
+        return result;
+    }
+    if (!bucket.isEmpty() && !bucketExpressions.contains(bucket)) {
+        qWarning() << "ShotHistoryStorage: Unknown aggregate bucket:" << bucket;
+        return result;
+    }
+
+    QStringList selects;
+    QStringList keys;
+    QStringList groupTerms;
+    if (!bucket.isEmpty()) {
+        selects << bucketExpressions.value(bucket);
+        keys << "bucket";
+        groupTerms << "1";
+    }
+    if (!groupBy.isEmpty()) {
+        selects << groupColumns.value(groupBy);
+        keys << "group";
+        groupTerms << QString::number(groupTerms.size() + 1);
+    }
+
+    // "count" or "<fn>:<value>", e.g. "avg:ratio", "max:peakPressure" (any ShotMetrics key)
+    bool needsMetrics = false;
+    for (const QString& metric : metrics) {
+        if (metric == "count") {
+            selects << "COUNT(*)";
+            keys << metric;
+            continue;
+        }
+        QString function = metric.section(':', 0, 0);
+        QString value = metric.section(':', 1);
+        QString column = valueColumns.value(value);
+        if (column.isEmpty() && !ShotMetrics::columnForKey(value).isEmpty()) {
+            column = "m." + ShotMetrics::columnForKey(value);
+            needsMetrics = true;
+        }
+        if (!aggregateFunctions.contains(function) || column.isEmpty()) {
+            qWarning() << "ShotHistoryStorage: Unknown aggregate metric:" << metric;
+            continue;
+        }
+        selects << QString("%1(%2)").arg(function.toUpper(), column);
+        keys << metric;
+    }
+    if (selects.size() == groupTerms.size()) {
+        selects << "COUNT(*)";  // No valid metric requested
+        keys << "count";
+    }
+
+    ShotFilter filter = parseFilterMap(filterMap);
+    filter.sortBy.clear();
+    QVariantList bindValues;
+    QString sql = "SELECT " + selects.join(", ")
+                + buildFromClause(filter, QString(), QVariantList(), bindValues, needsMetrics);
+    if (!groupTerms.isEmpty()) {
+        sql += " GROUP BY " + groupTerms.join(", ") + " ORDER BY " + groupTerms.join(", ");
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery query(readConnection());
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (int i = 0; i < bindValues.size(); ++i) {
+        query.bindValue(i, bindValues[i]);
+    }
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Aggregate query failed:" << query.lastError().text();
+        return result;
+    }
+
+    // Column-oriented: one array per key, row i across all of them
+    QVector<QVariantList> columns(keys.size());
+    int rows = 0;
+    while (query.next()) {
+        for (int c = 0; c < keys.size(); ++c) {
+            columns[c].append(query.value(c));
+        }
+        rows++;
+    }
+    for (int c = 0; c < keys.size(); ++c) {
+        result.insert(keys[c], columns[c]);
+    }
+    result["rowCount"] = rows;
+
+    qDebug() << "ShotHistoryStorage: Aggregated" << rows << "rows by" << (bucket.isEmpty() ? "-" : bucket)
+             << "/" << (groupBy.isEmpty() ? "-" : groupBy) << "in" << timer.elapsed() << "ms";
+    return result;
 }
 
-QList<ShotRecord> ShotHistoryStorage::getShotsForComparison(const QList<qint64>& shotIds)
+QList<ShotRecord> ShotHistoryStorage::getShotsForComparison(const QList<qint64>& shotIds, int maxPoints)
 {
     QList<ShotRecord> records;
+    if (!m_ready || shotIds.isEmpty()) return records;
+
+    const int level = maxPoints > 0 ? ShotSeriesLod::levelFor(maxPoints) : 0;
+    QHash<qint64, ShotRecord> byId;
+    QSqlQuery query(readConnection());
+
+    // Set-based reads, COMPARISON_BATCH_SIZE IDs per statement (SQLite bind limit)
+    for (qsizetype offset = 0; offset < shotIds.size(); offset += COMPARISON_BATCH_SIZE) {
+        const QList<qint64> batch = shotIds.mid(offset, COMPARISON_BATCH_SIZE);
+        QStringList placeholders;
+        for (qsizetype i = 0; i < batch.size(); ++i) {
+            placeholders << "?";
+        }
+        const QString idList = placeholders.join(", ");
+        auto bindIds = [&query, &batch]() {
+            for (qint64 id : batch) {
+                query.addBindValue(id);
+            }
+        };
+
+        // Metadata (no debug log or profile JSON - comparison never shows them)
+        query.prepare(QString(R"(
+            SELECT id, uuid, timestamp, profile_name,
+                   duration_seconds, final_weight, dose_weight,
+                   bean_brand, bean_type, roast_date, roast_level,
+                   grinder_model, grinder_setting,
+                   drink_tds, drink_ey, enjoyment, espresso_notes, barista,
+                   visualizer_id, visualizer_url
+            FROM shots WHERE id IN (%1)
+        )").arg(idList));
+        bindIds();
+        if (!query.exec()) {
+            qWarning() << "ShotHistoryStorage: Comparison query failed:" << query.lastError().text();
+            return records;
+        }
+        while (query.next()) {
+            ShotRecord record;
+            record.summary.id = query.value(0).toLongLong();
+            record.summary.uuid = query.value(1).toString();
+            record.summary.timestamp = query.value(2).toLongLong();
+            record.summary.profileName = query.value(3).toString();
+            record.summary.duration = query.value(4).toDouble();
+            record.summary.finalWeight = query.value(5).toDouble();
+            record.summary.doseWeight = query.value(6).toDouble();
+            record.summary.beanBrand = query.value(7).toString();
+            record.summary.beanType = query.value(8).toString();
+            record.roastDate = query.value(9).toString();
+            record.roastLevel = query.value(10).toString();
+            record.grinderModel = query.value(11).toString();
+            record.grinderSetting = query.value(12).toString();
+            record.drinkTds = query.value(13).toDouble();
+            record.drinkEy = query.value(14).toDouble();
+            record.summary.enjoyment = query.value(15).toInt();
+            record.espressoNotes = query.value(16).toString();
+            record.barista = query.value(17).toString();
+            record.visualizerId = query.value(18).toString();
+            record.visualizerUrl = query.value(19).toString();
+            record.summary.hasVisualizerUpload = !record.visualizerId.isEmpty();
+            byId.insert(record.summary.id, record);
+        }
+
+        // Curves: the stored LOD level when one fits maxPoints, else (or when a shot's
+        // level isn't backfilled yet) the full blob, hot or archived
+        QSet<qint64> decoded;
+        auto readSamples = [&](const QString& sql, bool fromLod) {
+            query.prepare(sql.arg(idList));
+            if (fromLod) {
+                query.addBindValue(level);
+            }
+            bindIds();
+            if (!query.exec()) {
+                qWarning() << "ShotHistoryStorage: Comparison samples query failed:" << query.lastError().text();
+                return;
+            }
+            while (query.next()) {
+                const qint64 id = query.value(0).toLongLong();
+                auto it = byId.find(id);
+                if (it == byId.end() || decoded.contains(id)) continue;
+                ShotRecord samples;
+                if (!decodeSampleData(query.value(1).toByteArray(), &samples)) continue;
+                // A stored level already holds 'level' points; a full blob always needs reducing
+                if (maxPoints > 0 && (!fromLod || maxPoints != level)) {
+                    samples = ShotSeriesLod::buildLevel(samples, maxPoints);
+                }
+                for (int c = 0; c < ShotSampleCodec::ChannelCount; ++c) {
+                    auto channel = static_cast<ShotSampleCodec::Channel>(c);
+                    *ShotSampleCodec::series(&it.value(), channel) = ShotSampleCodec::series(samples, channel);
+                }
+                decoded.insert(id);
+            }
+        };
+        if (level > 0) {
+            readSamples("SELECT shot_id, data_blob FROM shot_series_lod WHERE max_points = ? AND shot_id IN (%1)", true);
+        }
+        if (decoded.size() < byId.size()) {
+            readSamples("SELECT shot_id, data_blob FROM shot_samples_all WHERE shot_id IN (%1) ORDER BY tier", false);
+        }
+
+        query.prepare(QString("SELECT shot_id, time_offset, label, frame_number, is_flow_mode FROM shot_phases "
+                              "WHERE shot_id IN (%1) ORDER BY shot_id, time_offset").arg(idList));
+        bindIds();
+        if (query.exec()) {
+            while (query.next()) {
+                auto it = byId.find(query.value(0).toLongLong());
+                if (it == byId.end()) continue;
+                HistoryPhaseMarker marker;
+                marker.time = query.value(1).toDouble();
+                marker.label = query.value(2).toString();
+                marker.frameNumber = query.value(3).toInt();
+                marker.isFlowMode = query.value(4).toInt() != 0;
+                it->phases.append(marker);
+            }
+        }
+    }
+
+    // Requested order; deleted shots are skipped
+    records.reserve(byId.size());
     for (qint64 id : shotIds) {
-        ShotRecord record = getShotRecord(id);
-        if (record.summary.id != 0) {
-            records.append(record);
+        auto it = byId.find(id);
+        if (it != byId.end()) {
+            records.append(std::move(it.value()));
+            byId.erase(it);
         }
     }
     return records;
@@ -791,6 +2300,13 @@ bool ShotHistoryStorage::deleteShot(qint64 shotId)
         return false;
     }
 
+    // No cascade across database files
+    query.prepare("DELETE FROM archive.shot_samples WHERE shot_id = ?");
+    query.bindValue(0, shotId);
+    query.exec();
+
+    m_similarityIndex->remove(shotId);
+    m_similarityStale = m_similarityStale || m_similarityLoading;
     updateTotalShots();
     emit shotDeleted(shotId);
 
@@ -842,31 +2358,38 @@ bool ShotHistoryStorage::updateShotMetadata(qint64 shotId, const QVariantMap& me
         return false;
     }
 
+    // Keep the derived ratio in step with edited weights
+    double doseWeight = metadata.value("doseWeight").toDouble();
+    double finalWeight = metadata.value("finalWeight").toDouble();
+    query.prepare("UPDATE shot_metrics SET ratio = ? WHERE shot_id = ?");
+    query.addBindValue(doseWeight > 0 && finalWeight > 0 ? QVariant(finalWeight / doseWeight) : QVariant());
+    query.addBindValue(shotId);
+    query.exec();
+
+    emit shotUpdated(shotId);
+
     qDebug() << "ShotHistoryStorage: Updated metadata for shot" << shotId;
     return true;
 }
 
-// Helper for all getDistinct* methods
+// Helper for all getDistinct* methods - reads the trigger-maintained facet table
 QStringList ShotHistoryStorage::getDistinctValues(const QString& column)
 {
     QStringList results;
     if (!m_ready) return results;
 
-    QString sql = QString("SELECT DISTINCT %1 FROM shots WHERE %1 IS NOT NULL AND %1 != '' ORDER BY %1")
-                      .arg(column);
-
-    QSqlQuery query(m_db);
-    query.exec(sql);
+    QSqlQuery query(readConnection());
+    query.prepare("SELECT value FROM shot_facets WHERE facet = ? ORDER BY value");
+    query.addBindValue(column);
+    query.exec();
     while (query.next()) {
-        QString value = query.value(0).toString();
-        if (!value.isEmpty()) {
-            results << value;
-        }
+        results << query.value(0).toString();
     }
     return results;
 }
 
-// Helper for all getDistinct*Filtered methods
+// Helper for all getDistinct*Filtered methods. Column must be one of the
+// cascading facets (profile_name, bean_brand, bean_type) in shot_facet_combos.
 QStringList ShotHistoryStorage::getDistinctValuesFiltered(const QString& column,
                                                            const QString& excludeColumn,
                                                            const QVariantMap& filter)
@@ -874,30 +2397,23 @@ QStringList ShotHistoryStorage::getDistinctValuesFiltered(const QString& column,
     QStringList results;
     if (!m_ready) return results;
 
-    QString sql = QString("SELECT DISTINCT %1 FROM shots WHERE %1 IS NOT NULL AND %1 != ''")
-                      .arg(column);
+    QString sql = QString("SELECT %1 FROM shot_facet_combos WHERE %1 != ''").arg(column);
     QVariantList bindValues;
 
-    // Map of filter keys to database columns
-    static const QHash<QString, QString> filterToColumn = {
-        {"profileName", "profile_name"},
-        {"beanBrand", "bean_brand"},
-        {"beanType", "bean_type"}
-    };
-
-    for (auto it = filterToColumn.constBegin(); it != filterToColumn.constEnd(); ++it) {
+    for (const auto& facet : FACET_COLUMNS) {
         // Skip if this is the column we're querying (don't filter on self)
-        if (it.value() == excludeColumn) continue;
+        if (!facet.cascading || excludeColumn == QLatin1String(facet.column)) continue;
 
-        if (filter.contains(it.key()) && !filter.value(it.key()).toString().isEmpty()) {
-            sql += QString(" AND %1 = ?").arg(it.value());
-            bindValues << filter.value(it.key()).toString();
+        QString value = filter.value(QString::fromLatin1(facet.key)).toString();
+        if (!value.isEmpty()) {
+            sql += QString(" AND %1 = ?").arg(QString::fromLatin1(facet.column));
+            bindValues << value;
         }
     }
 
-    sql += QString(" ORDER BY %1").arg(column);
+    sql += QString(" GROUP BY %1 ORDER BY %1").arg(column);
 
-    QSqlQuery query(m_db);
+    QSqlQuery query(readConnection());
     query.prepare(sql);
     for (int i = 0; i < bindValues.size(); ++i) {
         query.bindValue(i, bindValues[i]);
@@ -905,10 +2421,64 @@ QStringList ShotHistoryStorage::getDistinctValuesFiltered(const QString& column,
     query.exec();
 
     while (query.next()) {
-        QString value = query.value(0).toString();
-        if (!value.isEmpty()) {
-            results << value;
+        results << query.value(0).toString();
+    }
+    return results;
+}
+
+QVariantMap ShotHistoryStorage::getFacets(const QVariantMap& filter)
+{
+    QVariantMap results;
+    for (const auto& facet : FACET_COLUMNS) {
+        results.insert(QString::fromLatin1(facet.key), QVariantList());
+    }
+    if (!m_ready) return results;
+
+    // One UNION ALL over the facet tables: cascading facets are narrowed by the
+    // other cascading selections (never by themselves), the rest are global counts
+    QStringList selects;
+    QStringList globalFacets;
+    QVariantList bindValues;
+    for (const auto& facet : FACET_COLUMNS) {
+        QString column = QString::fromLatin1(facet.column);
+        if (!facet.cascading) {
+            globalFacets << QString("'%1'").arg(column);
+            continue;
+        }
+
+        QString select = QString("SELECT '%1', %1, SUM(shot_count) FROM shot_facet_combos WHERE %1 != ''").arg(column);
+        for (const auto& other : FACET_COLUMNS) {
+            if (!other.cascading || &other == &facet) continue;
+            QString value = filter.value(QString::fromLatin1(other.key)).toString();
+            if (!value.isEmpty()) {
+                select += QString(" AND %1 = ?").arg(QString::fromLatin1(other.column));
+                bindValues << value;
+            }
         }
+        selects << select + QString(" GROUP BY %1").arg(column);
+    }
+    selects << QString("SELECT facet, value, shot_count FROM shot_facets WHERE facet IN (%1)")
+                   .arg(globalFacets.join(", "));
+
+    QSqlQuery query(readConnection());
+    query.prepare(selects.join(" UNION ALL ") + " ORDER BY 1, 2");
+    for (int i = 0; i < bindValues.size(); ++i) {
+        query.bindValue(i, bindValues[i]);
+    }
+    if (!query.exec()) {
+        qWarning() << "ShotHistoryStorage: Facet query failed:" << query.lastError().text();
+        return results;
+    }
+
+    QHash<QString, QVariantList> options;
+    while (query.next()) {
+        QVariantMap option;
+        option["value"] = query.value(1).toString();
+        option["count"] = query.value(2).toInt();
+        options[query.value(0).toString()].append(option);
+    }
+    for (const auto& facet : FACET_COLUMNS) {
+        results.insert(QString::fromLatin1(facet.key), options.value(QString::fromLatin1(facet.column)));
     }
     return results;
 }
@@ -967,13 +2537,12 @@ int ShotHistoryStorage::getFilteredShotCount(const QVariantMap& filterMap)
 {
     if (!m_ready) return 0;
 
+    // Same FROM/WHERE as the listed pages (FTS terms included), so the total matches the rows
     ShotFilter filter = parseFilterMap(filterMap);
     QVariantList bindValues;
-    QString whereClause = buildFilterQuery(filter, bindValues);
+    QString sql = "SELECT COUNT(*)" + buildFromClause(filter, QString(), QVariantList(), bindValues);
 
-    QString sql = "SELECT COUNT(*) FROM shots" + whereClause;
-
-    QSqlQuery query(m_db);
+    QSqlQuery query(readConnection());
     query.prepare(sql);
     for (int i = 0; i < bindValues.size(); ++i) {
         query.bindValue(i, bindValues[i]);
@@ -1053,7 +2622,7 @@ QVariantList ShotHistoryStorage::getAutoFavorites(const QString& groupBy, int ma
         "LIMIT %4"
     ).arg(selectColumns, groupColumns, joinConditions).arg(maxItems);
 
-    QSqlQuery query(m_db);
+    QSqlQuery query(readConnection());
     if (!query.exec(sql)) {
         qWarning() << "getAutoFavorites query failed:" << query.lastError().text();
         qWarning() << "SQL:" << sql;
@@ -1163,7 +2732,7 @@ void ShotHistoryStorage::updateTotalShots()
 
 QString ShotHistoryStorage::exportDatabase()
 {
-    if (m_dbPath.isEmpty()) {
+    if (m_dbPath.isEmpty() || !m_ready) {
         emit errorOccurred("Database path not set");
         return QString();
     }
@@ -1178,24 +2747,189 @@ QString ShotHistoryStorage::exportDatabase()
     QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
     QString destPath = downloadsDir + "/shots_" + timestamp + ".db";
 
-    // Close database temporarily to ensure all data is flushed
-    m_db.close();
+    // VACUUM INTO writes a consistent snapshot (WAL contents included) from a pooled
+    // read connection, so neither the writer nor the GUI thread is held up
+    runRead([this, destPath]() {
+        return snapshotDatabase(destPath);
+    }).then(this, [this, destPath](const QString& sqlError) {
+        if (sqlError.isEmpty()) {
+            qDebug() << "ShotHistoryStorage: Exported database to" << destPath;
+            emit databaseExported(destPath);
+        } else {
+            QString error = "Failed to export database to " + destPath;
+            qWarning() << "ShotHistoryStorage:" << error << sqlError;
+            emit errorOccurred(error);
+        }
+    });
+
+    return destPath;
+}
 
-    // Copy file
-    bool success = QFile::copy(m_dbPath, destPath);
+QString ShotHistoryStorage::snapshotDatabase(const QString& destPath)
+{
+    if (!m_ready) return QStringLiteral("Database not open");
 
-    // Reopen database
-    m_db.open();
+    QSqlQuery query(readConnection());
+    query.prepare("VACUUM INTO ?");
+    query.addBindValue(destPath);
+    if (!query.exec()) {
+        return query.lastError().text();
+    }
+    // The copy is one self-contained file: fold archived samples back in
+    return unarchiveInto(destPath, m_dbPath);
+}
 
-    if (success) {
-        qDebug() << "ShotHistoryStorage: Exported database to" << destPath;
-        return destPath;
-    } else {
-        QString error = "Failed to export database to " + destPath;
-        qWarning() << "ShotHistoryStorage:" << error;
-        emit errorOccurred(error);
+qint64 ShotHistoryStorage::streamShots(const QString& format, const QVariantMap& filterMap,
+                                       const std::function<bool(const QByteArray&)>& write)
+{
+    ShotExportFormat::Format exportFormat;
+    if (!m_ready || !ShotExportFormat::parse(format, &exportFormat)) {
+        qWarning() << "ShotHistoryStorage: Cannot stream shots as" << format;
+        return -1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    ShotFilter filter = parseFilterMap(filterMap);
+    filter.sortBy.clear();  // Keyset walk, oldest first
+
+    QByteArray header = ShotExportFormat::header(exportFormat);
+    if (!header.isEmpty() && !write(header)) {
+        return 0;
+    }
+
+    qint64 written = 0;
+    qint64 lastTimestamp = 0;
+    qint64 lastId = 0;
+    bool first = true;
+    while (true) {
+        // Next batch of IDs after the last one written; only IDs are held, never the batch's samples
+        QString condition;
+        QVariantList cursorValues;
+        if (!first) {
+            condition = "s.timestamp >= ? AND (s.timestamp, s.id) > (?, ?)";
+            cursorValues << lastTimestamp << lastTimestamp << lastId;
+        }
+        QVariantList bindValues;
+        QString sql = QString("SELECT s.id, s.timestamp%1 ORDER BY s.timestamp, s.id LIMIT ?")
+            .arg(buildFromClause(filter, condition, cursorValues, bindValues));
+        bindValues << EXPORT_BATCH_SIZE;
+
+        QSqlQuery query(readConnection());
+        query.setForwardOnly(true);
+        query.prepare(sql);
+        for (int i = 0; i < bindValues.size(); ++i) {
+            query.bindValue(i, bindValues[i]);
+        }
+        if (!query.exec()) {
+            qWarning() << "ShotHistoryStorage: Shot stream query failed:" << query.lastError().text();
+            return -1;
+        }
+
+        QList<QPair<qint64, qint64>> batch;
+        while (query.next()) {
+            batch.append({query.value(0).toLongLong(), query.value(1).toLongLong()});
+        }
+        query.finish();
+        if (batch.isEmpty()) break;
+
+        for (const auto& row : batch) {
+            ShotRecord record = getShotRecord(row.first);
+            if (record.summary.id == 0) continue;  // Deleted since the batch was read
+            if (!write(ShotExportFormat::encode(exportFormat, record))) {
+                qDebug() << "ShotHistoryStorage: Shot stream stopped by receiver after" << written << "shots";
+                return written;
+            }
+            written++;
+        }
+        lastId = batch.last().first;
+        lastTimestamp = batch.last().second;
+        first = false;
+        if (batch.size() < EXPORT_BATCH_SIZE) break;
+    }
+
+    qDebug() << "ShotHistoryStorage: Streamed" << written << "shots as" << format << "in" << timer.elapsed() << "ms";
+    return written;
+}
+
+QString ShotHistoryStorage::exportHistory(const QString& format, const QVariantMap& filter)
+{
+    ShotExportFormat::Format exportFormat;
+    if (!m_ready || !ShotExportFormat::parse(format, &exportFormat)) {
+        emit errorOccurred("Unsupported export format: " + format);
+        return QString();
+    }
+
+    QString downloadsDir = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
+    if (downloadsDir.isEmpty()) {
+        downloadsDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    }
+    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+    QString destPath = downloadsDir + "/shots_" + timestamp + "." + ShotExportFormat::fileExtension(exportFormat);
+
+    runRead([this, format, filter, destPath]() {
+        QFile file(destPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return qint64(-1);
+        }
+        qint64 count = streamShots(format, filter, [&file](const QByteArray& chunk) {
+            return file.write(chunk) == chunk.size();
+        });
+        file.close();
+        if (count < 0 || file.error() != QFileDevice::NoError) {
+            file.remove();
+            return qint64(-1);
+        }
+        return count;
+    }).then(this, [this, destPath](qint64 count) {
+        if (count >= 0) {
+            qDebug() << "ShotHistoryStorage: Exported" << count << "shots to" << destPath;
+            emit historyExported(destPath, count);
+        } else {
+            QString error = "Failed to export shot history to " + destPath;
+            qWarning() << "ShotHistoryStorage:" << error;
+            emit errorOccurred(error);
+        }
+    });
+
+    return destPath;
+}
+
+QString ShotHistoryStorage::unarchiveInto(const QString& exportPath, const QString& dbPath)
+{
+    if (!QFileInfo::exists(archivePath(dbPath))) {
         return QString();
     }
+
+    const QString name = QString("%1_Export_%2").arg(DB_CONNECTION_NAME)
+                             .arg(reinterpret_cast<quintptr>(QThread::currentThread()), 0, 16);
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(exportPath);
+        if (!db.open()) {
+            error = db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            query.prepare("ATTACH DATABASE ? AS archive");
+            query.addBindValue(archivePath(dbPath));
+            if (!query.exec() || !query.exec(R"(
+                    INSERT OR IGNORE INTO main.shot_samples (shot_id, sample_count, data_blob, encoding)
+                    SELECT a.shot_id, a.sample_count, a.data_blob, a.encoding
+                    FROM archive.shot_samples a
+                    WHERE a.shot_id IN (SELECT id FROM main.shots)
+                )")) {
+                error = query.lastError().text();
+            } else {
+                qDebug() << "ShotHistoryStorage: Added" << query.numRowsAffected() << "archived samples to export";
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(name);
+    return error;
 }
 
 void ShotHistoryStorage::checkpoint()
@@ -1275,168 +3009,299 @@ bool ShotHistoryStorage::importDatabase(const QString& filePath, bool merge)
 
     qDebug() << "ShotHistoryStorage: Importing from" << cleanPath << (merge ? "(merge)" : "(replace)");
 
-    // Open source database
-    QSqlDatabase srcDb = QSqlDatabase::addDatabase("QSQLITE", "import_connection");
-    srcDb.setDatabaseName(cleanPath);
+    ImportResult result = mergeDatabaseFile(m_db, cleanPath, merge, [this](int processed, int total) {
+        emit importProgress(processed, total);
+    });
+
+    // Merge batches committed before a failure stay imported, so the bookkeeping runs either way
+    updateTotalShots();
+
+    // Derive anything the source didn't carry (metrics, LOD levels, fingerprints, columnar blobs) in the background
+    if (m_worker && result.imported > 0) {
+        QMetaObject::invokeMethod(m_worker, &ShotStorageWorker::migrateSampleEncoding, Qt::QueuedConnection);
+        QMetaObject::invokeMethod(m_worker, &ShotStorageWorker::backfillMetrics, Qt::QueuedConnection);
+        QMetaObject::invokeMethod(m_worker, &ShotStorageWorker::backfillSeriesLod, Qt::QueuedConnection);
+        QMetaObject::invokeMethod(m_worker, &ShotStorageWorker::backfillFingerprints, Qt::QueuedConnection);
+    }
+    invalidateSimilarityIndex();
 
-    if (!srcDb.open()) {
-        QString error = "Failed to open import database: " + srcDb.lastError().text();
-        qWarning() << "ShotHistoryStorage:" << error;
-        emit errorOccurred(error);
-        QSqlDatabase::removeDatabase("import_connection");
+    if (!result.errorMessage.isEmpty()) {
+        qWarning() << "ShotHistoryStorage:" << result.errorMessage;
+        emit errorOccurred(result.errorMessage);
         return false;
     }
 
-    // Verify source has shots table
-    int sourceCount = 0;
-    {
-        QSqlQuery srcCheck(srcDb);
-        if (!srcCheck.exec("SELECT COUNT(*) FROM shots")) {
-            QString error = "Import file is not a valid shots database (no 'shots' table found)";
-            qWarning() << "ShotHistoryStorage:" << error;
-            emit errorOccurred(error);
-            srcCheck.finish();  // Release query before closing connection
-            srcDb.close();
-            QSqlDatabase::removeDatabase("import_connection");
-            return false;
+    double seconds = qMax<qint64>(result.elapsedMs, 1) / 1000.0;
+    qDebug() << "ShotHistoryStorage: Import complete -" << result.imported << "imported,"
+             << result.skipped << "skipped in" << result.elapsedMs << "ms ("
+             << qRound(result.sourceShots / seconds) << "shots/s)";
+    return true;
+}
+
+ShotHistoryStorage::ImportResult ShotHistoryStorage::mergeDatabaseFile(
+    QSqlDatabase& db, const QString& srcPath, bool merge,
+    const std::function<void(int, int)>& progress)
+{
+    ImportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    // The source is attached to the destination connection, so every copy below is
+    // a set-based INSERT ... SELECT inside SQLite rather than a row-by-row round trip
+    QSqlQuery query(db);
+    query.prepare("ATTACH DATABASE ? AS src");
+    query.addBindValue(srcPath);
+    if (!query.exec()) {
+        result.errorMessage = "Failed to open import database: " + query.lastError().text();
+        return result;
+    }
+
+    // A copy of a device's history directory may carry its sample archive alongside;
+    // blobs found only there are imported as well
+    bool sourceHasArchive = false;
+    const QString srcArchive = archivePath(srcPath);
+    if (QFileInfo::exists(srcArchive)) {
+        query.prepare("ATTACH DATABASE ? AS srcarchive");
+        query.addBindValue(srcArchive);
+        sourceHasArchive = query.exec();
+        if (!sourceHasArchive) {
+            qWarning() << "ShotHistoryStorage: Ignoring unreadable import archive" << srcArchive
+                       << query.lastError().text();
         }
-        srcCheck.next();
-        sourceCount = srcCheck.value(0).toInt();
-        srcCheck.finish();  // Release query before we might close connection
-    }  // srcCheck destroyed here
-
-    if (sourceCount == 0) {
-        QString error = "Import file contains no shots (database is empty)";
-        qWarning() << "ShotHistoryStorage:" << error;
-        emit errorOccurred(error);
-        srcDb.close();
-        QSqlDatabase::removeDatabase("import_connection");
-        return false;
     }
 
-    qDebug() << "ShotHistoryStorage: Source has" << sourceCount << "shots";
+    auto detach = [&db, sourceHasArchive]() {
+        QSqlQuery detachQuery(db);
+        detachQuery.exec("DROP TABLE IF EXISTS temp.import_map");
+        detachQuery.exec("DETACH DATABASE src");
+        if (sourceHasArchive) {
+            detachQuery.exec("DETACH DATABASE srcarchive");
+        }
+    };
+
+    // Verify source has shots table
+    if (!query.exec("SELECT COUNT(*) FROM src.shots") || !query.next()) {
+        result.errorMessage = "Import file is not a valid shots database (no 'shots' table found)";
+        query.finish();
+        detach();
+        return result;
+    }
+    result.sourceShots = query.value(0).toInt();
+    query.finish();
+
+    if (result.sourceShots == 0) {
+        result.errorMessage = "Import file contains no shots (database is empty)";
+        detach();
+        return result;
+    }
+
+    // Older exports predate shot_metrics/shot_series_lod - those rows are backfilled by the worker instead
+    auto sourceHasTable = [&query](const QString& table) {
+        query.prepare("SELECT 1 FROM src.sqlite_master WHERE type = 'table' AND name = ?");
+        query.addBindValue(table);
+        bool found = query.exec() && query.next();
+        query.finish();
+        return found;
+    };
+    bool sourceHasMetrics = sourceHasTable("shot_metrics");
+    bool sourceHasLod = sourceHasTable("shot_series_lod");
+    bool sourceHasFingerprints = sourceHasTable("shot_fingerprints");
+
+    qDebug() << "ShotHistoryStorage: Source has" << result.sourceShots << "shots";
 
-    // Begin transaction on destination
-    m_db.transaction();
+    // Merge mode commits per batch. Replace mode runs as one transaction, so a failure
+    // part way through rolls back to the old history instead of losing it.
+    db.transaction();
 
     if (!merge) {
         // Replace mode: delete all existing data
-        QSqlQuery delQuery(m_db);
-        delQuery.exec("DELETE FROM shot_phases");
-        delQuery.exec("DELETE FROM shot_samples");
-        delQuery.exec("DELETE FROM shots");
+        query.exec("DELETE FROM main.shot_metrics");
+        query.exec("DELETE FROM main.shot_series_lod");
+        query.exec("DELETE FROM main.shot_fingerprints");
+        query.exec("DELETE FROM main.shot_phases");
+        query.exec("DELETE FROM main.shot_samples");
+        query.exec("DELETE FROM archive.shot_samples");  // Fails harmlessly when none is attached
+        query.exec("DELETE FROM main.shots");
         qDebug() << "ShotHistoryStorage: Cleared existing data for replace";
     }
 
-    // Get existing UUIDs for merge mode
-    QSet<QString> existingUuids;
-    if (merge) {
-        QSqlQuery uuidQuery(m_db);
-        uuidQuery.exec("SELECT uuid FROM shots");
-        while (uuidQuery.next()) {
-            existingUuids.insert(uuidQuery.value(0).toString());
-        }
-        qDebug() << "ShotHistoryStorage: Found" << existingUuids.size() << "existing shots";
+    // Source shot id -> new shot id for the batch being copied
+    query.exec("CREATE TEMP TABLE IF NOT EXISTS import_map (old_id INTEGER PRIMARY KEY, new_id INTEGER NOT NULL)");
+
+    static const QString shotColumns = R"(
+        uuid, timestamp, profile_name, profile_json,
+        duration_seconds, final_weight, dose_weight,
+        bean_brand, bean_type, roast_date, roast_level,
+        grinder_model, grinder_setting, drink_tds, drink_ey,
+        enjoyment, espresso_notes, barista,
+        visualizer_id, visualizer_url, debug_log)";
+    QString prefixedColumns = shotColumns.simplified();
+    prefixedColumns.replace(", ", ", s.").prepend("s.");
+
+    // Anti-join on the unique uuid index: shots already present are never read into memory
+    QSqlQuery insertShots(db);
+    insertShots.prepare(QString(R"(
+        INSERT INTO main.shots (%1)
+        SELECT %2 FROM src.shots s
+        WHERE s.id > ? AND s.id <= ?
+          AND NOT EXISTS (SELECT 1 FROM main.shots d WHERE d.uuid = s.uuid)
+        ORDER BY s.id
+    )").arg(shotColumns, prefixedColumns));
+
+    QSqlQuery mapIds(db);
+    mapIds.prepare(R"(
+        INSERT INTO temp.import_map (old_id, new_id)
+        SELECT s.id, d.id FROM src.shots s JOIN main.shots d ON d.uuid = s.uuid
+        WHERE s.id > ? AND s.id <= ? AND d.id > ?
+    )");
+
+    QByteArray binaryHeader = ShotSampleCodec::formatHeader();
+    const QString sourceSamples = sourceHasArchive
+        ? QStringLiteral("(SELECT shot_id, sample_count, data_blob FROM src.shot_samples "
+                         "UNION ALL SELECT a.shot_id, a.sample_count, a.data_blob FROM srcarchive.shot_samples a "
+                         "WHERE a.shot_id NOT IN (SELECT shot_id FROM src.shot_samples))")
+        : QStringLiteral("src.shot_samples");
+    QSqlQuery copySamples(db);
+    copySamples.prepare(QString(R"(
+        INSERT INTO main.shot_samples (shot_id, sample_count, data_blob, encoding)
+        SELECT m.new_id, ss.sample_count, ss.data_blob,
+               CASE WHEN substr(ss.data_blob, 1, ?) = ? THEN ? ELSE ? END
+        FROM temp.import_map m JOIN %1 ss ON ss.shot_id = m.old_id
+    )").arg(sourceSamples));
+
+    QSqlQuery copyPhases(db);
+    copyPhases.prepare(R"(
+        INSERT INTO main.shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode)
+        SELECT m.new_id, p.time_offset, p.label, p.frame_number, p.is_flow_mode
+        FROM temp.import_map m JOIN src.shot_phases p ON p.shot_id = m.old_id
+        ORDER BY p.id
+    )");
+
+    QSqlQuery copyMetrics(db);
+    if (sourceHasMetrics) {
+        QString metricColumns = ShotMetrics::columnNames().join(", ");
+        QString sourceMetricColumns = "x." + ShotMetrics::columnNames().join(", x.");
+        copyMetrics.prepare(QString(R"(
+            INSERT OR REPLACE INTO main.shot_metrics (shot_id, %1)
+            SELECT m.new_id, %2
+            FROM temp.import_map m JOIN src.shot_metrics x ON x.shot_id = m.old_id
+        )").arg(metricColumns, sourceMetricColumns));
+    }
+
+    QSqlQuery copyLod(db);
+    if (sourceHasLod) {
+        copyLod.prepare(R"(
+            INSERT OR REPLACE INTO main.shot_series_lod (shot_id, max_points, data_blob)
+            SELECT m.new_id, l.max_points, l.data_blob
+            FROM temp.import_map m JOIN src.shot_series_lod l ON l.shot_id = m.old_id
+        )");
     }
 
-    // Import shots
-    int imported = 0, skipped = 0;
-    QSqlQuery srcShots(srcDb);
-    srcShots.exec("SELECT * FROM shots");
+    QSqlQuery copyFingerprints(db);
+    if (sourceHasFingerprints) {
+        // Other versions are recomputed by the worker backfill
+        copyFingerprints.prepare(R"(
+            INSERT OR REPLACE INTO main.shot_fingerprints (shot_id, version, vector)
+            SELECT m.new_id, f.version, f.vector
+            FROM temp.import_map m JOIN src.shot_fingerprints f ON f.shot_id = m.old_id
+            WHERE f.version = ?
+        )");
+    }
 
-    while (srcShots.next()) {
-        QString uuid = srcShots.value("uuid").toString();
+    QSqlQuery batchEnd(db);
+    batchEnd.prepare("SELECT id FROM src.shots WHERE id > ? ORDER BY id LIMIT 1 OFFSET ?");
 
-        if (merge && existingUuids.contains(uuid)) {
-            skipped++;
-            continue;
-        }
+    QSqlQuery maxId(db);
 
-        // Insert shot
-        QSqlQuery insert(m_db);
-        insert.prepare(R"(
-            INSERT INTO shots (uuid, timestamp, profile_name, profile_json,
-                duration_seconds, final_weight, dose_weight,
-                bean_brand, bean_type, roast_date, roast_level,
-                grinder_model, grinder_setting, drink_tds, drink_ey,
-                enjoyment, espresso_notes, barista,
-                visualizer_id, visualizer_url, debug_log)
-            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        )");
+    auto fail = [&](const QString& error) {
+        if (!merge) result.imported = 0;  // Rolled back with the DELETEs
+        result.errorMessage = result.imported > 0
+            ? QString("Import failed after %1 shots: %2").arg(result.imported).arg(error)
+            : "Import failed: " + error;
+        db.rollback();
+        detach();
+        return result;
+    };
 
-        insert.addBindValue(uuid);
-        insert.addBindValue(srcShots.value("timestamp"));
-        insert.addBindValue(srcShots.value("profile_name"));
-        insert.addBindValue(srcShots.value("profile_json"));
-        insert.addBindValue(srcShots.value("duration_seconds"));
-        insert.addBindValue(srcShots.value("final_weight"));
-        insert.addBindValue(srcShots.value("dose_weight"));
-        insert.addBindValue(srcShots.value("bean_brand"));
-        insert.addBindValue(srcShots.value("bean_type"));
-        insert.addBindValue(srcShots.value("roast_date"));
-        insert.addBindValue(srcShots.value("roast_level"));
-        insert.addBindValue(srcShots.value("grinder_model"));
-        insert.addBindValue(srcShots.value("grinder_setting"));
-        insert.addBindValue(srcShots.value("drink_tds"));
-        insert.addBindValue(srcShots.value("drink_ey"));
-        insert.addBindValue(srcShots.value("enjoyment"));
-        insert.addBindValue(srcShots.value("espresso_notes"));
-        insert.addBindValue(srcShots.value("barista"));
-        insert.addBindValue(srcShots.value("visualizer_id"));
-        insert.addBindValue(srcShots.value("visualizer_url"));
-        insert.addBindValue(srcShots.value("debug_log"));
-
-        if (!insert.exec()) {
-            qWarning() << "ShotHistoryStorage: Failed to import shot:" << insert.lastError().text();
-            continue;
+    // Merging commits each batch on its own, so the storage worker isn't locked out of the
+    // database for the whole import. Batches committed before a failure are kept;
+    // merging the same file again skips them as duplicates.
+    int processed = 0;
+    qint64 batchStart = std::numeric_limits<qint64>::min();
+    while (processed < result.sourceShots) {
+        batchEnd.addBindValue(batchStart);
+        batchEnd.addBindValue(IMPORT_BATCH_SIZE - 1);
+        qint64 batchLast = std::numeric_limits<qint64>::max();
+        if (batchEnd.exec() && batchEnd.next()) {
+            batchLast = batchEnd.value(0).toLongLong();
+        }
+        batchEnd.finish();
+
+        // New rows get ids above everything present before this batch
+        maxId.exec("SELECT COALESCE(MAX(id), 0) FROM main.shots");
+        qint64 idFloor = maxId.next() ? maxId.value(0).toLongLong() : 0;
+        maxId.finish();
+
+        insertShots.addBindValue(batchStart);
+        insertShots.addBindValue(batchLast);
+        if (!insertShots.exec()) return fail(insertShots.lastError().text());
+        int inserted = insertShots.numRowsAffected();
+
+        if (inserted > 0) {
+            query.exec("DELETE FROM temp.import_map");
+            mapIds.addBindValue(batchStart);
+            mapIds.addBindValue(batchLast);
+            mapIds.addBindValue(idFloor);
+            if (!mapIds.exec()) return fail(mapIds.lastError().text());
+
+            copySamples.addBindValue(binaryHeader.size());
+            copySamples.addBindValue(binaryHeader);
+            copySamples.addBindValue(SAMPLE_ENCODING_COLUMNAR);
+            copySamples.addBindValue(SAMPLE_ENCODING_LEGACY_JSON);
+            if (!copySamples.exec()) return fail(copySamples.lastError().text());
+            if (!copyPhases.exec()) return fail(copyPhases.lastError().text());
+            if (sourceHasMetrics && !copyMetrics.exec()) return fail(copyMetrics.lastError().text());
+            if (sourceHasLod && !copyLod.exec()) return fail(copyLod.lastError().text());
+            if (sourceHasFingerprints) {
+                copyFingerprints.addBindValue(ShotFingerprint::VERSION);
+                if (!copyFingerprints.exec()) return fail(copyFingerprints.lastError().text());
+            }
         }
 
-        qint64 oldId = srcShots.value("id").toLongLong();
-        qint64 newId = insert.lastInsertId().toLongLong();
-
-        // Import samples for this shot
-        QSqlQuery srcSamples(srcDb);
-        srcSamples.prepare("SELECT sample_count, data_blob FROM shot_samples WHERE shot_id = ?");
-        srcSamples.addBindValue(oldId);
-        if (srcSamples.exec() && srcSamples.next()) {
-            QSqlQuery insertSample(m_db);
-            insertSample.prepare("INSERT INTO shot_samples (shot_id, sample_count, data_blob) VALUES (?, ?, ?)");
-            insertSample.addBindValue(newId);
-            insertSample.addBindValue(srcSamples.value(0));
-            insertSample.addBindValue(srcSamples.value(1));
-            insertSample.exec();
-        }
-
-        // Import phases for this shot
-        QSqlQuery srcPhases(srcDb);
-        srcPhases.prepare("SELECT time_offset, label, frame_number, is_flow_mode FROM shot_phases WHERE shot_id = ?");
-        srcPhases.addBindValue(oldId);
-        if (srcPhases.exec()) {
-            while (srcPhases.next()) {
-                QSqlQuery insertPhase(m_db);
-                insertPhase.prepare("INSERT INTO shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode) VALUES (?, ?, ?, ?, ?)");
-                insertPhase.addBindValue(newId);
-                insertPhase.addBindValue(srcPhases.value(0));
-                insertPhase.addBindValue(srcPhases.value(1));
-                insertPhase.addBindValue(srcPhases.value(2));
-                insertPhase.addBindValue(srcPhases.value(3));
-                insertPhase.exec();
+        query.prepare("SELECT COUNT(*) FROM src.shots WHERE id > ? AND id <= ?");
+        query.addBindValue(batchStart);
+        query.addBindValue(batchLast);
+        int batchSize = (query.exec() && query.next()) ? query.value(0).toInt() : 0;
+        query.finish();
+
+        result.imported += inserted;
+        result.skipped += batchSize - inserted;
+        processed += batchSize;
+        if (merge) {
+            if (!db.commit()) {
+                result.imported -= inserted;
+                return fail(db.lastError().text());
             }
+            db.transaction();
         }
+        if (progress) progress(processed, result.sourceShots);
 
-        imported++;
+        if (batchLast == std::numeric_limits<qint64>::max() || batchSize == 0) break;
+        batchStart = batchLast;
     }
 
-    m_db.commit();
-
-    // Clean up source connection
-    srcDb.close();
-    QSqlDatabase::removeDatabase("import_connection");
-
-    updateTotalShots();
+    // Replace mode's single transaction; in merge mode the (empty) one opened after the last batch
+    if (!db.commit()) {
+        if (merge) {
+            db.rollback();
+        } else {
+            return fail(db.lastError().text());
+        }
+    }
+    detach();
 
-    qDebug() << "ShotHistoryStorage: Import complete -" << imported << "imported," << skipped << "skipped";
-    return true;
+    result.elapsedMs = timer.elapsed();
+    return result;
 }
 
 qint64 ShotHistoryStorage::importShotRecord(const ShotRecord& record, bool overwriteExisting)
@@ -1476,98 +3341,9 @@ qint64 ShotHistoryStorage::importShotRecord(const ShotRecord& record, bool overw
         }
     }
 
-    // Begin transaction
-    m_db.transaction();
-
-    // Insert main shot record
-    query.prepare(R"(
-        INSERT INTO shots (
-            uuid, timestamp, profile_name, profile_json,
-            duration_seconds, final_weight, dose_weight,
-            bean_brand, bean_type, roast_date, roast_level,
-            grinder_model, grinder_setting,
-            drink_tds, drink_ey, enjoyment, espresso_notes, barista,
-            debug_log
-        ) VALUES (
-            :uuid, :timestamp, :profile_name, :profile_json,
-            :duration, :final_weight, :dose_weight,
-            :bean_brand, :bean_type, :roast_date, :roast_level,
-            :grinder_model, :grinder_setting,
-            :drink_tds, :drink_ey, :enjoyment, :espresso_notes, :barista,
-            :debug_log
-        )
-    )");
-
-    query.bindValue(":uuid", record.summary.uuid);
-    query.bindValue(":timestamp", record.summary.timestamp);
-    query.bindValue(":profile_name", record.summary.profileName);
-    query.bindValue(":profile_json", record.profileJson);
-    query.bindValue(":duration", record.summary.duration);
-    query.bindValue(":final_weight", record.summary.finalWeight);
-    query.bindValue(":dose_weight", record.summary.doseWeight);
-    query.bindValue(":bean_brand", record.summary.beanBrand);
-    query.bindValue(":bean_type", record.summary.beanType);
-    query.bindValue(":roast_date", record.roastDate);
-    query.bindValue(":roast_level", record.roastLevel);
-    query.bindValue(":grinder_model", record.grinderModel);
-    query.bindValue(":grinder_setting", record.grinderSetting);
-    query.bindValue(":drink_tds", record.drinkTds);
-    query.bindValue(":drink_ey", record.drinkEy);
-    query.bindValue(":enjoyment", record.summary.enjoyment);
-    query.bindValue(":espresso_notes", record.espressoNotes);
-    query.bindValue(":barista", record.barista);
-    query.bindValue(":debug_log", QString());  // No debug log for imported shots
-
-    if (!query.exec()) {
-        qWarning() << "ShotHistoryStorage: Failed to import shot:" << query.lastError().text();
-        m_db.rollback();
-        return -1;
-    }
-
-    qint64 shotId = query.lastInsertId().toLongLong();
-
-    // Compress and insert sample data
-    QJsonObject root;
-    root["pressure"] = pointsToJsonObject(record.pressure);
-    root["flow"] = pointsToJsonObject(record.flow);
-    root["temperature"] = pointsToJsonObject(record.temperature);
-    root["pressureGoal"] = pointsToJsonObject(record.pressureGoal);
-    root["flowGoal"] = pointsToJsonObject(record.flowGoal);
-    root["temperatureGoal"] = pointsToJsonObject(record.temperatureGoal);
-    root["weight"] = pointsToJsonObject(record.weight);
-
-    QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
-    QByteArray compressedData = qCompress(json, 9);
-    int sampleCount = record.pressure.size();
-
-    query.prepare("INSERT INTO shot_samples (shot_id, sample_count, data_blob) VALUES (:id, :count, :blob)");
-    query.bindValue(":id", shotId);
-    query.bindValue(":count", sampleCount);
-    query.bindValue(":blob", compressedData);
-
-    if (!query.exec()) {
-        qWarning() << "ShotHistoryStorage: Failed to insert imported samples:" << query.lastError().text();
-        m_db.rollback();
-        return -1;
-    }
-
-    // Insert phase markers
-    for (const auto& marker : record.phases) {
-        query.prepare(R"(
-            INSERT INTO shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode)
-            VALUES (:shot_id, :time, :label, :frame, :flow_mode)
-        )");
-        query.bindValue(":shot_id", shotId);
-        query.bindValue(":time", marker.time);
-        query.bindValue(":label", marker.label);
-        query.bindValue(":frame", marker.frameNumber);
-        query.bindValue(":flow_mode", marker.isFlowMode ? 1 : 0);
-        query.exec();  // Non-critical if markers fail
-    }
-
-    m_db.commit();
-
-    return shotId;
+    ShotRecord imported = record;
+    imported.debugLog.clear();  // No debug log for imported shots
+    return insertShotRecord(m_db, imported);
 }
 
 void ShotHistoryStorage::refreshTotalShots()
@@ -6,9 +6,21 @@
 #include <QVector>
 #include <QPointF>
 #include <QDateTime>
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QHash>
+#include <functional>
+#include <memory>
 
 class ShotDataModel;
 class Profile;
+class QThread;
+class QTimer;
+class QSqlQuery;
+class ShotStorageWorker;
+class ShotJournal;
+class ShotSimilarityIndex;
 struct ShotMetadata;
 
 // Lightweight shot summary for list display
@@ -58,6 +70,7 @@ struct ShotRecord {
     QVector<QPointF> flowGoal;
     QVector<QPointF> temperatureGoal;
     QVector<QPointF> weight;
+    QVector<QPointF> weightFlow;  // Scale flow rate (stored, not yet graphed)
 
     // Phase markers
     QList<HistoryPhaseMarker> phases;
@@ -83,6 +96,14 @@ struct ShotFilter {
     qint64 dateTo = 0;
     QString searchText;        // FTS search in notes
     bool onlyWithVisualizer = false;
+
+    // Ranges on shot_metrics, keyed by ShotMetrics key (from "minPeakPressure"/"maxPeakPressure" etc.)
+    QHash<QString, double> metricMin;
+    QHash<QString, double> metricMax;
+    QString sortBy;            // ShotMetrics key; empty = newest first
+    bool sortAscending = false;
+
+    bool usesMetrics() const { return !metricMin.isEmpty() || !metricMax.isEmpty() || !sortBy.isEmpty(); }
 };
 
 class ShotHistoryStorage : public QObject {
@@ -100,14 +121,19 @@ public:
     bool isReady() const { return m_ready; }
     int totalShots() const { return m_totalShots; }
 
-    // Save a completed shot
-    qint64 saveShot(ShotDataModel* shotData,
-                    const Profile* profile,
-                    double duration,
-                    double finalWeight,
-                    double doseWeight,
-                    const ShotMetadata& metadata,
-                    const QString& debugLog);
+    // Save a completed shot on the storage worker thread.
+    // The shot data is snapshotted immediately, so the model may be cleared right after.
+    // The future resolves on the GUI thread with the shot ID (-1 on error),
+    // after lastSavedShotId/totalShots are updated and shotSaved is emitted.
+    // Pass the journal's UUID so crash recovery can tell the shot was already saved.
+    QFuture<qint64> saveShotAsync(ShotDataModel* shotData,
+                                  const Profile* profile,
+                                  double duration,
+                                  double finalWeight,
+                                  double doseWeight,
+                                  const ShotMetadata& metadata,
+                                  const QString& debugLog,
+                                  const QString& uuid = QString());
 
     // Update visualizer info after upload
     Q_INVOKABLE bool updateVisualizerInfo(qint64 shotId,
@@ -118,12 +144,69 @@ public:
     Q_INVOKABLE QVariantList getShots(int offset = 0, int limit = 50);
     Q_INVOKABLE QVariantList getShotsFiltered(const QVariantMap& filter, int offset = 0, int limit = 50);
 
-    // Get full shot record (loads time-series data)
-    Q_INVOKABLE QVariantMap getShot(qint64 shotId);
+    // Keyset (cursor) pagination, newest first, keyed on (timestamp, id).
+    // Cost per page is independent of depth, and pages stay stable while shots
+    // are added. Pass an empty cursor for the first page, then the returned
+    // "nextCursor" (opaque string). Returns { shots, nextCursor, hasMore }.
+    // Metric sorting (filter.sortBy) is not keyset-able and is ignored here.
+    Q_INVOKABLE QVariantMap getShotsPage(const QVariantMap& filter, const QString& cursor = QString(),
+                                         int limit = 50);
+    // Same page as typed rows, for ShotHistoryListModel; nextCursor is empty on the last page.
+    // Safe off the GUI thread.
+    QList<HistoryShotSummary> getShotSummariesPage(const QVariantMap& filter, const QString& cursor, int limit,
+                                                   QString* nextCursor);
+    // One summary row, if the shot exists and still matches filter. Safe off the GUI thread.
+    bool getShotSummary(const QVariantMap& filter, qint64 shotId, HistoryShotSummary* summary);
+
+    // QML/JSON form of a summary row (the keys getShotsPage returns), dateTime included
+    static QVariantMap summaryToVariant(const HistoryShotSummary& summary);
+    static QString formatShotDateTime(qint64 timestamp);
+
+    // Substring search over every text field (notes, bean, profile, grinder, barista,
+    // roast level), best bm25 match first. Each shot summary carries "snippet" (the best
+    // matching fragment, hits wrapped in <b></b>) and "rank". filter takes the same keys
+    // as getShotsFiltered; paged like getShotsPage via the returned "nextCursor".
+    // Words shorter than 3 letters are matched as plain substrings and don't affect rank.
+    Q_INVOKABLE QVariantMap searchShots(const QString& text, const QVariantMap& filter = QVariantMap(),
+                                        const QString& cursor = QString(), int limit = 50);
+
+    // Get full shot record (loads time-series data). With includeSeries = false the curves
+    // are left out of the map - pages that chart them load a ShotSeries instead.
+    Q_INVOKABLE QVariantMap getShot(qint64 shotId, bool includeSeries = true);
     ShotRecord getShotRecord(qint64 shotId);
 
-    // Get multiple shots for comparison (efficient batch load)
-    QList<ShotRecord> getShotsForComparison(const QList<qint64>& shotIds);
+    // Shot curves with at most maxPoints points per channel (min/max preserving),
+    // read from the smallest stored LOD level that has enough detail.
+    // maxPoints <= 0 returns full resolution. Returns { level, pressure, flow, ... }
+    // with the same point format as getShot(); level is 0 when full data was read.
+    Q_INVOKABLE QVariantMap getShotSeries(qint64 shotId, int maxPoints);
+
+    // Precomputed analytics for a shot (peakPressure, timeToFirstDrop, ratio, ...)
+    Q_INVOKABLE QVariantMap getShotMetrics(qint64 shotId);
+
+    // Past shots whose pressure/flow/weight curves are closest to this one's,
+    // nearest first. filter takes the same keys as getShotsFiltered. Each entry is a
+    // shot summary plus "distance" (0 = identical curves).
+    // The fingerprint index loads off the GUI thread on first use; until then this returns
+    // an empty list and similarityIndexReady is emitted once a query can be answered.
+    Q_INVOKABLE QVariantList findSimilarShots(qint64 shotId, int k = 10,
+                                              const QVariantMap& filter = QVariantMap());
+
+    // Trend statistics computed in SQL, without loading individual shots.
+    // groupBy: "", "profile", "bean", "beanBrand", "beanType", "grinder", "grinderSetting",
+    //          "barista", "roastLevel"
+    // bucket:  "", "day", "week", "month", "year" (local-time ISO date of bucket start)
+    // metrics: "count" or "<avg|min|max|sum>:<value>", value one of duration, finalWeight,
+    //          doseWeight, ratio, enjoyment, drinkTds, drinkEy or a ShotMetrics key
+    // filter:  same keys as getShotsFiltered
+    // Returns columnar arrays { bucket?, group?, <metric>..., rowCount }, sorted by bucket/group.
+    Q_INVOKABLE QVariantMap aggregate(const QString& groupBy, const QString& bucket,
+                                      const QStringList& metrics, const QVariantMap& filter = QVariantMap());
+
+    // Get multiple shots for comparison in a few set-based queries, in shotIds order
+    // (without debug log and profile JSON). maxPoints > 0 reads the curves from the
+    // LOD pyramid like getShotSeries does. Safe off the GUI thread.
+    QList<ShotRecord> getShotsForComparison(const QList<qint64>& shotIds, int maxPoints = 0);
 
     // Delete shot
     Q_INVOKABLE bool deleteShot(qint64 shotId);
@@ -145,6 +228,12 @@ public:
     Q_INVOKABLE QStringList getDistinctBeanBrandsFiltered(const QVariantMap& filter);
     Q_INVOKABLE QStringList getDistinctBeanTypesFiltered(const QVariantMap& filter);
 
+    // All dropdown options with shot counts in one query, from the facet tables.
+    // Returns { profileName: [{value, count}], beanBrand: [...], beanType: [...],
+    // grinderModel, grinderSetting, barista, roastLevel }. Profile/bean brand/bean type
+    // options are narrowed by the other two selections in filter; the rest are global.
+    Q_INVOKABLE QVariantMap getFacets(const QVariantMap& filter = QVariantMap());
+
     // Get count of shots matching filter
     Q_INVOKABLE int getFilteredShotCount(const QVariantMap& filter);
 
@@ -155,12 +244,34 @@ public:
     // Export debug log for bug report
     Q_INVOKABLE QString exportShotData(qint64 shotId);
 
-    // Export database to Downloads folder (for debugging)
+    // Export database to Downloads folder (for debugging). Returns the destination path;
+    // the copy is written in the background and databaseExported is emitted when done.
     Q_INVOKABLE QString exportDatabase();
 
-    // Import database from file path (merge=true adds new entries, merge=false replaces all)
+    // Write a self-contained copy of the history to destPath (a consistent VACUUM INTO snapshot
+    // with archived samples folded back in). Safe off the GUI thread (use runRead).
+    // Returns an error message, empty on success.
+    QString snapshotDatabase(const QString& destPath);
+
+    // Import database from file path (merge=true adds new entries, merge=false replaces all).
+    // The file is ATTACHed and copied with set-based INSERT ... SELECT in batches of
+    // IMPORT_BATCH_SIZE source shots; importProgress is emitted after each batch. A merge
+    // commits per batch, a replace is one transaction (all or nothing).
     Q_INVOKABLE bool importDatabase(const QString& filePath, bool merge);
 
+    // Merge the shots database at srcPath into db (which must have the shot schema),
+    // the work behind importDatabase. No signals or bookkeeping - used directly by
+    // tools/import_bench.
+    struct ImportResult {
+        int sourceShots = 0;
+        int imported = 0;
+        int skipped = 0;
+        qint64 elapsedMs = 0;
+        QString errorMessage;  // Empty on success
+    };
+    static ImportResult mergeDatabaseFile(QSqlDatabase& db, const QString& srcPath, bool merge,
+                                          const std::function<void(int, int)>& progress = {});
+
     // Import a shot record directly (for .shot file import)
     // Returns: shot ID on success, 0 if duplicate (skipped), -1 on error
     // If overwriteExisting is true, duplicates will be replaced instead of skipped
@@ -175,25 +286,147 @@ public:
     // Get database path
     QString databasePath() const { return m_dbPath; }
 
+    // Run a read-only job on the history read pool and deliver its result through a future
+    // (use .then(context, ...) to get back to the GUI thread). The query methods
+    // (getShots*, getShot*, getFacets, getDistinct*, ...) are safe to call from the job -
+    // off the GUI thread they use a per-thread read-only connection, never the writer.
+    template <typename Job>
+    auto runRead(Job job) -> QFuture<decltype(job())>
+    {
+        using Result = decltype(job());
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+        m_readPool->start([promise, job = std::move(job)]() mutable {
+            promise->addResult(job());
+            promise->finish();
+        });
+        return future;
+    }
+
+    // Crash-safe journal for the shot in progress (lives next to shots.db)
+    ShotJournal* journal() const { return m_journal; }
+
     // Checkpoint WAL to main database file
     void checkpoint();
 
+    // Maintenance (ANALYZE/optimize, incremental vacuum, WAL truncate, quick_check) runs on
+    // the storage worker once the machine has slept MAINTENANCE_SLEEP_DELAY_MS, at most once
+    // per MAINTENANCE_INTERVAL_SECS, and stops between steps when the machine wakes.
+    void setMachineAsleep(bool asleep);
+    // Queue a pass now, skipping the delay and interval. Refused (returns false) unless
+    // the machine is asleep, so it can't hold up a shot's save.
+    Q_INVOKABLE bool runMaintenance();
+
+    // Page/freelist counts, file sizes (db, WAL, archive) and recent maintenance passes
+    // ("maintenance": newest first, each with per-step timings). Safe off the GUI thread.
+    Q_INVOKABLE QVariantMap databaseStats();
+
+    // Insert a complete shot (row, samples, phases) in one transaction on the given connection.
+    // Used by the GUI-thread paths and by the storage worker with its own connection.
+    // Returns the new shot ID, or -1 on error (errorMessage is set if provided).
+    static qint64 insertShotRecord(QSqlDatabase& db, const ShotRecord& record,
+                                   QString* errorMessage = nullptr);
+
+    // Compute and store the shot_metrics row for a shot (insert or replace)
+    static bool writeShotMetrics(QSqlDatabase& db, qint64 shotId, const ShotRecord& record);
+
+    // Build and store every shot_series_lod level for a shot (insert or replace)
+    static bool writeShotSeriesLod(QSqlDatabase& db, qint64 shotId, const ShotRecord& record);
+
+    // Compute and store the shot_fingerprints row for a shot (insert or replace)
+    static bool writeShotFingerprint(QSqlDatabase& db, qint64 shotId, const ShotRecord& record);
+
+    // Cold tier: sample blobs of old shots live in shots_archive.db next to the main
+    // file, keeping shots.db small to back up, checkpoint and load. attachArchive()
+    // attaches it as "archive" and creates the temp view shot_samples_all (hot rows
+    // plus archived ones) that sample readers use. Only the writer connections pass
+    // createSchema. Without an archive the view covers shot_samples alone.
+    static QString archivePath(const QString& dbPath);
+    static bool attachArchive(QSqlDatabase& db, const QString& dbPath, bool createSchema);
+
+    // A shot's samples move to the archive once it is older than ARCHIVE_AFTER_DAYS
+    // or no longer among the newest ARCHIVE_KEEP_RECENT_SHOTS shots
+    static constexpr int ARCHIVE_AFTER_DAYS = 365;
+    static constexpr int ARCHIVE_KEEP_RECENT_SHOTS = 1000;
+
+    // Sample blob encoding (thread-safe, no connection needed).
+    // New blobs use the columnar binary format; decode also reads legacy JSON blobs.
+    static QByteArray encodeSampleData(const ShotRecord& record);
+    static QByteArray encodeLegacySampleData(const ShotRecord& record);
+    static bool decodeSampleData(const QByteArray& blob, ShotRecord* record);
+
+    // shot_samples.encoding values
+    static constexpr int SAMPLE_ENCODING_LEGACY_JSON = 0;
+    static constexpr int SAMPLE_ENCODING_COLUMNAR = 1;
+    static constexpr int SAMPLE_ENCODING_UNREADABLE = -1;  // Skipped by the migration
+
+    static constexpr int EXPORT_BATCH_SIZE = 100;  // Shot IDs fetched per keyset step by streamShots
+    static constexpr int COMPARISON_BATCH_SIZE = 500;  // Shot IDs per IN (...) in getShotsForComparison
+
+    // Stream full shots (metadata, phases, decoded curves) matching filter to write(), oldest
+    // first, in format "ndjson" or "csv" (see ShotExportFormat). Shots are read by keyset
+    // and decoded one at a time, so memory stays bounded at any history size. Stops when
+    // write() returns false. Safe off the GUI thread (use runRead). Returns the number of
+    // shots written, or -1 on a bad format or query error.
+    qint64 streamShots(const QString& format, const QVariantMap& filter,
+                       const std::function<bool(const QByteArray&)>& write);
+
+    // streamShots() into a file in Downloads on the read pool. Returns the path right
+    // away; historyExported(path, shotCount) or errorOccurred follows.
+    Q_INVOKABLE QString exportHistory(const QString& format, const QVariantMap& filter = QVariantMap());
+
 signals:
     void readyChanged();
     void totalShotsChanged();
     void shotSaved(qint64 shotId);
     void shotDeleted(qint64 shotId);
+    void shotUpdated(qint64 shotId);  // Metadata edited
     void errorOccurred(const QString& message);
+    void importProgress(int processed, int total);
+    void databaseExported(const QString& path);
+    void historyExported(const QString& path, qint64 shotCount);
+    void maintenanceFinished(const QVariantMap& stats);
+    void similarityIndexReady();
+    // Emitted first thing in the destructor: readers running outside the read pool
+    // (ShotServer's export streams) must stop and return before it finishes
+    void closing();
 
 private:
+
     bool createTables();
     bool runMigrations();
-    QByteArray compressSampleData(ShotDataModel* shotData);
-    void decompressSampleData(const QByteArray& blob, ShotRecord* record);
+    void recoverJournals();
+    QSqlDatabase readConnection() const;
+    void startWorker();
+    void stopWorker();
+    void onShotPersisted(qint64 shotId);
+    void loadSimilarityIndex();        // Read fingerprints on the read pool, swap in on the GUI thread
+    void invalidateSimilarityIndex();  // Drop it (and any load in flight); the next query reloads
+    static ShotRecord buildShotRecord(ShotDataModel* shotData, const Profile* profile,
+                                      double duration, double finalWeight, double doseWeight,
+                                      const ShotMetadata& metadata, const QString& debugLog,
+                                      const QString& uuid);
     void updateTotalShots();
+    // Copy archived sample blobs into an exported database file. Returns an error message, empty on success
+    static QString unarchiveInto(const QString& exportPath, const QString& dbPath);
     QString buildFilterQuery(const ShotFilter& filter, QVariantList& bindValues);
+    QString buildOrderClause(const ShotFilter& filter);
+    QString buildFromClause(const ShotFilter& filter, const QString& extraCondition,
+                            const QVariantList& extraBindValues, QVariantList& bindValues,
+                            bool joinMetrics = false);
+    QVariantList queryShotSummaries(const ShotFilter& filter, const QString& extraCondition,
+                                    const QVariantList& extraBindValues, int offset, int limit);
+    QList<HistoryShotSummary> queryShotSummaryRecords(const ShotFilter& filter, const QString& extraCondition,
+                                                      const QVariantList& extraBindValues, int offset, int limit);
+    static HistoryShotSummary summaryFromQuery(const QSqlQuery& query);
+    static QString encodeShotCursor(qint64 timestamp, qint64 shotId);
+    static bool decodeShotCursor(const QString& cursor, qint64* timestamp, qint64* shotId);
     ShotFilter parseFilterMap(const QVariantMap& filterMap);
-    QString formatFtsQuery(const QString& userInput);
+    // FTS5 MATCH expression for the search text; words too short for the trigram
+    // index (every word when the index is unavailable) are left out and, if
+    // shortTerms is given, appended to it
+    QString formatFtsQuery(const QString& userInput, QStringList* shortTerms = nullptr);
 
     // Helper for getDistinct* methods - column is the DB column name
     QStringList getDistinctValues(const QString& column);
@@ -203,13 +436,37 @@ private:
 
     // Helper for converting QVector<QPointF> to JSON object with t/v arrays
     static QJsonObject pointsToJsonObject(const QVector<QPointF>& points);
+    // QVariantList of {x, y} maps, as handed to QML
+    static QVariantList pointsToVariantList(const QVector<QPointF>& points);
 
     QSqlDatabase m_db;
     QString m_dbPath;
     bool m_ready = false;
     int m_totalShots = 0;
     int m_schemaVersion = 1;
+    bool m_searchAvailable = true;  // shots_fts usable; otherwise every search term is a LIKE match
     qint64 m_lastSavedShotId = 0;
 
+    ShotJournal* m_journal = nullptr;
+    ShotSimilarityIndex* m_similarityIndex = nullptr;  // Loaded on first findSimilarShots()
+    bool m_similarityLoading = false;
+    bool m_similarityStale = false;  // Changed while loading - the loaded copy is out of date
+
+    // Storage worker thread - owns its own connection, processes jobs in FIFO order
+    QThread* m_workerThread = nullptr;
+    ShotStorageWorker* m_worker = nullptr;
+
+    // Read pool - worker threads each hold one read-only connection (the writer stays m_db)
+    QThreadPool* m_readPool = nullptr;
+
+    // Sleep-driven maintenance
+    QTimer* m_maintenanceTimer = nullptr;
+    qint64 m_lastMaintenance = 0;  // Unix time of the last pass started
+    bool m_machineAsleep = false;
+    static constexpr int MAINTENANCE_SLEEP_DELAY_MS = 5 * 60 * 1000;
+    static constexpr qint64 MAINTENANCE_INTERVAL_SECS = 24 * 60 * 60;
+
+    static constexpr int IMPORT_BATCH_SIZE = 500;
+    static constexpr int READ_POOL_SIZE = 2;
     static const QString DB_CONNECTION_NAME;
 };
@@ -0,0 +1,247 @@
+#include "shotjournal.h"
+#include "shothistorystorage.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QUuid>
+#include <QDebug>
+#include <cstring>
+
+ShotJournal::ShotJournal(const QString& directory)
+    : m_directory(directory)
+{
+    QDir().mkpath(m_directory);
+}
+
+ShotJournal::~ShotJournal()
+{
+    // Leave the file in place - a journal still open here belongs to an unfinished shot
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool ShotJournal::begin(const QString& profileName)
+{
+    discard();
+    m_uuid.clear();  // Never hand out the previous shot's UUID if opening fails
+
+    qint64 startedAt = QDateTime::currentSecsSinceEpoch();
+    m_file.setFileName(QString("%1/shot_%2.journal").arg(m_directory).arg(startedAt));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "ShotJournal: Failed to open" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    // Chosen now so recovery and the normal save agree on the shot's identity
+    const QUuid uuid = QUuid::createUuid();
+    m_uuid = uuid.toString(QUuid::WithoutBraces);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "DSJ1", 4);
+    header.version = JOURNAL_VERSION;
+    header.recordSize = sizeof(Record);
+    header.startedAt = startedAt;
+    std::memcpy(header.uuid, uuid.toRfc4122().constData(), sizeof(header.uuid));
+    copyLabel(header.profileName, sizeof(header.profileName), profileName);
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.flush();
+    return true;
+}
+
+void ShotJournal::appendSample(double time, double pressure, double flow, double temperature,
+                               double pressureGoal, double flowGoal, double temperatureGoal,
+                               int frameNumber, bool isFlowMode)
+{
+    if (!m_file.isOpen()) return;
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.type = Sample;
+    record.flags = isFlowMode ? 1 : 0;
+    record.frameNumber = static_cast<int16_t>(frameNumber);
+    record.time = static_cast<float>(time);
+    record.values[0] = static_cast<float>(pressure);
+    record.values[1] = static_cast<float>(flow);
+    record.values[2] = static_cast<float>(temperature);
+    record.values[3] = static_cast<float>(pressureGoal);
+    record.values[4] = static_cast<float>(flowGoal);
+    record.values[5] = static_cast<float>(temperatureGoal);
+    writeRecord(record);
+}
+
+void ShotJournal::appendWeight(double time, double weight)
+{
+    if (!m_file.isOpen()) return;
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.type = Weight;
+    record.time = static_cast<float>(time);
+    record.values[0] = static_cast<float>(weight);
+    writeRecord(record);
+}
+
+void ShotJournal::appendWeightReset()
+{
+    if (!m_file.isOpen()) return;
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.type = WeightReset;
+    writeRecord(record);
+}
+
+void ShotJournal::appendPhaseMarker(double time, const QString& label, int frameNumber, bool isFlowMode)
+{
+    if (!m_file.isOpen()) return;
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.type = PhaseMarker;
+    record.flags = isFlowMode ? 1 : 0;
+    record.frameNumber = static_cast<int16_t>(frameNumber);
+    record.time = static_cast<float>(time);
+    copyLabel(record.label, sizeof(record.label), label);
+    writeRecord(record);
+}
+
+void ShotJournal::appendExtractionStart(double time)
+{
+    if (!m_file.isOpen()) return;
+
+    Record record;
+    std::memset(&record, 0, sizeof(record));
+    record.type = ExtractionStart;
+    record.time = static_cast<float>(time);
+    writeRecord(record);
+}
+
+void ShotJournal::writeRecord(const Record& record)
+{
+    // Fixed-size append + flush to the OS: a crash can only tear the last record
+    m_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    m_file.flush();
+}
+
+QString ShotJournal::close()
+{
+    if (!m_file.isOpen()) return QString();
+
+    QString path = m_file.fileName();
+    m_file.close();
+    return path;
+}
+
+void ShotJournal::discard()
+{
+    QString path = close();
+    if (!path.isEmpty()) {
+        QFile::remove(path);
+    }
+}
+
+QStringList ShotJournal::pendingJournals() const
+{
+    QStringList paths;
+    QDir dir(m_directory);
+    const QStringList names = dir.entryList({"shot_*.journal"}, QDir::Files, QDir::Name);
+    for (const QString& name : names) {
+        QString path = dir.absoluteFilePath(name);
+        if (m_file.isOpen() && QFileInfo(m_file.fileName()).absoluteFilePath() == path) {
+            continue;  // Shot in progress
+        }
+        paths << path;
+    }
+    return paths;
+}
+
+bool ShotJournal::readJournal(const QString& path, ShotRecord* record)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ShotJournal: Failed to read" << path << file.errorString();
+        return false;
+    }
+
+    Header header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+        std::memcmp(header.magic, "DSJ1", 4) != 0 ||
+        header.recordSize != sizeof(Record) ||
+        header.version != JOURNAL_VERSION) {
+        qWarning() << "ShotJournal: Invalid journal header in" << path;
+        return false;
+    }
+
+    record->summary.timestamp = header.startedAt;
+    QByteArray uuidBytes(reinterpret_cast<const char*>(header.uuid), sizeof(header.uuid));
+    record->summary.uuid = QUuid::fromRfc4122(uuidBytes).toString(QUuid::WithoutBraces);
+    record->summary.profileName = QString::fromUtf8(header.profileName,
+                                                    qstrnlen(header.profileName, sizeof(header.profileName)));
+    if (record->summary.profileName.isEmpty()) {
+        record->summary.profileName = "Unknown";
+    }
+
+    bool extractionStarted = false;
+    Record entry;
+    // A torn trailing record (crash mid-write) is shorter than sizeof(Record) and is skipped
+    while (file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) == sizeof(entry)) {
+        double time = entry.time;
+        switch (entry.type) {
+        case Sample:
+            record->pressure.append(QPointF(time, entry.values[0]));
+            record->flow.append(QPointF(time, entry.values[1]));
+            record->temperature.append(QPointF(time, entry.values[2]));
+            if (entry.values[3] > 0) record->pressureGoal.append(QPointF(time, entry.values[3]));
+            if (entry.values[4] > 0) record->flowGoal.append(QPointF(time, entry.values[4]));
+            record->temperatureGoal.append(QPointF(time, entry.values[5]));
+            record->summary.duration = qMax(record->summary.duration, time);
+            break;
+        case Weight:
+            record->weight.append(QPointF(time, entry.values[0]));
+            record->summary.finalWeight = entry.values[0];
+            break;
+        case WeightReset:
+            record->weight.clear();
+            record->summary.finalWeight = 0;
+            break;
+        case PhaseMarker:
+        case ExtractionStart: {
+            HistoryPhaseMarker marker;
+            marker.time = time;
+            marker.frameNumber = entry.type == ExtractionStart ? 0 : entry.frameNumber;
+            marker.isFlowMode = (entry.flags & 1) != 0;
+            marker.label = entry.type == ExtractionStart
+                ? QStringLiteral("Start")
+                : QString::fromUtf8(entry.label, qstrnlen(entry.label, sizeof(entry.label)));
+            record->phases.append(marker);
+            extractionStarted = extractionStarted || entry.type == ExtractionStart;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    record->debugLog = QString("Recovered from shot journal %1 after an unexpected exit").arg(QFileInfo(path).fileName());
+    return extractionStarted;
+}
+
+bool ShotJournal::remove(const QString& path)
+{
+    return !path.isEmpty() && QFile::remove(path);
+}
+
+void ShotJournal::copyLabel(char* dest, int size, const QString& text)
+{
+    QByteArray utf8 = text.toUtf8();
+    int length = qMin(static_cast<int>(utf8.size()), size - 1);
+    // Don't cut a multi-byte UTF-8 sequence in half
+    while (length > 0 && length < utf8.size() && (static_cast<uint8_t>(utf8[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    std::memcpy(dest, utf8.constData(), length);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+struct ShotRecord;
+
+/**
+ * Append-only, crash-safe journal of the shot in progress.
+ *
+ * One file per shot: a 64-byte header followed by 64-byte records, written
+ * as samples arrive (~5 Hz), so persistence cost is constant per sample.
+ * Each record is flushed to the OS immediately, so an app crash mid-shot
+ * loses at most the record being written (a torn tail is ignored on read).
+ *
+ * Normal completion: the shot is saved to shots.db under the journal's UUID
+ * and the journal removed. After a crash: ShotHistoryStorage recovers leftover
+ * journals at startup, skipping those whose UUID is already in shots.db (the
+ * app went down between the save and the removal).
+ */
+class ShotJournal {
+public:
+    enum RecordType : uint8_t {
+        Sample = 1,
+        Weight = 2,
+        WeightReset = 3,      // Pre-tare weights discarded
+        PhaseMarker = 4,
+        ExtractionStart = 5
+    };
+
+    explicit ShotJournal(const QString& directory);
+    ~ShotJournal();
+
+    QString directory() const { return m_directory; }
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Start journaling a new shot (discards any journal still open)
+    bool begin(const QString& profileName);
+    // UUID the shot in progress (or last closed) must be saved under
+    QString uuid() const { return m_uuid; }
+
+    void appendSample(double time, double pressure, double flow, double temperature,
+                      double pressureGoal, double flowGoal, double temperatureGoal,
+                      int frameNumber, bool isFlowMode);
+    void appendWeight(double time, double weight);
+    void appendWeightReset();
+    void appendPhaseMarker(double time, const QString& label, int frameNumber, bool isFlowMode);
+    void appendExtractionStart(double time);
+
+    // Stop journaling and keep the file; returns its path (remove once the shot is saved)
+    QString close();
+    // Stop journaling and delete the file (shot not worth saving)
+    void discard();
+
+    // Journals left behind by a previous run
+    QStringList pendingJournals() const;
+
+    // Rebuild a shot from a journal file. Returns false if unreadable or
+    // if extraction never started (nothing worth saving).
+    static bool readJournal(const QString& path, ShotRecord* record);
+    static bool remove(const QString& path);
+
+private:
+#pragma pack(push, 1)
+    struct Header {
+        char magic[4];            // "DSJ1"
+        uint16_t version;
+        uint16_t recordSize;
+        int64_t startedAt;        // Unix timestamp (seconds)
+        uint8_t uuid[16];         // Shot UUID, RFC 4122 bytes
+        char profileName[32];     // UTF-8, NUL padded, may be truncated
+    };
+
+    struct Record {
+        uint8_t type;
+        uint8_t flags;            // Bit 0: flow mode
+        int16_t frameNumber;
+        float time;
+        float values[6];          // Sample: P, F, T, P goal, F goal, T goal. Weight: [0]
+        char label[32];           // Phase marker label, UTF-8, NUL padded
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(Header) == 64, "Journal header must be 64 bytes");
+    static_assert(sizeof(Record) == 64, "Journal record must be 64 bytes");
+
+    void writeRecord(const Record& record);
+    static void copyLabel(char* dest, int size, const QString& text);
+
+    QString m_directory;
+    QFile m_file;
+    QString m_uuid;
+
+    static constexpr uint16_t JOURNAL_VERSION = 1;
+};
@@ -0,0 +1,157 @@
+#include "shotmetrics.h"
+#include "shothistorystorage.h"
+
+#include <QVariant>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct MetricColumn {
+    const char* key;
+    const char* column;
+};
+
+const MetricColumn METRIC_COLUMNS[] = {
+    { "peakPressure",        "peak_pressure" },
+    { "peakFlow",            "peak_flow" },
+    { "timeToFirstDrop",     "time_to_first_drop" },
+    { "meanFlowPour",        "mean_flow_pour" },
+    { "meanPressurePour",    "mean_pressure_pour" },
+    { "meanTemperaturePour", "mean_temperature_pour" },
+    { "flowStddevPour",      "flow_stddev_pour" },
+    { "maxPressureDrop",     "max_pressure_drop" },
+    { "ratio",               "ratio" },
+};
+
+}  // namespace
+
+ShotMetrics ShotMetrics::compute(const ShotRecord& record)
+{
+    ShotMetrics metrics;
+
+    if (record.summary.doseWeight > 0 && record.summary.finalWeight > 0) {
+        metrics.ratio = record.summary.finalWeight / record.summary.doseWeight;
+    }
+
+    if (record.pressure.isEmpty()) {
+        return metrics;
+    }
+
+    // Extraction start marker, else the first sample
+    double extractionStart = record.pressure.first().x();
+    for (const auto& phase : record.phases) {
+        if (phase.label == QLatin1String("Start")) {
+            extractionStart = phase.time;
+            break;
+        }
+    }
+
+    // First drop: first weight reading past the threshold after extraction started
+    double pourStart = extractionStart;
+    for (const auto& pt : record.weight) {
+        if (pt.x() >= extractionStart && pt.y() >= FIRST_DROP_WEIGHT) {
+            metrics.timeToFirstDrop = pt.x() - extractionStart;
+            pourStart = pt.x();
+            break;
+        }
+    }
+
+    double peakPressure = 0;
+    for (const auto& pt : record.pressure) {
+        peakPressure = std::max(peakPressure, pt.y());
+    }
+    metrics.peakPressure = peakPressure;
+
+    double peakFlow = 0;
+    for (const auto& pt : record.flow) {
+        peakFlow = std::max(peakFlow, pt.y());
+    }
+    metrics.peakFlow = peakFlow;
+
+    // Pour-window means (pressure/flow/temperature share the DE1 sample clock)
+    double sumFlow = 0, sumFlowSq = 0, sumPressure = 0, sumTemperature = 0;
+    int pourSamples = 0;
+    int count = static_cast<int>(std::min({record.pressure.size(), record.flow.size(),
+                                           record.temperature.size()}));
+    for (int i = 0; i < count; ++i) {
+        if (record.pressure[i].x() < pourStart) continue;
+        double flow = record.flow[i].y();
+        sumFlow += flow;
+        sumFlowSq += flow * flow;
+        sumPressure += record.pressure[i].y();
+        sumTemperature += record.temperature[i].y();
+        pourSamples++;
+    }
+    if (pourSamples > 0) {
+        metrics.meanFlowPour = sumFlow / pourSamples;
+        metrics.meanPressurePour = sumPressure / pourSamples;
+        metrics.meanTemperaturePour = sumTemperature / pourSamples;
+        double variance = sumFlowSq / pourSamples - metrics.meanFlowPour * metrics.meanFlowPour;
+        metrics.flowStddevPour = std::sqrt(std::max(0.0, variance));
+    }
+
+    // Largest pressure fall within a short window during the pour - a puck that
+    // channels loses resistance suddenly. Window start advances monotonically.
+    double maxDrop = 0;
+    int windowStart = 0;
+    for (int i = 0; i < record.pressure.size(); ++i) {
+        const QPointF& pt = record.pressure[i];
+        if (pt.x() < pourStart) {
+            windowStart = i + 1;
+            continue;
+        }
+        while (record.pressure[windowStart].x() < pt.x() - PRESSURE_DROP_WINDOW) {
+            windowStart++;
+        }
+        for (int j = windowStart; j < i; ++j) {
+            maxDrop = std::max(maxDrop, record.pressure[j].y() - pt.y());
+        }
+    }
+    metrics.maxPressureDrop = maxDrop;
+
+    return metrics;
+}
+
+QVariantList ShotMetrics::values() const
+{
+    auto value = [](double v) { return std::isnan(v) ? QVariant() : QVariant(v); };
+    return {
+        value(peakPressure), value(peakFlow), value(timeToFirstDrop),
+        value(meanFlowPour), value(meanPressurePour), value(meanTemperaturePour),
+        value(flowStddevPour), value(maxPressureDrop), value(ratio)
+    };
+}
+
+const QStringList& ShotMetrics::columnNames()
+{
+    static const QStringList columns = [] {
+        QStringList list;
+        for (const auto& entry : METRIC_COLUMNS) list << QString::fromLatin1(entry.column);
+        return list;
+    }();
+    return columns;
+}
+
+const QStringList& ShotMetrics::keyNames()
+{
+    static const QStringList keys = [] {
+        QStringList list;
+        for (const auto& entry : METRIC_COLUMNS) list << QString::fromLatin1(entry.key);
+        return list;
+    }();
+    return keys;
+}
+
+QString ShotMetrics::columnForKey(const QString& key)
+{
+    static const QHash<QString, QString> lookup = [] {
+        QHash<QString, QString> map;
+        for (const auto& entry : METRIC_COLUMNS) {
+            map.insert(QString::fromLatin1(entry.key), QString::fromLatin1(entry.column));
+        }
+        return map;
+    }();
+    return lookup.value(key);
+}
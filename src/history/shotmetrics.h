@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QtNumeric>
+
+struct ShotRecord;
+
+// Per-shot analytics derived from the time series, stored in shot_metrics
+// so history queries can filter/sort without decoding sample blobs.
+// NaN means "not available" (e.g. no scale data) and is stored as NULL.
+struct ShotMetrics {
+    double peakPressure = qQNaN();      // bar
+    double peakFlow = qQNaN();          // ml/s
+    double timeToFirstDrop = qQNaN();   // s from extraction start until weight >= FIRST_DROP_WEIGHT
+    double meanFlowPour = qQNaN();      // ml/s, from first drop to end
+    double meanPressurePour = qQNaN();  // bar, from first drop to end
+    double meanTemperaturePour = qQNaN();
+    double flowStddevPour = qQNaN();    // Channeling indicator: erratic puck flow
+    double maxPressureDrop = qQNaN();   // Channeling indicator: largest fall within 1 s during pour
+    double ratio = qQNaN();             // final weight / dose
+
+    static ShotMetrics compute(const ShotRecord& record);
+
+    // QVariant (or null) per column, in the order of columnNames()
+    QVariantList values() const;
+
+    // shot_metrics column names (excluding shot_id) and matching camelCase keys, same order
+    static const QStringList& columnNames();
+    static const QStringList& keyNames();
+
+    // QML/filter key -> column, e.g. "peakPressure" -> "peak_pressure"
+    static QString columnForKey(const QString& key);
+
+    static constexpr double FIRST_DROP_WEIGHT = 0.5;     // g
+    static constexpr double PRESSURE_DROP_WINDOW = 1.0;  // s
+};
@@ -0,0 +1,286 @@
+#include "shotsamplecodec.h"
+#include "shothistorystorage.h"
+
+#include <QDebug>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const char MAGIC[3] = { 'D', 'S', 'C' };
+
+void writeVarint(QByteArray& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Delta + zigzag + varint encode a fixed-point column
+QByteArray encodeColumn(const QVector<int64_t>& column)
+{
+    QByteArray out;
+    out.reserve(column.size() * 2);
+    int64_t previous = 0;
+    for (int64_t value : column) {
+        writeVarint(out, zigzag(value - previous));
+        previous = value;
+    }
+    return out;
+}
+
+struct Reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool readVarint(uint64_t* value)
+    {
+        uint64_t result = 0;
+        int shift = 0;
+        while (pos < end && shift < 64) {
+            uint8_t byte = *pos++;
+            result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                *value = result;
+                return true;
+            }
+            shift += 7;
+        }
+        ok = false;
+        return false;
+    }
+
+    bool readByte(uint8_t* value)
+    {
+        if (pos >= end) { ok = false; return false; }
+        *value = *pos++;
+        return true;
+    }
+
+    bool skip(uint64_t bytes)
+    {
+        if (bytes > static_cast<uint64_t>(end - pos)) { ok = false; return false; }
+        pos += bytes;
+        return true;
+    }
+};
+
+struct Section {
+    uint64_t count = 0;
+    const uint8_t* data = nullptr;
+    uint64_t length = 0;
+};
+
+bool readSection(Reader& reader, Section* section)
+{
+    if (!reader.readVarint(&section->count)) return false;
+    if (!reader.readVarint(&section->length)) return false;
+    section->data = reader.pos;
+    return reader.skip(section->length);
+}
+
+// Decode a delta column into 'out' scaled back to double. Returns false on truncation.
+bool decodeColumn(const Section& section, double scale, QVector<double>* out)
+{
+    // Every value takes at least one byte; reject corrupt counts before allocating
+    if (section.count > section.length ||
+        section.count > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+
+    Reader reader{ section.data, section.data + section.length };
+    out->resize(static_cast<int>(section.count));
+    double* dst = out->data();
+    int64_t value = 0;
+    for (uint64_t i = 0; i < section.count; ++i) {
+        uint64_t raw;
+        if (!reader.readVarint(&raw)) return false;
+        value += unzigzag(raw);
+        dst[i] = static_cast<double>(value) / scale;
+    }
+    return true;
+}
+
+struct ParsedBlob {
+    QVector<Section> axes;
+    struct ChannelEntry {
+        uint8_t id = 0;
+        uint8_t axis = 0;
+        Section values;
+    };
+    QVector<ChannelEntry> channels;
+};
+
+bool parseBlob(const QByteArray& blob, ParsedBlob* parsed)
+{
+    if (!ShotSampleCodec::isBinaryBlob(blob)) return false;
+
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(blob.constData());
+    Reader reader{ begin + 4, begin + blob.size() };
+
+    uint64_t axisCount;
+    if (!reader.readVarint(&axisCount)) return false;
+    for (uint64_t i = 0; i < axisCount; ++i) {
+        Section axis;
+        if (!readSection(reader, &axis)) return false;
+        parsed->axes.append(axis);
+    }
+
+    uint64_t channelCount;
+    if (!reader.readVarint(&channelCount)) return false;
+    for (uint64_t i = 0; i < channelCount; ++i) {
+        ParsedBlob::ChannelEntry entry;
+        if (!reader.readByte(&entry.id) || !reader.readByte(&entry.axis)) return false;
+        if (!readSection(reader, &entry.values)) return false;
+        if (entry.axis >= parsed->axes.size()) return false;
+        if (entry.values.count != parsed->axes[entry.axis].count) return false;
+        parsed->channels.append(entry);
+    }
+    return reader.ok;
+}
+
+QVector<QPointF> buildPoints(const ParsedBlob& parsed, const ParsedBlob::ChannelEntry& entry)
+{
+    QVector<double> times, values;
+    if (!decodeColumn(parsed.axes[entry.axis], ShotSampleCodec::TIME_SCALE, &times) ||
+        !decodeColumn(entry.values, ShotSampleCodec::VALUE_SCALE, &values)) {
+        qWarning() << "ShotSampleCodec: Truncated channel" << entry.id;
+        return QVector<QPointF>();
+    }
+
+    QVector<QPointF> points(times.size());
+    QPointF* dst = points.data();
+    for (int i = 0; i < times.size(); ++i) {
+        dst[i] = QPointF(times[i], values[i]);
+    }
+    return points;
+}
+
+}  // namespace
+
+bool ShotSampleCodec::isBinaryBlob(const QByteArray& blob)
+{
+    return blob.size() >= 4 &&
+           blob[0] == MAGIC[0] && blob[1] == MAGIC[1] && blob[2] == MAGIC[2] &&
+           static_cast<uint8_t>(blob[3]) == FORMAT_VERSION;
+}
+
+QByteArray ShotSampleCodec::formatHeader()
+{
+    QByteArray header(MAGIC, 3);
+    header.append(static_cast<char>(FORMAT_VERSION));
+    return header;
+}
+
+QByteArray ShotSampleCodec::encode(const ShotRecord& record)
+{
+    // Quantize every time column to ms; channels with identical columns share one axis.
+    // Axis 0 is the DE1 sample clock (pressure/flow/temperature/temperature goal).
+    QVector<QVector<int64_t>> axes;
+    QVector<uint8_t> channelAxis(ChannelCount, 0);
+
+    for (int c = 0; c < ChannelCount; ++c) {
+        const QVector<QPointF>& points = series(record, static_cast<Channel>(c));
+        QVector<int64_t> times(points.size());
+        for (int i = 0; i < points.size(); ++i) {
+            times[i] = std::llround(points[i].x() * TIME_SCALE);
+        }
+
+        int axisIndex = axes.indexOf(times);
+        if (axisIndex < 0) {
+            axisIndex = axes.size();
+            axes.append(times);
+        }
+        channelAxis[c] = static_cast<uint8_t>(axisIndex);
+    }
+
+    QByteArray out = formatHeader();
+
+    writeVarint(out, axes.size());
+    for (const auto& axis : axes) {
+        QByteArray encoded = encodeColumn(axis);
+        writeVarint(out, axis.size());
+        writeVarint(out, encoded.size());
+        out.append(encoded);
+    }
+
+    writeVarint(out, ChannelCount);
+    for (int c = 0; c < ChannelCount; ++c) {
+        const QVector<QPointF>& points = series(record, static_cast<Channel>(c));
+        QVector<int64_t> values(points.size());
+        for (int i = 0; i < points.size(); ++i) {
+            values[i] = std::llround(points[i].y() * VALUE_SCALE);
+        }
+        QByteArray encoded = encodeColumn(values);
+        out.append(static_cast<char>(c));
+        out.append(static_cast<char>(channelAxis[c]));
+        writeVarint(out, values.size());
+        writeVarint(out, encoded.size());
+        out.append(encoded);
+    }
+
+    return out;
+}
+
+bool ShotSampleCodec::decode(const QByteArray& blob, ShotRecord* record)
+{
+    ParsedBlob parsed;
+    if (!parseBlob(blob, &parsed)) {
+        qWarning() << "ShotSampleCodec: Malformed sample blob";
+        return false;
+    }
+
+    for (const auto& entry : parsed.channels) {
+        if (entry.id >= ChannelCount) continue;  // Unknown channel from a newer writer
+        *series(record, static_cast<Channel>(entry.id)) = buildPoints(parsed, entry);
+    }
+    return true;
+}
+
+QVector<QPointF> ShotSampleCodec::decodeChannel(const QByteArray& blob, Channel channel)
+{
+    ParsedBlob parsed;
+    if (!parseBlob(blob, &parsed)) return QVector<QPointF>();
+
+    for (const auto& entry : parsed.channels) {
+        if (entry.id == channel) {
+            return buildPoints(parsed, entry);
+        }
+    }
+    return QVector<QPointF>();
+}
+
+const QVector<QPointF>& ShotSampleCodec::series(const ShotRecord& record, Channel channel)
+{
+    return *series(const_cast<ShotRecord*>(&record), channel);
+}
+
+QVector<QPointF>* ShotSampleCodec::series(ShotRecord* record, Channel channel)
+{
+    switch (channel) {
+    case Pressure:        return &record->pressure;
+    case Flow:            return &record->flow;
+    case Temperature:     return &record->temperature;
+    case PressureGoal:    return &record->pressureGoal;
+    case FlowGoal:        return &record->flowGoal;
+    case TemperatureGoal: return &record->temperatureGoal;
+    case Weight:          return &record->weight;
+    case WeightFlow:      return &record->weightFlow;
+    case ChannelCount:    break;
+    }
+    Q_UNREACHABLE();
+    return &record->pressure;
+}
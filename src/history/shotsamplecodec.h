@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <QByteArray>
+#include <QVector>
+#include <QPointF>
+
+struct ShotRecord;
+
+/**
+ * Columnar binary encoding for shot_samples.data_blob.
+ *
+ * Layout (all integers are LEB128 varints unless noted):
+ *   magic "DSC" + version byte          (4 bytes, raw)
+ *   axisCount, then per axis:           count, byteLength, zigzag deltas of time in ms
+ *   channelCount, then per channel:     id (raw byte), axis index (raw byte),
+ *                                       count, byteLength, zigzag deltas of value * VALUE_SCALE
+ *
+ * Channels whose timestamps match the shared DE1 sample clock reference axis 0,
+ * so the time column is stored once. Goal and scale channels carry their own axis.
+ * Every section is length-prefixed, so a single channel can be decoded without
+ * touching the others.
+ *
+ * Legacy blobs (qCompress'd JSON) never start with the magic bytes:
+ * qCompress prefixes the uncompressed length, which would be ~1 GB.
+ */
+class ShotSampleCodec {
+public:
+    enum Channel : uint8_t {
+        Pressure = 0,
+        Flow,
+        Temperature,
+        PressureGoal,
+        FlowGoal,
+        TemperatureGoal,
+        Weight,
+        WeightFlow,
+        ChannelCount
+    };
+
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr double TIME_SCALE = 1000.0;   // Milliseconds
+    static constexpr double VALUE_SCALE = 1000.0;  // 0.001 bar / ml/s / g / C
+
+    static bool isBinaryBlob(const QByteArray& blob);
+
+    // The 4 bytes every binary blob starts with (lets SQL tell formats apart via substr())
+    static QByteArray formatHeader();
+
+    static QByteArray encode(const ShotRecord& record);
+
+    // Decode all channels into record. Returns false on a malformed blob.
+    static bool decode(const QByteArray& blob, ShotRecord* record);
+
+    // Decode one channel only (skips every other section)
+    static QVector<QPointF> decodeChannel(const QByteArray& blob, Channel channel);
+
+    // Map channel id to the matching ShotRecord series
+    static const QVector<QPointF>& series(const ShotRecord& record, Channel channel);
+    static QVector<QPointF>* series(ShotRecord* record, Channel channel);
+};
@@ -0,0 +1,54 @@
+#include "shotserieslod.h"
+#include "shotsamplecodec.h"
+#include "shothistorystorage.h"
+
+int ShotSeriesLod::levelFor(int maxPoints)
+{
+    if (maxPoints <= 0) return 0;
+    for (int level : LEVELS) {
+        if (level >= maxPoints) return level;
+    }
+    return 0;
+}
+
+QVector<QPointF> ShotSeriesLod::downsample(const QVector<QPointF>& points, int maxPoints)
+{
+    if (maxPoints <= 0 || points.size() <= maxPoints) {
+        return points;
+    }
+    if (maxPoints < 2) {
+        return { points.first() };
+    }
+
+    // Equal-count buckets; each contributes its min and max in time order
+    const qsizetype count = points.size();
+    const qsizetype buckets = maxPoints / 2;
+    QVector<QPointF> out;
+    out.reserve(buckets * 2);
+
+    for (qsizetype b = 0; b < buckets; ++b) {
+        qsizetype begin = count * b / buckets;
+        qsizetype end = count * (b + 1) / buckets;
+        qsizetype minIndex = begin;
+        qsizetype maxIndex = begin;
+        for (qsizetype i = begin + 1; i < end; ++i) {
+            if (points[i].y() < points[minIndex].y()) minIndex = i;
+            if (points[i].y() > points[maxIndex].y()) maxIndex = i;
+        }
+        out.append(points[qMin(minIndex, maxIndex)]);
+        if (minIndex != maxIndex) {
+            out.append(points[qMax(minIndex, maxIndex)]);
+        }
+    }
+    return out;
+}
+
+ShotRecord ShotSeriesLod::buildLevel(const ShotRecord& record, int maxPoints)
+{
+    ShotRecord level;
+    for (int c = 0; c < ShotSampleCodec::ChannelCount; ++c) {
+        auto channel = static_cast<ShotSampleCodec::Channel>(c);
+        *ShotSampleCodec::series(&level, channel) = downsample(ShotSampleCodec::series(record, channel), maxPoints);
+    }
+    return level;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QVector>
+#include <QPointF>
+
+struct ShotRecord;
+
+/**
+ * Level-of-detail pyramid for stored shot curves (shot_series_lod).
+ *
+ * Each level keeps every channel at no more than LEVELS[i] points, chosen by
+ * min/max per bucket so peaks and dips survive (a plain stride would drop a
+ * pressure spike between two kept samples). Levels are encoded with
+ * ShotSampleCodec, so a 64-point level is a few hundred bytes.
+ */
+class ShotSeriesLod {
+public:
+    // Stored levels, coarsest first
+    static constexpr int LEVELS[] = { 64, 256 };
+
+    // Smallest stored level with at least maxPoints points, or 0 if only
+    // full resolution satisfies the request (maxPoints <= 0 means "full")
+    static int levelFor(int maxPoints);
+
+    // Min/max-preserving downsample to at most maxPoints points
+    static QVector<QPointF> downsample(const QVector<QPointF>& points, int maxPoints);
+
+    // Copy of the record's time series, each downsampled to maxPoints
+    static ShotRecord buildLevel(const ShotRecord& record, int maxPoints);
+};
@@ -0,0 +1,219 @@
+#include "shotsimilarity.h"
+#include "shothistorystorage.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Linear interpolation at evenly spaced times from start. Before the first
+// point the first value is used; past the end, the last value if hold is set
+// (cumulative weight stays put), else 0 (pump stopped).
+void resample(const QVector<QPointF>& points, double start, double scale, bool hold, float* out)
+{
+    const int count = ShotFingerprint::SAMPLES_PER_CHANNEL;
+    if (points.isEmpty()) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+
+    const double step = ShotFingerprint::WINDOW_SECONDS / (count - 1);
+    int j = 0;
+    for (int i = 0; i < count; ++i) {
+        double t = start + i * step;
+        while (j < points.size() && points[j].x() < t) {
+            ++j;
+        }
+
+        double value;
+        if (j == 0) {
+            value = points.first().y();
+        } else if (j == points.size()) {
+            value = hold ? points.last().y() : 0.0;
+        } else {
+            const QPointF& a = points[j - 1];
+            const QPointF& b = points[j];
+            double span = b.x() - a.x();
+            double f = span > 0 ? (t - a.x()) / span : 0.0;
+            value = a.y() + f * (b.y() - a.y());
+        }
+        out[i] = static_cast<float>(value / scale);
+    }
+}
+
+}  // namespace
+
+QVector<float> ShotFingerprint::compute(const ShotRecord& record)
+{
+    QVector<float> fingerprint(DIMENSIONS, 0.0f);
+    if (record.pressure.isEmpty()) {
+        return fingerprint;
+    }
+
+    // Align on the extraction start marker so preinfusion timing lines up
+    double start = record.pressure.first().x();
+    for (const auto& phase : record.phases) {
+        if (phase.label == QLatin1String("Start")) {
+            start = phase.time;
+            break;
+        }
+    }
+
+    float* out = fingerprint.data();
+    resample(record.pressure, start, PRESSURE_SCALE, false, out);
+    resample(record.flow, start, FLOW_SCALE, false, out + SAMPLES_PER_CHANNEL);
+    resample(record.weight, start, WEIGHT_SCALE, true, out + 2 * SAMPLES_PER_CHANNEL);
+    return fingerprint;
+}
+
+QByteArray ShotFingerprint::toBlob(const QVector<float>& fingerprint)
+{
+    return QByteArray(reinterpret_cast<const char*>(fingerprint.constData()),
+                      fingerprint.size() * static_cast<qsizetype>(sizeof(float)));
+}
+
+QVector<float> ShotFingerprint::fromBlob(const QByteArray& blob)
+{
+    if (blob.size() != DIMENSIONS * static_cast<qsizetype>(sizeof(float))) {
+        return QVector<float>();
+    }
+    QVector<float> fingerprint(DIMENSIONS);
+    std::memcpy(fingerprint.data(), blob.constData(), blob.size());
+    return fingerprint;
+}
+
+bool ShotSimilarityIndex::load(QSqlDatabase& db)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_ids.clear();
+    m_vectors.clear();
+    m_rowForId.clear();
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT shot_id, vector FROM shot_fingerprints WHERE version = ?");
+    query.addBindValue(ShotFingerprint::VERSION);
+    if (!query.exec()) {
+        qWarning() << "ShotSimilarityIndex: Failed to load fingerprints:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        QVector<float> fingerprint = ShotFingerprint::fromBlob(query.value(1).toByteArray());
+        if (fingerprint.isEmpty()) continue;
+        m_rowForId.insert(query.value(0).toLongLong(), static_cast<int>(m_ids.size()));
+        m_ids.append(query.value(0).toLongLong());
+        m_vectors.append(fingerprint);
+    }
+
+    m_loaded = true;
+    qDebug() << "ShotSimilarityIndex: Loaded" << m_ids.size() << "fingerprints in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void ShotSimilarityIndex::invalidate()
+{
+    m_loaded = false;
+    m_ids.clear();
+    m_ids.squeeze();
+    m_vectors.clear();
+    m_vectors.squeeze();
+    m_rowForId.clear();
+}
+
+void ShotSimilarityIndex::insert(qint64 shotId, const QVector<float>& fingerprint)
+{
+    if (!m_loaded || fingerprint.size() != ShotFingerprint::DIMENSIONS) return;
+
+    auto it = m_rowForId.constFind(shotId);
+    if (it != m_rowForId.constEnd()) {
+        std::copy(fingerprint.cbegin(), fingerprint.cend(),
+                  m_vectors.begin() + qsizetype(*it) * ShotFingerprint::DIMENSIONS);
+        return;
+    }
+    m_rowForId.insert(shotId, static_cast<int>(m_ids.size()));
+    m_ids.append(shotId);
+    m_vectors.append(fingerprint);
+}
+
+void ShotSimilarityIndex::remove(qint64 shotId)
+{
+    if (!m_loaded) return;
+
+    auto it = m_rowForId.find(shotId);
+    if (it == m_rowForId.end()) return;
+
+    // Swap the last row into the hole
+    const int row = *it;
+    const int last = static_cast<int>(m_ids.size()) - 1;
+    const qsizetype dims = ShotFingerprint::DIMENSIONS;
+    m_rowForId.erase(it);
+    if (row != last) {
+        m_ids[row] = m_ids[last];
+        std::copy(m_vectors.cbegin() + last * dims, m_vectors.cbegin() + (last + 1) * dims,
+                  m_vectors.begin() + row * dims);
+        m_rowForId[m_ids[row]] = row;
+    }
+    m_ids.removeLast();
+    m_vectors.resize(last * dims);
+}
+
+QVector<float> ShotSimilarityIndex::fingerprint(qint64 shotId) const
+{
+    auto it = m_rowForId.constFind(shotId);
+    if (it == m_rowForId.constEnd()) return QVector<float>();
+
+    const qsizetype offset = qsizetype(*it) * ShotFingerprint::DIMENSIONS;
+    return m_vectors.mid(offset, ShotFingerprint::DIMENSIONS);
+}
+
+QList<QPair<qint64, float>> ShotSimilarityIndex::nearest(const QVector<float>& query, int k,
+                                                         qint64 excludeId, const QSet<qint64>* allowed) const
+{
+    QList<QPair<qint64, float>> results;
+    if (k <= 0 || query.size() != ShotFingerprint::DIMENSIONS) return results;
+
+    // Max-heap of the k best (squared distance, row) - the root is the one to beat
+    using Candidate = std::pair<float, int>;
+    std::vector<Candidate> heap;
+    heap.reserve(k + 1);
+
+    const int dims = ShotFingerprint::DIMENSIONS;
+    const float* q = query.constData();
+    const float* row = m_vectors.constData();
+    for (int i = 0; i < m_ids.size(); ++i, row += dims) {
+        qint64 id = m_ids[i];
+        if (id == excludeId || (allowed && !allowed->contains(id))) continue;
+
+        float bound = heap.size() == size_t(k) ? heap.front().first : std::numeric_limits<float>::max();
+        float distance = 0.0f;
+        for (int d = 0; d < dims && distance < bound; ++d) {
+            float diff = row[d] - q[d];
+            distance += diff * diff;
+        }
+        if (distance >= bound) continue;
+
+        heap.emplace_back(distance, i);
+        std::push_heap(heap.begin(), heap.end());
+        if (heap.size() > size_t(k)) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    for (const auto& candidate : heap) {
+        results.append({m_ids[candidate.second], std::sqrt(candidate.first)});
+    }
+    return results;
+}
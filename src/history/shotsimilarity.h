@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+
+class QSqlDatabase;
+struct ShotRecord;
+
+/**
+ * Fixed-length curve fingerprint for "find shots like this one".
+ *
+ * Pressure, flow and weight are resampled at SAMPLES_PER_CHANNEL points over
+ * the first WINDOW_SECONDS after extraction start, scaled by fixed physical
+ * ranges (not per shot, so a 6 bar shot doesn't look like a 9 bar one) and
+ * concatenated. Euclidean distance between fingerprints compares curve shape
+ * and timing. Stored as raw float32 in shot_fingerprints.
+ */
+class ShotFingerprint {
+public:
+    static constexpr int VERSION = 1;  // Bump when the layout/scales change; rows are recomputed
+    static constexpr int SAMPLES_PER_CHANNEL = 24;
+    static constexpr int CHANNELS = 3;
+    static constexpr int DIMENSIONS = SAMPLES_PER_CHANNEL * CHANNELS;
+    static constexpr double WINDOW_SECONDS = 60.0;
+
+    static constexpr double PRESSURE_SCALE = 12.0;  // bar
+    static constexpr double FLOW_SCALE = 8.0;       // ml/s
+    static constexpr double WEIGHT_SCALE = 60.0;    // g
+
+    static QVector<float> compute(const ShotRecord& record);
+
+    static QByteArray toBlob(const QVector<float>& fingerprint);
+    static QVector<float> fromBlob(const QByteArray& blob);  // Empty if the size doesn't match
+};
+
+/**
+ * In-memory nearest-neighbour index over every stored fingerprint.
+ *
+ * Fingerprints are packed into one contiguous float array and scanned
+ * exhaustively with a bounded max-heap: 50k shots x 72 dims is ~14 MB and a
+ * few million multiply-adds per query, which is exact and faster than the
+ * bookkeeping of a tree/graph index at this size. Loaded lazily on first query.
+ */
+class ShotSimilarityIndex {
+public:
+    bool isLoaded() const { return m_loaded; }
+    int size() const { return static_cast<int>(m_ids.size()); }
+
+    bool load(QSqlDatabase& db);
+    void invalidate();
+
+    // Keep a loaded index current without a reload (no-op while unloaded)
+    void insert(qint64 shotId, const QVector<float>& fingerprint);
+    void remove(qint64 shotId);
+
+    // Stored fingerprint of a shot, empty if not indexed
+    QVector<float> fingerprint(qint64 shotId) const;
+
+    // k closest shots as (shot ID, distance), nearest first. Skips excludeId;
+    // when allowed is non-null only those IDs are considered.
+    QList<QPair<qint64, float>> nearest(const QVector<float>& query, int k,
+                                        qint64 excludeId, const QSet<qint64>* allowed = nullptr) const;
+
+private:
+    bool m_loaded = false;
+    QVector<qint64> m_ids;
+    QVector<float> m_vectors;        // m_ids.size() * DIMENSIONS, row-major
+    QHash<qint64, int> m_rowForId;
+};
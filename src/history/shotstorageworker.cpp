@@ -0,0 +1,551 @@
+#include "shotstorageworker.h"
+#include "shothistorystorage.h"
+#include "shotsimilarity.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <functional>
+#include <limits>
+
+const QString ShotStorageWorker::DB_CONNECTION_NAME = "ShotHistoryWorkerConnection";
+
+ShotStorageWorker::ShotStorageWorker(const QString& dbPath, QObject* parent)
+    : QObject(parent)
+    , m_dbPath(dbPath)
+{
+}
+
+ShotStorageWorker::~ShotStorageWorker()
+{
+    close();
+}
+
+bool ShotStorageWorker::open()
+{
+    if (m_db.isOpen()) return true;
+
+    if (QSqlDatabase::contains(DB_CONNECTION_NAME)) {
+        QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+    }
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
+    m_db.setDatabaseName(m_dbPath);
+    // The GUI thread connection may hold the write lock briefly (metadata edits)
+    m_db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!m_db.open()) {
+        qWarning() << "ShotStorageWorker: Failed to open database:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery pragma(m_db);
+    pragma.exec("PRAGMA journal_mode=WAL");
+    pragma.exec("PRAGMA foreign_keys=ON");
+    ShotHistoryStorage::attachArchive(m_db, m_dbPath, true);
+
+    qDebug() << "ShotStorageWorker: Opened worker connection";
+    return true;
+}
+
+void ShotStorageWorker::close()
+{
+    if (!m_db.isValid()) return;
+
+    if (m_db.isOpen()) {
+        m_db.close();
+    }
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+}
+
+qint64 ShotStorageWorker::saveShot(const ShotRecord& record, QString* errorMessage)
+{
+    if (!m_db.isOpen() && !open()) {
+        if (errorMessage) *errorMessage = "Worker database not open";
+        return -1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 shotId = ShotHistoryStorage::insertShotRecord(m_db, record, errorMessage);
+    if (shotId <= 0) {
+        return -1;
+    }
+
+    // The commit is durable in the WAL. SQLite's auto-checkpoint folds it into the
+    // .db file, maintenance truncates the WAL, and downloads/backups checkpoint first.
+
+    qDebug() << "ShotStorageWorker: Saved shot" << shotId
+             << "- Profile:" << record.summary.profileName
+             << "- Duration:" << record.summary.duration << "s"
+             << "- Samples:" << record.pressure.size()
+             << "- Took:" << timer.elapsed() << "ms";
+
+    return shotId;
+}
+
+void ShotStorageWorker::migrateSampleEncoding()
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+
+    QSqlQuery select(m_db);
+    select.prepare("SELECT shot_id, data_blob FROM shot_samples WHERE encoding = ? LIMIT ?");
+    select.addBindValue(ShotHistoryStorage::SAMPLE_ENCODING_LEGACY_JSON);
+    select.addBindValue(SAMPLE_MIGRATION_BATCH);
+    if (!select.exec()) {
+        qWarning() << "ShotStorageWorker: Sample migration query failed:" << select.lastError().text();
+        return;
+    }
+
+    QList<QPair<qint64, QByteArray>> rows;
+    while (select.next()) {
+        rows.append({select.value(0).toLongLong(), select.value(1).toByteArray()});
+    }
+    select.finish();
+
+    if (rows.isEmpty()) {
+        if (m_migratedSamples > 0) {
+            qDebug() << "ShotStorageWorker: Sample migration complete -" << m_migratedSamples << "shots rewritten";
+        }
+        return;
+    }
+
+    QSqlQuery update(m_db);
+    update.prepare("UPDATE shot_samples SET data_blob = ?, encoding = ? WHERE shot_id = ?");
+
+    m_db.transaction();
+    for (const auto& row : rows) {
+        ShotRecord record;
+        if (ShotHistoryStorage::decodeSampleData(row.second, &record)) {
+            update.addBindValue(ShotHistoryStorage::encodeSampleData(record));
+            update.addBindValue(ShotHistoryStorage::SAMPLE_ENCODING_COLUMNAR);
+        } else {
+            // Keep the original bytes, but don't pick this row up again
+            update.addBindValue(row.second);
+            update.addBindValue(ShotHistoryStorage::SAMPLE_ENCODING_UNREADABLE);
+        }
+        update.addBindValue(row.first);
+        if (!update.exec()) {
+            qWarning() << "ShotStorageWorker: Failed to rewrite samples for shot" << row.first
+                       << update.lastError().text();
+            m_db.rollback();
+            return;
+        }
+    }
+    m_db.commit();
+    m_migratedSamples += static_cast<int>(rows.size());
+
+    QMetaObject::invokeMethod(this, &ShotStorageWorker::migrateSampleEncoding, Qt::QueuedConnection);
+}
+
+void ShotStorageWorker::backfillMetrics()
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+
+    QSqlQuery select(m_db);
+    select.prepare(R"(
+        SELECT s.id, s.duration_seconds, s.final_weight, s.dose_weight, ss.data_blob
+        FROM shots s
+        LEFT JOIN shot_metrics m ON m.shot_id = s.id
+        LEFT JOIN shot_samples_all ss ON ss.shot_id = s.id
+        WHERE m.shot_id IS NULL
+        LIMIT ?
+    )");
+    select.addBindValue(METRICS_BACKFILL_BATCH);
+    if (!select.exec()) {
+        qWarning() << "ShotStorageWorker: Metrics backfill query failed:" << select.lastError().text();
+        return;
+    }
+
+    QList<ShotRecord> records;
+    while (select.next()) {
+        ShotRecord record;
+        record.summary.id = select.value(0).toLongLong();
+        record.summary.duration = select.value(1).toDouble();
+        record.summary.finalWeight = select.value(2).toDouble();
+        record.summary.doseWeight = select.value(3).toDouble();
+        // Undecodable or missing samples still get a (mostly NULL) row, so they aren't retried
+        ShotHistoryStorage::decodeSampleData(select.value(4).toByteArray(), &record);
+        records.append(record);
+    }
+    select.finish();
+
+    if (records.isEmpty()) {
+        if (m_backfilledMetrics > 0) {
+            qDebug() << "ShotStorageWorker: Metrics backfill complete -" << m_backfilledMetrics << "shots";
+        }
+        return;
+    }
+
+    QSqlQuery phases(m_db);
+    phases.prepare("SELECT time_offset, label FROM shot_phases WHERE shot_id = ? AND label = 'Start' LIMIT 1");
+
+    m_db.transaction();
+    for (ShotRecord& record : records) {
+        // Extraction start is the only phase the metrics need
+        phases.addBindValue(record.summary.id);
+        if (phases.exec() && phases.next()) {
+            HistoryPhaseMarker marker;
+            marker.time = phases.value(0).toDouble();
+            marker.label = phases.value(1).toString();
+            record.phases.append(marker);
+        }
+        phases.finish();
+
+        if (!ShotHistoryStorage::writeShotMetrics(m_db, record.summary.id, record)) {
+            m_db.rollback();
+            return;
+        }
+    }
+    m_db.commit();
+    m_backfilledMetrics += static_cast<int>(records.size());
+
+    QMetaObject::invokeMethod(this, &ShotStorageWorker::backfillMetrics, Qt::QueuedConnection);
+}
+
+void ShotStorageWorker::backfillSeriesLod()
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+
+    QSqlQuery select(m_db);
+    select.prepare(R"(
+        SELECT ss.shot_id, ss.data_blob
+        FROM shot_samples_all ss
+        WHERE NOT EXISTS (SELECT 1 FROM shot_series_lod l WHERE l.shot_id = ss.shot_id)
+        LIMIT ?
+    )");
+    select.addBindValue(LOD_BACKFILL_BATCH);
+    if (!select.exec()) {
+        qWarning() << "ShotStorageWorker: LOD backfill query failed:" << select.lastError().text();
+        return;
+    }
+
+    QList<QPair<qint64, QByteArray>> rows;
+    while (select.next()) {
+        rows.append({select.value(0).toLongLong(), select.value(1).toByteArray()});
+    }
+    select.finish();
+
+    if (rows.isEmpty()) {
+        if (m_backfilledLod > 0) {
+            qDebug() << "ShotStorageWorker: LOD backfill complete -" << m_backfilledLod << "shots";
+        }
+        return;
+    }
+
+    m_db.transaction();
+    for (const auto& row : rows) {
+        // Undecodable samples still get (empty) levels, so they aren't retried
+        ShotRecord record;
+        ShotHistoryStorage::decodeSampleData(row.second, &record);
+        if (!ShotHistoryStorage::writeShotSeriesLod(m_db, row.first, record)) {
+            m_db.rollback();
+            return;
+        }
+    }
+    m_db.commit();
+    m_backfilledLod += static_cast<int>(rows.size());
+
+    QMetaObject::invokeMethod(this, &ShotStorageWorker::backfillSeriesLod, Qt::QueuedConnection);
+}
+
+void ShotStorageWorker::backfillFingerprints()
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+
+    QSqlQuery select(m_db);
+    select.prepare(R"(
+        SELECT ss.shot_id, ss.data_blob
+        FROM shot_samples_all ss
+        LEFT JOIN shot_fingerprints f ON f.shot_id = ss.shot_id
+        WHERE f.shot_id IS NULL OR f.version != ?
+        LIMIT ?
+    )");
+    select.addBindValue(ShotFingerprint::VERSION);
+    select.addBindValue(FINGERPRINT_BACKFILL_BATCH);
+    if (!select.exec()) {
+        qWarning() << "ShotStorageWorker: Fingerprint backfill query failed:" << select.lastError().text();
+        return;
+    }
+
+    QList<ShotRecord> records;
+    while (select.next()) {
+        ShotRecord record;
+        record.summary.id = select.value(0).toLongLong();
+        // Undecodable samples still get an (all-zero) fingerprint, so they aren't retried
+        ShotHistoryStorage::decodeSampleData(select.value(1).toByteArray(), &record);
+        records.append(record);
+    }
+    select.finish();
+
+    if (records.isEmpty()) {
+        if (m_backfilledFingerprints > 0) {
+            qDebug() << "ShotStorageWorker: Fingerprint backfill complete -" << m_backfilledFingerprints << "shots";
+        }
+        return;
+    }
+
+    QSqlQuery phases(m_db);
+    phases.prepare("SELECT time_offset, label FROM shot_phases WHERE shot_id = ? AND label = 'Start' LIMIT 1");
+
+    m_db.transaction();
+    for (ShotRecord& record : records) {
+        // Extraction start is the only phase the fingerprint needs
+        phases.addBindValue(record.summary.id);
+        if (phases.exec() && phases.next()) {
+            HistoryPhaseMarker marker;
+            marker.time = phases.value(0).toDouble();
+            marker.label = phases.value(1).toString();
+            record.phases.append(marker);
+        }
+        phases.finish();
+
+        if (!ShotHistoryStorage::writeShotFingerprint(m_db, record.summary.id, record)) {
+            m_db.rollback();
+            return;
+        }
+    }
+    m_db.commit();
+    m_backfilledFingerprints += static_cast<int>(records.size());
+    emit fingerprintsWritten();
+
+    QMetaObject::invokeMethod(this, &ShotStorageWorker::backfillFingerprints, Qt::QueuedConnection);
+}
+
+void ShotStorageWorker::archiveSamples()
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+
+    if (archiveBatch() > 0) {
+        QMetaObject::invokeMethod(this, &ShotStorageWorker::archiveSamples, Qt::QueuedConnection);
+    } else if (m_archivedSamples > 0) {
+        qDebug() << "ShotStorageWorker: Archived samples of" << m_archivedSamples << "shots";
+        m_archivedSamples = 0;
+    }
+}
+
+int ShotStorageWorker::archiveBatch()
+{
+    QSqlQuery query(m_db);
+    if (!m_archiveSwept) {
+        // Samples whose shot was deleted or replaced by an import since the last run
+        m_archiveSwept = true;
+        if (!query.exec("DELETE FROM archive.shot_samples WHERE shot_id NOT IN (SELECT id FROM main.shots)")) {
+            qWarning() << "ShotStorageWorker: Archive unavailable:" << query.lastError().text();
+            return -1;
+        }
+        if (query.numRowsAffected() > 0) {
+            qDebug() << "ShotStorageWorker: Removed" << query.numRowsAffected() << "orphaned archive samples";
+        }
+    }
+
+    // Newest shot that falls outside the hot count, if there are that many
+    qint64 countTimestamp = std::numeric_limits<qint64>::min();
+    qint64 countId = std::numeric_limits<qint64>::min();
+    query.prepare("SELECT timestamp, id FROM main.shots ORDER BY timestamp DESC, id DESC LIMIT 1 OFFSET ?");
+    query.addBindValue(ShotHistoryStorage::ARCHIVE_KEEP_RECENT_SHOTS);
+    if (query.exec() && query.next()) {
+        countTimestamp = query.value(0).toLongLong();
+        countId = query.value(1).toLongLong();
+    }
+    query.finish();
+
+    // Only columnar blobs move, so the encoding migration never has to look in the archive
+    qint64 ageCutoff = QDateTime::currentSecsSinceEpoch() - qint64(ShotHistoryStorage::ARCHIVE_AFTER_DAYS) * 86400;
+    query.prepare(R"(
+        SELECT ss.shot_id
+        FROM main.shot_samples ss
+        JOIN main.shots s ON s.id = ss.shot_id
+        WHERE ss.encoding = ? AND (s.timestamp < ? OR (s.timestamp, s.id) <= (?, ?))
+        LIMIT ?
+    )");
+    query.addBindValue(ShotHistoryStorage::SAMPLE_ENCODING_COLUMNAR);
+    query.addBindValue(ageCutoff);
+    query.addBindValue(countTimestamp);
+    query.addBindValue(countId);
+    query.addBindValue(ARCHIVE_BATCH);
+    if (!query.exec()) {
+        qWarning() << "ShotStorageWorker: Archive query failed:" << query.lastError().text();
+        return -1;
+    }
+
+    QStringList ids;
+    while (query.next()) {
+        ids << QString::number(query.value(0).toLongLong());
+    }
+    query.finish();
+    if (ids.isEmpty()) return 0;
+
+    // Copy and commit, then delete in a second transaction. A transaction spanning attached
+    // WAL databases is atomic per file only, so the archive copy must be durable before the
+    // hot one goes: a crash in between leaves the blob in both (readers prefer the hot tier,
+    // the next batch replaces the archived copy), never in neither.
+    const QString idList = ids.join(", ");
+    m_db.transaction();
+    if (!query.exec(QString(R"(
+            INSERT OR REPLACE INTO archive.shot_samples (shot_id, sample_count, data_blob, encoding)
+            SELECT shot_id, sample_count, data_blob, encoding FROM main.shot_samples WHERE shot_id IN (%1)
+        )").arg(idList)) || !m_db.commit()) {
+        qWarning() << "ShotStorageWorker: Archiving samples failed:" << query.lastError().text();
+        m_db.rollback();
+        return -1;
+    }
+
+    // Only blobs that did reach the archive leave shots.db
+    m_db.transaction();
+    if (!query.exec(QString(R"(
+            DELETE FROM main.shot_samples
+            WHERE shot_id IN (%1) AND shot_id IN (SELECT shot_id FROM archive.shot_samples)
+        )").arg(idList)) || !m_db.commit()) {
+        qWarning() << "ShotStorageWorker: Removing archived samples failed:" << query.lastError().text();
+        m_db.rollback();
+        return -1;
+    }
+    m_archivedSamples += static_cast<int>(ids.size());
+    return static_cast<int>(ids.size());
+}
+
+void ShotStorageWorker::runMaintenance(int generation)
+{
+    if (!m_db.isOpen()) return;  // Closed for shutdown
+    auto cancelled = [this, generation]() { return m_maintenanceGeneration != generation; };
+    if (cancelled()) {
+        qDebug() << "ShotStorageWorker: Maintenance cancelled before it started";
+        return;
+    }
+
+    QElapsedTimer total;
+    total.start();
+    QVariantMap stats;
+    stats["startedAt"] = QDateTime::currentSecsSinceEpoch();
+
+    QSqlQuery query(m_db);
+    auto pragmaValue = [&query](const char* pragma) {
+        return query.exec(QString("PRAGMA %1").arg(pragma)) && query.next() ? query.value(0).toLongLong() : -1;
+    };
+    const qint64 pageSize = pragmaValue("page_size");
+    const qint64 autoVacuum = pragmaValue("auto_vacuum");
+    stats["pageSize"] = pageSize;
+    stats["pagesBefore"] = pragmaValue("page_count");
+    stats["freePagesBefore"] = pragmaValue("freelist_count");
+
+    // Runs each step unless the machine woke up meanwhile; records its duration as <name>Ms
+    auto step = [&stats, &cancelled](const QString& name, const std::function<void()>& work) {
+        if (cancelled()) {
+            stats["cancelled"] = true;
+            return;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        work();
+        stats[name + "Ms"] = timer.elapsed();
+    };
+
+    step("analyze", [&]() {
+        // Full ANALYZE once; afterwards optimize only re-analyzes tables that changed enough
+        query.exec(QString("PRAGMA analysis_limit = %1").arg(ANALYSIS_LIMIT));
+        bool analyzed = query.exec("SELECT 1 FROM sqlite_master WHERE name = 'sqlite_stat1'") && query.next();
+        query.exec(analyzed ? "PRAGMA optimize" : "ANALYZE");
+    });
+
+    step("archive", [&]() {
+        // Long-running instances keep moving shots out of the hot set, not just at startup
+        m_archiveSwept = false;
+        int moved = 0;
+        int batch = 0;
+        while (!cancelled() && (batch = archiveBatch()) > 0) {
+            moved += batch;
+        }
+        m_archivedSamples = 0;
+        stats["archivedShots"] = moved;
+    });
+
+    step("vacuum", [&]() {
+        if (autoVacuum == 2) {
+            // The pragma frees one page per step and QSQLITE steps a statement once per
+            // exec(), so drive it in rounds (one transaction each) until the freelist is
+            // empty or stops shrinking, stopping between rounds if the machine wakes
+            const qint64 freeBefore = pragmaValue("freelist_count");
+            qint64 freePages = freeBefore;
+            QSqlQuery vacuum(m_db);
+            vacuum.prepare("PRAGMA incremental_vacuum");
+            while (freePages > 0 && !cancelled()) {
+                m_db.transaction();
+                for (int i = 0; i < VACUUM_PAGES_PER_ROUND && i < freePages && vacuum.exec(); ++i) {
+                    vacuum.finish();
+                }
+                if (!m_db.commit()) {
+                    qWarning() << "ShotStorageWorker: Incremental vacuum failed:" << m_db.lastError().text();
+                    m_db.rollback();
+                    break;
+                }
+                const qint64 remaining = pragmaValue("freelist_count");
+                if (remaining < 0 || remaining >= freePages) break;
+                freePages = remaining;
+            }
+            stats["vacuum"] = "incremental";
+            stats["vacuumPagesFreed"] = qMax<qint64>(0, freeBefore - freePages);
+            return;
+        }
+        // Databases created before incremental auto-vacuum need one full VACUUM to switch.
+        // Only worth it once enough pages are free (e.g. after samples moved to the archive).
+        qint64 pages = stats["pagesBefore"].toLongLong();
+        qint64 freePages = stats["freePagesBefore"].toLongLong();
+        if (pages > 0 && freePages > pages * VACUUM_FREE_FRACTION) {
+            query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+            if (query.exec("VACUUM")) {
+                stats["vacuum"] = "full";
+                stats["vacuumPagesFreed"] = qMax<qint64>(0, pages - pragmaValue("page_count"));
+            } else {
+                qWarning() << "ShotStorageWorker: VACUUM failed:" << query.lastError().text();
+            }
+        } else {
+            stats["vacuum"] = "skipped";
+        }
+    });
+
+    step("checkpoint", [&]() {
+        // Every attached database (main and archive); busy = 1 if a reader blocked truncation
+        if (query.exec("PRAGMA wal_checkpoint(TRUNCATE)") && query.next()) {
+            stats["checkpointBusy"] = query.value(0).toInt();
+            stats["checkpointFrames"] = query.value(2).toInt();
+        }
+    });
+
+    step("integrity", [&]() {
+        stats["integrity"] = query.exec("PRAGMA quick_check(1)") && query.next()
+            ? query.value(0).toString() : query.lastError().text();
+    });
+
+    query.finish();
+    stats["pagesAfter"] = pragmaValue("page_count");
+    stats["freePagesAfter"] = pragmaValue("freelist_count");
+    stats["durationMs"] = total.elapsed();
+    query.finish();
+
+    if (stats.value("integrity", "ok").toString() != "ok") {
+        qWarning() << "ShotStorageWorker: Integrity check failed:" << stats["integrity"].toString();
+    }
+    qDebug() << "ShotStorageWorker: Maintenance" << (stats.contains("cancelled") ? "cancelled" : "done")
+             << "in" << stats["durationMs"].toLongLong() << "ms - pages" << stats["pagesBefore"].toLongLong()
+             << "->" << stats["pagesAfter"].toLongLong() << ", free" << stats["freePagesBefore"].toLongLong()
+             << "->" << stats["freePagesAfter"].toLongLong() << "of" << pageSize << "bytes";
+
+    query.prepare("INSERT INTO maintenance_log (started_at, duration_ms, stats) VALUES (?, ?, ?)");
+    query.addBindValue(stats["startedAt"]);
+    query.addBindValue(stats["durationMs"]);
+    query.addBindValue(QString::fromUtf8(QJsonDocument(QJsonObject::fromVariantMap(stats)).toJson(QJsonDocument::Compact)));
+    query.exec();
+    query.prepare("DELETE FROM maintenance_log WHERE id NOT IN (SELECT id FROM maintenance_log ORDER BY id DESC LIMIT ?)");
+    query.addBindValue(MAINTENANCE_LOG_KEEP);
+    query.exec();
+
+    emit maintenanceFinished(stats);
+}
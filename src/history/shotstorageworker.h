@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+
+struct ShotRecord;
+
+// Runs on ShotHistoryStorage's worker thread with its own SQLite connection.
+// Jobs are posted as queued invocations, so they execute in FIFO order
+// and the GUI thread never waits on compression or disk I/O.
+class ShotStorageWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ShotStorageWorker(const QString& dbPath, QObject* parent = nullptr);
+    ~ShotStorageWorker();
+
+    // Connection lifecycle - must be called on the worker thread
+    bool open();
+    void close();
+    bool isOpen() const { return m_db.isOpen(); }
+
+    // Persist a complete shot. Returns shot ID, or -1 on error (errorMessage set)
+    qint64 saveShot(const ShotRecord& record, QString* errorMessage);
+
+    // Thread-safe: passes queued with an older generation stop before their next step
+    // (or never start), even if the cancel arrives before the pass begins
+    int maintenanceGeneration() const { return m_maintenanceGeneration; }
+    void cancelMaintenance() { m_maintenanceGeneration++; }
+
+public slots:
+    // Rewrite one batch of legacy JSON sample blobs to the columnar format,
+    // then requeue itself so saves posted meanwhile run between batches
+    void migrateSampleEncoding();
+
+    // Compute shot_metrics rows for shots saved before the table existed (batched, requeues itself)
+    void backfillMetrics();
+
+    // Build shot_series_lod levels for shots that have none yet (batched, requeues itself)
+    void backfillSeriesLod();
+
+    // Compute shot_fingerprints for shots without a current-version row (batched, requeues itself)
+    void backfillFingerprints();
+
+    // Move sample blobs of old shots to the archive database (batched, requeues itself)
+    void archiveSamples();
+
+    // Sample archiving, ANALYZE/optimize, incremental vacuum, WAL checkpoint(TRUNCATE) and quick_check.
+    // Records timings and page/freelist counts in maintenance_log and emits them.
+    // generation is maintenanceGeneration() when the pass was queued.
+    void runMaintenance(int generation);
+
+signals:
+    // A batch of fingerprints was written outside the GUI thread's view
+    void fingerprintsWritten();
+
+    // Timings (ms) and page statistics of a finished or cancelled maintenance pass
+    void maintenanceFinished(const QVariantMap& stats);
+
+private:
+    // Move one batch of cold sample blobs to the archive. Returns shots moved, -1 on error
+    int archiveBatch();
+
+    QString m_dbPath;
+    QSqlDatabase m_db;
+    int m_migratedSamples = 0;
+    int m_backfilledMetrics = 0;
+    int m_backfilledLod = 0;
+    int m_backfilledFingerprints = 0;
+    int m_archivedSamples = 0;
+    bool m_archiveSwept = false;
+    std::atomic_int m_maintenanceGeneration { 0 };
+
+    static constexpr int SAMPLE_MIGRATION_BATCH = 25;
+    static constexpr int METRICS_BACKFILL_BATCH = 25;
+    static constexpr int LOD_BACKFILL_BATCH = 25;
+    static constexpr int FINGERPRINT_BACKFILL_BATCH = 25;
+    static constexpr int ARCHIVE_BATCH = 100;
+    static constexpr int ANALYSIS_LIMIT = 1000;           // Rows sampled per index by ANALYZE
+    static constexpr double VACUUM_FREE_FRACTION = 0.25;  // Free pages that justify a full VACUUM
+    static constexpr int VACUUM_PAGES_PER_ROUND = 1000;   // incremental_vacuum steps per transaction
+    static constexpr int MAINTENANCE_LOG_KEEP = 20;
+    static const QString DB_CONNECTION_NAME;
+};
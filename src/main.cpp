@@ -34,6 +34,9 @@
 #include "ble/scales/flowscale.h"
 #include "machine/machinestate.h"
 #include "models/shotdatamodel.h"
+#include "models/shotchartitem.h"
+#include "models/shothistorylistmodel.h"
+#include "models/shotseries.h"
 #include "controllers/maincontroller.h"
 #include "controllers/shottimingcontroller.h"
 #include "ai/aimanager.h"
@@ -412,6 +415,13 @@ int main(int argc, char *argv[])
     // Register strange attractor renderer for attractor screensaver
     qmlRegisterType<StrangeAttractorRenderer>("DecenzaDE1", 1, 0, "StrangeAttractorRenderer");
 
+    // Scene graph live shot chart (NativeShotGraph)
+    qmlRegisterType<ShotChartItem>("DecenzaDE1", 1, 0, "ShotChartItem");
+
+    // Paged shot history list and typed shot curves for history charts
+    qmlRegisterType<ShotHistoryListModel>("DecenzaDE1", 1, 0, "ShotHistoryListModel");
+    qmlRegisterType<ShotSeries>("DecenzaDE1", 1, 0, "ShotSeries");
+
     // Load main QML file (QTP0001 NEW policy uses /qt/qml/ prefix)
     const QUrl url(u"qrc:/qt/qml/DecenzaDE1/qml/main.qml"_s);
 
@@ -0,0 +1,57 @@
+#include "seriesdecimator.h"
+
+#include <atomic>
+
+namespace {
+
+std::atomic<qint64> s_runs { 0 };
+std::atomic<qint64> s_inputPoints { 0 };
+std::atomic<qint64> s_outputPoints { 0 };
+std::atomic<qint64> s_nanos { 0 };
+std::atomic<qint64> s_lastInput { 0 };
+std::atomic<qint64> s_lastOutput { 0 };
+std::atomic<qint64> s_lastNanos { 0 };
+
+}  // namespace
+
+void SeriesDecimator::record(qsizetype input, qsizetype output, qint64 nanos)
+{
+    s_runs++;
+    s_inputPoints += input;
+    s_outputPoints += output;
+    s_nanos += nanos;
+    s_lastInput = input;
+    s_lastOutput = output;
+    s_lastNanos = nanos;
+}
+
+QVariantMap SeriesDecimator::stats()
+{
+    const qint64 runs = s_runs;
+    const qint64 input = s_inputPoints;
+    const qint64 output = s_outputPoints;
+    const qint64 nanos = s_nanos;
+
+    QVariantMap result;
+    result["runs"] = runs;
+    result["inputPoints"] = input;
+    result["outputPoints"] = output;
+    result["ratio"] = output > 0 ? double(input) / output : 1.0;
+    result["totalUs"] = nanos / 1000.0;
+    result["meanUs"] = runs > 0 ? nanos / 1000.0 / runs : 0.0;
+    result["lastInputPoints"] = qint64(s_lastInput);
+    result["lastOutputPoints"] = qint64(s_lastOutput);
+    result["lastUs"] = s_lastNanos / 1000.0;
+    return result;
+}
+
+void SeriesDecimator::resetStats()
+{
+    s_runs = 0;
+    s_inputPoints = 0;
+    s_outputPoints = 0;
+    s_nanos = 0;
+    s_lastInput = 0;
+    s_lastOutput = 0;
+    s_lastNanos = 0;
+}
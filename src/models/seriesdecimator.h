@@ -0,0 +1,134 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QVariantMap>
+#include <QVector>
+
+#include <cmath>
+#include <utility>
+
+/**
+ * Peak-preserving reduction of a time series to what a viewport can show.
+ *
+ * Min/max per pixel column (the "M4" scheme): every column keeps its first,
+ * minimum, maximum and last point in time order, so spikes, dips and the line
+ * between columns are drawn exactly as the full series would be - only points
+ * that land on the same pixels are dropped. One linear pass, no allocation
+ * beyond the output, cheap enough for every chart flush.
+ *
+ * Series may be a QVector<QPointF> or a ShotSeriesView. Run counts, reduction
+ * ratio and time spent are accumulated for the debug page (stats()).
+ */
+class SeriesDecimator {
+public:
+    static constexpr int POINTS_PER_PIXEL = 4;  // Max kept per column
+
+    // True when the series has more points than the viewport can distinguish
+    static bool needed(qsizetype pointCount, int pixelWidth) {
+        return pixelWidth > 0 && pointCount > qsizetype(pixelWidth) * POINTS_PER_PIXEL;
+    }
+
+    // Points whose x is outside [xMin, xMax] fall into the edge columns
+    template <typename Series>
+    static QVector<QPointF> minMax(const Series& points, double xMin, double xMax, int pixelWidth);
+
+    // Fixed-width columns from origin, for a series that keeps growing: appends the reduction
+    // of points[from..] to 'out' and returns the index in 'points' where the last column starts.
+    // That column is still open (later points may land in it); its output starts at out[*openOutput].
+    template <typename Series>
+    static qsizetype minMaxColumns(const Series& points, qsizetype from, double origin, double columnWidth,
+                                   QVector<QPointF>* out, qsizetype* openOutput);
+
+    // Totals since start (or resetStats): runs, inputPoints, outputPoints, ratio, totalUs, meanUs, last*
+    static QVariantMap stats();
+    static void resetStats();
+
+private:
+    template <typename Series, typename ColumnOf>
+    static qsizetype reduce(const Series& points, qsizetype from, ColumnOf columnOf,
+                            QVector<QPointF>* out, qsizetype* openOutput);
+    static void record(qsizetype input, qsizetype output, qint64 nanos);
+};
+
+template <typename Series>
+QVector<QPointF> SeriesDecimator::minMax(const Series& points, double xMin, double xMax, int pixelWidth)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const qsizetype count = points.size();
+    QVector<QPointF> out;
+    if (!needed(count, pixelWidth) || xMax <= xMin) {
+        out.reserve(count);
+        for (qsizetype i = 0; i < count; ++i) out.append(points[i]);
+        return out;
+    }
+
+    out.reserve(qsizetype(pixelWidth) * POINTS_PER_PIXEL);
+    const double columnsPerUnit = pixelWidth / (xMax - xMin);
+    qsizetype openOutput = 0;
+    reduce(points, 0, [&](double x) {
+        return qBound<qint64>(0, qint64(std::floor((x - xMin) * columnsPerUnit)), pixelWidth - 1);
+    }, &out, &openOutput);
+
+    record(count, out.size(), timer.nsecsElapsed());
+    return out;
+}
+
+template <typename Series>
+qsizetype SeriesDecimator::minMaxColumns(const Series& points, qsizetype from, double origin, double columnWidth,
+                                         QVector<QPointF>* out, qsizetype* openOutput)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const qsizetype outputBefore = out->size();
+    const qsizetype openStart = reduce(points, from, [&](double x) {
+        return qMax<qint64>(0, qint64(std::floor((x - origin) / columnWidth)));
+    }, out, openOutput);
+    *openOutput -= outputBefore;
+
+    record(points.size() - from, out->size() - outputBefore, timer.nsecsElapsed());
+    return openStart;
+}
+
+template <typename Series, typename ColumnOf>
+qsizetype SeriesDecimator::reduce(const Series& points, qsizetype from, ColumnOf columnOf,
+                                  QVector<QPointF>* out, qsizetype* openOutput)
+{
+    const qsizetype count = points.size();
+    qsizetype first = count, minIdx = 0, maxIdx = 0, last = 0;
+    double minY = 0, maxY = 0;
+    qint64 column = -1;
+    *openOutput = out->size();
+
+    auto flush = [&]() {
+        // Emit the column's extremes in time order, each point once
+        *openOutput = out->size();
+        qsizetype idx[4] = { first, minIdx, maxIdx, last };
+        if (idx[1] > idx[2]) std::swap(idx[1], idx[2]);
+        qsizetype previous = -1;
+        for (qsizetype i : idx) {
+            if (i != previous) out->append(points[i]);
+            previous = i;
+        }
+    };
+
+    for (qsizetype i = from; i < count; ++i) {
+        const QPointF pt = points[i];
+        const qint64 c = columnOf(pt.x());
+        if (c != column) {
+            if (column >= 0) flush();
+            column = c;
+            first = minIdx = maxIdx = last = i;
+            minY = maxY = pt.y();
+            continue;
+        }
+        last = i;
+        if (pt.y() < minY) { minY = pt.y(); minIdx = i; }
+        if (pt.y() > maxY) { maxY = pt.y(); maxIdx = i; }
+    }
+    if (column >= 0) flush();
+    return first;
+}
@@ -0,0 +1,199 @@
+#include "shotalignment.h"
+
+#include <QtNumeric>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Linear-interpolated percentile of a non-empty array, by selection rather than a full
+// sort (linear in count). Reorders values; any order is fine for the next call.
+double percentile(double* values, qsizetype count, double pct)
+{
+    const double rank = qBound(0.0, pct, 100.0) / 100.0 * double(count - 1);
+    const qsizetype below = qsizetype(std::floor(rank));
+    std::nth_element(values, values + below, values + count);
+    const double low = values[below];
+    if (below + 1 >= count) return low;
+    // Everything after the nth element is >= it; the smallest of those is the next rank
+    const double high = *std::min_element(values + below + 1, values + count);
+    return low + (high - low) * (rank - double(below));
+}
+
+}  // namespace
+
+ShotAlignment::Anchor ShotAlignment::anchorFromString(const QString& name)
+{
+    if (name == QLatin1String("start")) return ShotStart;
+    if (name == QLatin1String("firstDrop")) return FirstDrop;
+    if (name == QLatin1String("frame")) return FrameStart;
+    return ExtractionStart;
+}
+
+QString ShotAlignment::anchorToString(Anchor anchor)
+{
+    switch (anchor) {
+    case ShotStart: return QStringLiteral("start");
+    case FirstDrop: return QStringLiteral("firstDrop");
+    case FrameStart: return QStringLiteral("frame");
+    case ExtractionStart: break;
+    }
+    return QStringLiteral("extractionStart");
+}
+
+void ShotAlignment::resample(const QVector<QPointF>& points, double offset, double t0, double step,
+                             double* out, qsizetype n)
+{
+    const double nan = qQNaN();
+    const qsizetype count = points.size();
+    if (count == 0) {
+        std::fill(out, out + n, nan);
+        return;
+    }
+
+    // Columns covered by the data: [first, last]
+    const double begin = points.first().x() - offset;
+    const double end = points.last().x() - offset;
+    const qsizetype first = qBound<qsizetype>(0, qsizetype(std::ceil((begin - t0) / step - 1e-9)), n);
+    const qsizetype last = qBound<qsizetype>(-1, qsizetype(std::floor((end - t0) / step + 1e-9)), n - 1);
+    std::fill(out, out + first, nan);
+    if (last + 1 < n) std::fill(out + std::max(first, last + 1), out + n, nan);
+
+    // Grid times only increase, so the bracketing segment only moves forward
+    qsizetype k = 0;
+    for (qsizetype j = first; j <= last; ++j) {
+        const double t = qBound(points.first().x(), t0 + double(j) * step + offset, points.last().x());
+        while (k + 2 < count && points[k + 1].x() < t) ++k;
+        const QPointF& a = points[k];
+        const QPointF& b = points[std::min(k + 1, count - 1)];
+        const double dx = b.x() - a.x();
+        out[j] = dx > 0 ? a.y() + (b.y() - a.y()) * (t - a.x()) / dx : b.y();
+    }
+}
+
+ShotAlignment::Result ShotAlignment::align(const QVector<const QVector<QPointF>*>& curves,
+                                           const QVector<double>& anchors, double step, int reference,
+                                           double lowerPercentile, double upperPercentile)
+{
+    Result result;
+    const qsizetype shots = std::min(curves.size(), anchors.size());
+
+    // Grid spans every shot's data once shifted
+    double tMin = std::numeric_limits<double>::max();
+    double tMax = std::numeric_limits<double>::lowest();
+    for (qsizetype i = 0; i < shots; ++i) {
+        const QVector<QPointF>& points = *curves[i];
+        if (points.isEmpty()) continue;
+        tMin = std::min(tMin, points.first().x() - anchors[i]);
+        tMax = std::max(tMax, points.last().x() - anchors[i]);
+    }
+    if (tMin > tMax) return result;
+
+    if (!(step > 0)) step = DEFAULT_STEP;
+    step = std::max(step, (tMax - tMin) / double(MAX_GRID_POINTS - 1));
+    // Whole multiples of step, so t = 0 (the anchor) is always a column
+    const double t0 = std::floor(tMin / step) * step;
+    const qsizetype n = qsizetype(std::floor((tMax - t0) / step + 1e-9)) + 1;
+
+    result.step = step;
+    result.time.resize(n);
+    double* time = result.time.data();
+    for (qsizetype j = 0; j < n; ++j) time[j] = t0 + double(j) * step;
+
+    result.rows.resize(shots);
+    for (qsizetype i = 0; i < shots; ++i) {
+        result.rows[i].resize(n);
+        resample(*curves[i], anchors[i], t0, step, result.rows[i].data(), n);
+    }
+
+    // Deltas: NaN wherever either shot has no data
+    if (reference >= 0 && reference < shots) {
+        const double* ref = result.rows[reference].constData();
+        result.delta.resize(shots);
+        for (qsizetype i = 0; i < shots; ++i) {
+            result.delta[i].resize(n);
+            const double* row = result.rows[i].constData();
+            double* delta = result.delta[i].data();
+            for (qsizetype j = 0; j < n; ++j) delta[j] = row[j] - ref[j];
+        }
+    }
+
+    // Running sums and extremes, row by row
+    const double nan = qQNaN();
+    QVector<double> sum(n, 0.0);
+    result.count.fill(0, n);
+    result.min.fill(std::numeric_limits<double>::max(), n);
+    result.max.fill(std::numeric_limits<double>::lowest(), n);
+    for (qsizetype i = 0; i < shots; ++i) {
+        const double* row = result.rows[i].constData();
+        double* s = sum.data();
+        double* lo = result.min.data();
+        double* hi = result.max.data();
+        int* count = result.count.data();
+        for (qsizetype j = 0; j < n; ++j) {
+            const bool valid = !std::isnan(row[j]);
+            const double v = valid ? row[j] : 0.0;
+            s[j] += v;
+            count[j] += valid;
+            lo[j] = valid ? std::min(lo[j], v) : lo[j];
+            hi[j] = valid ? std::max(hi[j], v) : hi[j];
+        }
+    }
+
+    // Percentiles: gather each column's valid values and select the ranks
+    result.mean.resize(n);
+    result.median.resize(n);
+    result.lower.resize(n);
+    result.upper.resize(n);
+    QVector<double> column(shots);
+    for (qsizetype j = 0; j < n; ++j) {
+        const int count = result.count[j];
+        if (count == 0) {
+            result.mean[j] = result.min[j] = result.max[j] = nan;
+            result.median[j] = result.lower[j] = result.upper[j] = nan;
+            continue;
+        }
+        result.mean[j] = sum[j] / count;
+        qsizetype m = 0;
+        for (qsizetype i = 0; i < shots; ++i) {
+            const double v = result.rows[i][j];
+            if (!std::isnan(v)) column[m++] = v;
+        }
+        result.median[j] = percentile(column.data(), m, 50.0);
+        result.lower[j] = percentile(column.data(), m, lowerPercentile);
+        result.upper[j] = percentile(column.data(), m, upperPercentile);
+    }
+
+    return result;
+}
+
+QVector<double> ShotAlignment::deviationScores(const Result& result, double minBandWidth)
+{
+    const qsizetype n = result.time.size();
+    const double* median = result.median.constData();
+    const double* lower = result.lower.constData();
+    const double* upper = result.upper.constData();
+
+    // Band width per column, floored so columns where every shot agrees don't blow up
+    QVector<double> scale(n);
+    for (qsizetype j = 0; j < n; ++j) {
+        scale[j] = 1.0 / std::max(upper[j] - lower[j], minBandWidth);
+    }
+
+    QVector<double> scores;
+    scores.reserve(result.rows.size());
+    for (const QVector<double>& row : result.rows) {
+        const double* r = row.constData();
+        double sum = 0;
+        qsizetype count = 0;
+        for (qsizetype j = 0; j < n; ++j) {
+            const double d = std::abs(r[j] - median[j]) * scale[j];
+            const bool valid = !std::isnan(d);
+            sum += valid ? d : 0.0;
+            count += valid;
+        }
+        scores.append(count > 0 ? sum / double(count) : qQNaN());
+    }
+    return scores;
+}
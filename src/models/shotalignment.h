@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/**
+ * Resampling of shot curves onto one shared time grid, so shots with different
+ * preinfusion lengths can be compared point by point.
+ *
+ * Every curve is shifted by its anchor time (extraction start, first drop,
+ * start of a profile frame - found by the caller) so the anchors line up at
+ * t = 0, then linearly interpolated at each grid step. Grid columns outside a
+ * shot's data are NaN. From the aligned rows, align() derives per-shot deltas
+ * against a reference shot and the mean / min / max / percentile envelope.
+ *
+ * All work runs over contiguous double arrays - one pass per row for the
+ * resampling, deltas and running sums, a linear-time selection per column for
+ * the percentiles - so cost grows linearly with the number of shots and grid
+ * points.
+ */
+class ShotAlignment {
+public:
+    enum Anchor {
+        ShotStart,        // Raw shot time, no shift
+        ExtractionStart,  // "Start" phase marker
+        FirstDrop,        // First weight >= ShotMetrics::FIRST_DROP_WEIGHT after extraction start
+        FrameStart        // First marker of a given profile frame number
+    };
+
+    // "start", "extractionStart", "firstDrop", "frame"; unknown names map to ExtractionStart
+    static Anchor anchorFromString(const QString& name);
+    static QString anchorToString(Anchor anchor);
+
+    struct Result {
+        double step = 0;
+        QVector<double> time;             // Grid, seconds relative to the anchor
+        QVector<QVector<double>> rows;    // Resampled curve per shot, NaN where it has no data
+        QVector<QVector<double>> delta;   // rows[i] - rows[reference]
+        QVector<double> mean;             // Envelope across shots with data in the column
+        QVector<double> min;
+        QVector<double> max;
+        QVector<double> median;
+        QVector<double> lower;            // lowerPercentile / upperPercentile
+        QVector<double> upper;
+        QVector<int> count;               // Shots with data per column
+    };
+
+    // curves and anchors are parallel (anchor = absolute time that becomes t = 0).
+    // step is clamped so the grid has at most MAX_GRID_POINTS columns; reference < 0 skips deltas.
+    static Result align(const QVector<const QVector<QPointF>*>& curves, const QVector<double>& anchors,
+                        double step, int reference = 0,
+                        double lowerPercentile = 10.0, double upperPercentile = 90.0);
+
+    // Per shot: mean distance from the median, in units of the lower-upper band width
+    // (at least minBandWidth), over the columns where the shot has data. ~0.5 is typical;
+    // much larger means the shot ran outside the band for much of its length.
+    static QVector<double> deviationScores(const Result& result, double minBandWidth);
+
+    // Linear interpolation of points (sorted by x) at offset + t0 + j * step, j < n
+    static void resample(const QVector<QPointF>& points, double offset, double t0, double step,
+                         double* out, qsizetype n);
+
+    static constexpr double DEFAULT_STEP = 0.1;       // s
+    static constexpr qsizetype MAX_GRID_POINTS = 4000;
+};
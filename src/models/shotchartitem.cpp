@@ -0,0 +1,371 @@
+#include "shotchartitem.h"
+#include "shotdatamodel.h"
+
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+#include <QDebug>
+
+#include <cstring>
+
+namespace {
+
+constexpr int VERTICES_PER_SEGMENT = 6;  // Two triangles per line segment
+constexpr int INITIAL_VERTICES = 600 * VERTICES_PER_SEGMENT;
+
+// One curve as thick-line triangles in (time, normalized value) coordinates.
+// Unused capacity is zero-filled, i.e. degenerate triangles that draw nothing,
+// so appending never touches vertices that are already there.
+class LineNode : public QSGGeometryNode {
+public:
+    LineNode()
+    {
+        setMaterial(&m_material);
+        setFlag(OwnsGeometry);
+        allocate(INITIAL_VERTICES);
+    }
+
+    void setColor(const QColor& color)
+    {
+        if (m_material.color() != color) {
+            m_material.setColor(color);
+            markDirty(DirtyMaterial);
+        }
+    }
+
+    void reset()
+    {
+        if (m_used == 0 && m_consumed == 0) return;
+        std::memset(geometry()->vertexData(), 0, size_t(m_used) * sizeof(QSGGeometry::Point2D));
+        m_used = 0;
+        m_consumed = 0;
+        markDirty(DirtyGeometry);
+    }
+
+    // Append the segments of points not consumed yet. scaleX/height are the pixel scales the
+    // line width is baked in at; yMin/yMax the value range mapped to 0..1.
+    void sync(const ShotSeriesView& points, double yMin, double yMax,
+              double scaleX, double height, double width)
+    {
+        const qsizetype count = points.size();
+        if (count < m_consumed) reset();  // Data was cleared underneath us
+        if (count == m_consumed) return;
+
+        const qsizetype first = qMax<qsizetype>(m_consumed, 1);
+        ensureCapacity(m_used + int(count - first) * VERTICES_PER_SEGMENT);
+
+        const double range = yMax > yMin ? yMax - yMin : 1.0;
+        const double halfWidth = width / 2.0;
+        QSGGeometry::Point2D* v = geometry()->vertexDataAsPoint2D() + m_used;
+
+        QPointF prev = points[first - 1];
+        double ax = prev.x() * scaleX;
+        double ay = (prev.y() - yMin) / range * height;
+        for (qsizetype i = first; i < count; ++i) {
+            const QPointF pt = points[i];
+            const double bx = pt.x() * scaleX;
+            const double by = (pt.y() - yMin) / range * height;
+            const double dx = bx - ax;
+            const double dy = by - ay;
+            const double length = std::sqrt(dx * dx + dy * dy);
+            if (length > 1e-6) {
+                // Square caps (extend by half the width) close the notches at joints
+                const double ux = dx / length * halfWidth;
+                const double uy = dy / length * halfWidth;
+                const double x0 = ax - ux, y0 = ay - uy;
+                const double x1 = bx + ux, y1 = by + uy;
+                const double nx = -uy, ny = ux;
+                auto put = [&](double px, double py) {
+                    v->set(float(px / scaleX), float(py / height));
+                    ++v;
+                };
+                put(x0 + nx, y0 + ny);
+                put(x0 - nx, y0 - ny);
+                put(x1 + nx, y1 + ny);
+                put(x1 + nx, y1 + ny);
+                put(x0 - nx, y0 - ny);
+                put(x1 - nx, y1 - ny);
+                m_used += VERTICES_PER_SEGMENT;
+            }
+            ax = bx;
+            ay = by;
+        }
+        m_consumed = count;
+        markDirty(DirtyGeometry);
+    }
+
+private:
+    void allocate(int capacity)
+    {
+        auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), capacity);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+        auto* data = geometry->vertexDataAsPoint2D();
+        if (QSGGeometry* old = this->geometry()) {
+            std::memcpy(data, old->vertexData(), size_t(m_used) * sizeof(QSGGeometry::Point2D));
+        }
+        std::memset(data + m_used, 0, size_t(capacity - m_used) * sizeof(QSGGeometry::Point2D));
+        setGeometry(geometry);  // Deletes the old one (OwnsGeometry)
+    }
+
+    void ensureCapacity(int vertices)
+    {
+        int capacity = geometry()->vertexCount();
+        if (vertices <= capacity) return;
+        while (capacity < vertices) capacity *= 2;
+        allocate(capacity);
+    }
+
+    QSGFlatColorMaterial m_material;
+    qsizetype m_consumed = 0;  // Points already turned into triangles
+    int m_used = 0;            // Vertices written
+};
+
+// Vertical phase marker lines, in pixels (few enough to rebuild whenever they change)
+class MarkerNode : public QSGGeometryNode {
+public:
+    MarkerNode()
+    {
+        setMaterial(&m_material);
+        setFlag(OwnsGeometry);
+        auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        setGeometry(geometry);
+    }
+
+    void setColor(const QColor& color)
+    {
+        if (m_material.color() != color) {
+            m_material.setColor(color);
+            markDirty(DirtyMaterial);
+        }
+    }
+
+    void setLines(const QVector<double>& xs, double width, double height)
+    {
+        geometry()->allocate(int(xs.size()) * VERTICES_PER_SEGMENT);
+        QSGGeometry::Point2D* v = geometry()->vertexDataAsPoint2D();
+        const float h = float(width / 2.0);
+        for (double x : xs) {
+            const float l = float(x) - h, r = float(x) + h, b = float(height);
+            v[0].set(l, 0); v[1].set(r, 0); v[2].set(l, b);
+            v[3].set(l, b); v[4].set(r, 0); v[5].set(r, b);
+            v += VERTICES_PER_SEGMENT;
+        }
+        markDirty(DirtyGeometry);
+    }
+
+private:
+    QSGFlatColorMaterial m_material;
+};
+
+enum FixedLine {
+    TemperatureGoalLine = 0,
+    TemperatureLine,
+    WeightLine,
+    FlowLine,
+    PressureLine,
+    FixedLineCount
+};
+
+class ChartNode : public QSGNode {
+public:
+    ChartNode()
+    {
+        appendChildNode(transform);
+        appendChildNode(frameMarkers);
+        appendChildNode(extractionMarker);
+        for (auto*& line : lines) {
+            line = new LineNode;
+            transform->appendChildNode(line);
+        }
+    }
+
+    LineNode* goalLine(QVector<LineNode*>& list, qsizetype segment)
+    {
+        while (list.size() <= segment) {
+            auto* line = new LineNode;
+            // Goal curves go underneath the actual curves
+            transform->prependChildNode(line);
+            list.append(line);
+        }
+        return list[segment];
+    }
+
+    void resetLines()
+    {
+        for (auto* line : lines) line->reset();
+        for (auto* line : pressureGoals) line->reset();
+        for (auto* line : flowGoals) line->reset();
+    }
+
+    QSGTransformNode* transform = new QSGTransformNode;
+    MarkerNode* frameMarkers = new MarkerNode;
+    MarkerNode* extractionMarker = new MarkerNode;
+    LineNode* lines[FixedLineCount] = {};
+    QVector<LineNode*> pressureGoals;
+    QVector<LineNode*> flowGoals;
+
+    double bakedScaleX = 0;
+    double bakedHeight = 0;
+    double markerScaleX = 0;
+    qsizetype markerCount = -1;
+};
+
+}  // namespace
+
+ShotChartItem::ShotChartItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    setClip(true);
+    connect(this, &ShotChartItem::appearanceChanged, this, &QQuickItem::update);
+}
+
+void ShotChartItem::setModel(ShotDataModel* model)
+{
+    if (m_model == model) return;
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    m_model = model;
+    if (m_model) {
+        // Every DE1 sample moves rawTime; scale samples can also arrive after the last one
+        connect(m_model, &ShotDataModel::rawTimeChanged, this, &QQuickItem::update);
+        connect(m_model, &ShotDataModel::weightDataChanged, this, &QQuickItem::update);
+        connect(m_model, &ShotDataModel::phaseMarkersChanged, this, &QQuickItem::update);
+        connect(m_model, &ShotDataModel::cleared, this, &ShotChartItem::onModelCleared);
+    }
+    m_rebuild = true;
+    update();
+    emit modelChanged();
+}
+
+void ShotChartItem::setTimeMax(double seconds)
+{
+    if (qFuzzyCompare(m_timeMax, seconds)) return;
+    m_timeMax = seconds;
+    update();
+    emit timeMaxChanged();
+}
+
+void ShotChartItem::setRange(double& field, double value)
+{
+    if (qFuzzyCompare(field, value)) return;
+    field = value;
+    m_rebuild = true;
+    update();
+    emit rangesChanged();
+}
+
+void ShotChartItem::setLineWidth(qreal width)
+{
+    if (qFuzzyCompare(m_lineWidth, width)) return;
+    m_lineWidth = width;
+    m_rebuild = true;
+    emit appearanceChanged();
+}
+
+void ShotChartItem::setGoalLineWidth(qreal width)
+{
+    if (qFuzzyCompare(m_goalLineWidth, width)) return;
+    m_goalLineWidth = width;
+    m_rebuild = true;
+    emit appearanceChanged();
+}
+
+void ShotChartItem::onModelCleared()
+{
+    m_rebuild = true;
+    update();
+}
+
+void ShotChartItem::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        update();
+    }
+}
+
+QSGNode* ShotChartItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    auto* root = static_cast<ChartNode*>(oldNode);
+    const double w = width();
+    const double h = height();
+    if (!m_model || w <= 0 || h <= 0) {
+        delete root;
+        return nullptr;
+    }
+    if (!root) {
+        root = new ChartNode;
+    }
+
+    // Data -> pixels: x = time * scaleX, y = h - normalized * h
+    const double scaleX = w / qMax(m_timeMax, 0.001);
+    QMatrix4x4 matrix;
+    matrix.translate(0, float(h));
+    matrix.scale(float(scaleX), float(-h));
+    root->transform->setMatrix(matrix);
+
+    // Baked line widths are only right near the scale they were built at
+    if (m_rebuild || h != root->bakedHeight
+        || qAbs(scaleX / root->bakedScaleX - 1.0) > SCALE_TOLERANCE) {
+        root->resetLines();
+        root->bakedScaleX = scaleX;
+        root->bakedHeight = h;
+        m_rebuild = false;
+    }
+    const double sx = root->bakedScaleX;
+
+    const ShotSampleStore& samples = m_model->samples();
+    auto sync = [&](LineNode* line, const ShotSeriesView& points, double yMin, double yMax,
+                    const QColor& color, double width) {
+        line->setColor(color);
+        line->sync(points, yMin, yMax, sx, h, width);
+    };
+
+    sync(root->lines[PressureLine], samples.series(ShotSampleStore::Pressure), 0, m_pressureMax,
+         m_pressureColor, m_lineWidth);
+    sync(root->lines[FlowLine], samples.series(ShotSampleStore::Flow), 0, m_pressureMax,
+         m_flowColor, m_lineWidth);
+    sync(root->lines[TemperatureLine], samples.series(ShotSampleStore::Temperature),
+         m_temperatureMin, m_temperatureMax, m_temperatureColor, m_lineWidth);
+    sync(root->lines[TemperatureGoalLine], samples.series(ShotSampleStore::TemperatureGoal),
+         m_temperatureMin, m_temperatureMax, m_temperatureGoalColor, m_goalLineWidth);
+    sync(root->lines[WeightLine], samples.weight(true), 0, m_weightMax, m_weightColor, m_lineWidth);
+
+    // One node per pump-mode segment keeps the breaks between goal lines
+    for (qsizetype i = 0; i < samples.goalSegmentCount(ShotSampleStore::PressureGoal); ++i) {
+        sync(root->goalLine(root->pressureGoals, i), samples.goalSegment(ShotSampleStore::PressureGoal, i),
+             0, m_pressureMax, m_pressureGoalColor, m_goalLineWidth);
+    }
+    for (qsizetype i = 0; i < samples.goalSegmentCount(ShotSampleStore::FlowGoal); ++i) {
+        sync(root->goalLine(root->flowGoals, i), samples.goalSegment(ShotSampleStore::FlowGoal, i),
+             0, m_pressureMax, m_flowGoalColor, m_goalLineWidth);
+    }
+    // Segment nodes left over from a previous shot with more mode switches
+    for (qsizetype i = samples.goalSegmentCount(ShotSampleStore::PressureGoal); i < root->pressureGoals.size(); ++i) {
+        root->pressureGoals[i]->reset();
+    }
+    for (qsizetype i = samples.goalSegmentCount(ShotSampleStore::FlowGoal); i < root->flowGoals.size(); ++i) {
+        root->flowGoals[i]->reset();
+    }
+
+    // Phase markers follow the live scale directly (pixel space, a handful of quads)
+    const QList<PhaseMarker>& markers = m_model->phaseMarkers();
+    root->frameMarkers->setColor(m_markerColor);
+    root->extractionMarker->setColor(m_extractionMarkerColor);
+    if (markers.size() != root->markerCount || scaleX != root->markerScaleX) {
+        QVector<double> frames, starts;
+        for (const PhaseMarker& marker : markers) {
+            (marker.label == QLatin1String("Start") ? starts : frames).append(marker.time * scaleX);
+        }
+        root->frameMarkers->setLines(frames, 1.0, h);
+        root->extractionMarker->setLines(starts, 2.0, h);
+        root->markerCount = markers.size();
+        root->markerScaleX = scaleX;
+    }
+
+    return root;
+}
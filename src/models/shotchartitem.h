@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QColor>
+#include <QPointer>
+#include <QQuickItem>
+
+class ShotDataModel;
+class QSGNode;
+
+/**
+ * Live shot chart rendered straight from ShotDataModel's sample store into
+ * scene graph geometry - a lightweight alternative to the QtCharts ShotGraph
+ * for low-end GPUs (Android tablets, Raspberry Pi) and iOS, where QtCharts
+ * falls back to rasterizing the whole chart on every update.
+ *
+ * Each curve is one QSGGeometryNode of thick-line triangles kept in data
+ * coordinates (time, normalized value) under a transform node, so a frame
+ * only appends the triangles of samples that arrived since the last frame and
+ * the growing time axis is just a new matrix. Line widths are baked in at the
+ * scale of the last rebuild; the curves are rebuilt once the horizontal scale
+ * drifts by more than SCALE_TOLERANCE (a few dozen times over a long shot).
+ *
+ * Goal curves are drawn thinner, one node per pump-mode segment, and phase
+ * markers as vertical lines. Axes, labels and the legend stay in QML.
+ */
+class ShotChartItem : public QQuickItem {
+    Q_OBJECT
+
+    Q_PROPERTY(ShotDataModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(double timeMax READ timeMax WRITE setTimeMax NOTIFY timeMaxChanged)
+    Q_PROPERTY(double pressureMax READ pressureMax WRITE setPressureMax NOTIFY rangesChanged)  // bar / mL/s axis, from 0
+    Q_PROPERTY(double temperatureMin READ temperatureMin WRITE setTemperatureMin NOTIFY rangesChanged)
+    Q_PROPERTY(double temperatureMax READ temperatureMax WRITE setTemperatureMax NOTIFY rangesChanged)
+    Q_PROPERTY(double weightMax READ weightMax WRITE setWeightMax NOTIFY rangesChanged)  // g axis, from 0
+    Q_PROPERTY(qreal lineWidth READ lineWidth WRITE setLineWidth NOTIFY appearanceChanged)
+    Q_PROPERTY(qreal goalLineWidth READ goalLineWidth WRITE setGoalLineWidth NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor pressureColor MEMBER m_pressureColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor flowColor MEMBER m_flowColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor temperatureColor MEMBER m_temperatureColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor weightColor MEMBER m_weightColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor pressureGoalColor MEMBER m_pressureGoalColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor flowGoalColor MEMBER m_flowGoalColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor temperatureGoalColor MEMBER m_temperatureGoalColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor markerColor MEMBER m_markerColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor extractionMarkerColor MEMBER m_extractionMarkerColor NOTIFY appearanceChanged)
+
+public:
+    explicit ShotChartItem(QQuickItem* parent = nullptr);
+
+    ShotDataModel* model() const { return m_model; }
+    void setModel(ShotDataModel* model);
+
+    double timeMax() const { return m_timeMax; }
+    void setTimeMax(double seconds);
+
+    double pressureMax() const { return m_pressureMax; }
+    void setPressureMax(double value) { setRange(m_pressureMax, value); }
+    double temperatureMin() const { return m_temperatureMin; }
+    void setTemperatureMin(double value) { setRange(m_temperatureMin, value); }
+    double temperatureMax() const { return m_temperatureMax; }
+    void setTemperatureMax(double value) { setRange(m_temperatureMax, value); }
+    double weightMax() const { return m_weightMax; }
+    void setWeightMax(double value) { setRange(m_weightMax, value); }
+
+    qreal lineWidth() const { return m_lineWidth; }
+    void setLineWidth(qreal width);
+    qreal goalLineWidth() const { return m_goalLineWidth; }
+    void setGoalLineWidth(qreal width);
+
+signals:
+    void modelChanged();
+    void timeMaxChanged();
+    void rangesChanged();
+    void appearanceChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
+private:
+    void setRange(double& field, double value);
+    void onModelCleared();
+
+    QPointer<ShotDataModel> m_model;
+    double m_timeMax = 5.0;
+    double m_pressureMax = 12.0;
+    double m_temperatureMin = 80.0;
+    double m_temperatureMax = 100.0;
+    double m_weightMax = 40.0;
+    qreal m_lineWidth = 3.0;
+    qreal m_goalLineWidth = 2.0;
+
+    // Defaults match Theme.qml; QML binds the live theme colors
+    QColor m_pressureColor = QColor(0x18, 0xc3, 0x7e);
+    QColor m_flowColor = QColor(0x4e, 0x85, 0xf4);
+    QColor m_temperatureColor = QColor(0xe7, 0x32, 0x49);
+    QColor m_weightColor = QColor(0xa2, 0x69, 0x3d);
+    QColor m_pressureGoalColor = QColor(0x69, 0xfd, 0xb3);
+    QColor m_flowGoalColor = QColor(0x7a, 0xaa, 0xff);
+    QColor m_temperatureGoalColor = QColor(0xff, 0xa5, 0xa6);
+    QColor m_markerColor = QColor(255, 255, 255, 102);
+    QColor m_extractionMarkerColor = QColor(0xe9, 0x45, 0x60);
+
+    // Set on the GUI thread, consumed in updatePaintNode: drop all geometry and rebuild
+    bool m_rebuild = true;
+
+    static constexpr double SCALE_TOLERANCE = 0.1;  // Relative x-scale change that triggers a rebuild
+};
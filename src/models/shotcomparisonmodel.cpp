@@ -1,8 +1,14 @@
 #include "shotcomparisonmodel.h"
+#include "seriesdecimator.h"
+#include "../history/shotmetrics.h"
 #include "../history/shothistorystorage.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QHash>
 #include <algorithm>
+#include <cmath>
 
 // Shot colors: Green, Blue, Orange
 const QList<QColor> ShotComparisonModel::SHOT_COLORS = {
@@ -20,11 +26,22 @@ const QList<QColor> ShotComparisonModel::SHOT_COLORS_LIGHT = {
 ShotComparisonModel::ShotComparisonModel(QObject* parent)
     : QObject(parent)
 {
+    m_cache.setMaxCost(CACHE_BUDGET_KB);
 }
 
 void ShotComparisonModel::setStorage(ShotHistoryStorage* storage)
 {
+    if (m_storage) {
+        disconnect(m_storage, nullptr, this, nullptr);
+    }
     m_storage = storage;
+    m_cache.clear();
+    m_cacheGeneration++;
+    if (m_storage) {
+        // Cached copies of edited or deleted shots must not be shown again
+        connect(m_storage, &ShotHistoryStorage::shotUpdated, this, &ShotComparisonModel::evictShot);
+        connect(m_storage, &ShotHistoryStorage::shotDeleted, this, &ShotComparisonModel::evictShot);
+    }
 }
 
 QVariantList ShotComparisonModel::shotsVariant() const
@@ -77,6 +94,14 @@ void ShotComparisonModel::clearAll()
 {
     m_shotIds.clear();
     m_displayShots.clear();
+    m_cache.clear();
+    m_cacheGeneration++;
+    m_overlayGeneration++;
+    m_overlay.clear();
+    m_overlayBusy = false;
+    m_alignedGeneration++;
+    m_aligned.clear();
+    m_alignedBusy = false;
     m_windowStart = 0;
     m_maxTime = 60.0;
     m_maxPressure = 12.0;
@@ -84,6 +109,7 @@ void ShotComparisonModel::clearAll()
     m_maxWeight = 50.0;
     emit shotsChanged();
     emit windowChanged();
+    emit overlayChanged();
 }
 
 void ShotComparisonModel::shiftWindowLeft()
@@ -141,44 +167,164 @@ void ShotComparisonModel::loadDisplayWindow()
         windowIds.append(m_shotIds[i]);
     }
 
-    QList<ShotRecord> records = m_storage->getShotsForComparison(windowIds);
-
-    for (const ShotRecord& record : records) {
-        ComparisonShot shot;
-        shot.id = record.summary.id;
-        shot.profileName = record.summary.profileName;
-        shot.beanBrand = record.summary.beanBrand;
-        shot.beanType = record.summary.beanType;
-        shot.roastDate = record.roastDate;
-        shot.roastLevel = record.roastLevel;
-        shot.grinderModel = record.grinderModel;
-        shot.grinderSetting = record.grinderSetting;
-        shot.duration = record.summary.duration;
-        shot.doseWeight = record.summary.doseWeight;
-        shot.finalWeight = record.summary.finalWeight;
-        shot.drinkTds = record.drinkTds;
-        shot.drinkEy = record.drinkEy;
-        shot.enjoyment = record.summary.enjoyment;
-        shot.timestamp = record.summary.timestamp;
-        shot.notes = record.espressoNotes;
-        shot.barista = record.barista;
-
-        shot.pressure = record.pressure;
-        shot.flow = record.flow;
-        shot.temperature = record.temperature;
-        shot.weight = record.weight;
-
-        for (const auto& phase : record.phases) {
-            ComparisonShot::PhaseMarker marker;
-            marker.time = phase.time;
-            marker.label = phase.label;
-            shot.phases.append(marker);
+    m_displayShots = loadShots(windowIds);
+
+    calculateMaxValues();
+    prefetchNeighbours();
+}
+
+QList<ShotComparisonModel::ComparisonShot> ShotComparisonModel::loadShots(const QList<qint64>& ids)
+{
+    // Only shots not seen before (shown or prefetched) come from the database
+    QList<qint64> missingIds;
+    for (qint64 id : ids) {
+        if (!m_cache.contains(id)) missingIds.append(id);
+    }
+    m_cacheHits += ids.size() - missingIds.size();
+    m_cacheMisses += missingIds.size();
+
+    QHash<qint64, ComparisonShot> loaded;
+    if (!missingIds.isEmpty() && m_storage) {
+        for (const ShotRecord& record : m_storage->getShotsForComparison(missingIds)) {
+            loaded.insert(record.summary.id, fromRecord(record));
         }
+    }
 
-        m_displayShots.append(shot);
+    QList<ComparisonShot> shots;
+    for (qint64 id : ids) {
+        // object() also marks the shot as most recently used
+        if (const ComparisonShot* cached = m_cache.object(id)) {
+            shots.append(*cached);
+        } else if (loaded.contains(id)) {
+            // Deleted shots have no record and are skipped, as before
+            const ComparisonShot& shot = loaded[id];
+            shots.append(shot);
+            m_cache.insert(id, new ComparisonShot(shot), costKb(shot));
+        }
     }
+    return shots;
+}
 
-    calculateMaxValues();
+void ShotComparisonModel::prefetchNeighbours()
+{
+    if (!m_storage) return;
+
+    // Nearest first, alternating sides, so a shift either way is covered first
+    const int shotCount = static_cast<int>(m_shotIds.size());
+    const int windowEnd = std::min(m_windowStart + DISPLAY_WINDOW_SIZE, shotCount);
+    QList<qint64> ids;
+    for (int distance = 1; distance <= PREFETCH_DISTANCE; ++distance) {
+        for (int i : { windowEnd - 1 + distance, m_windowStart - distance }) {
+            if (i < 0 || i >= shotCount) continue;
+            const qint64 id = m_shotIds[i];
+            if (m_cache.contains(id) || m_prefetching.contains(id)) continue;
+            ids.append(id);
+        }
+    }
+    if (ids.isEmpty()) return;
+
+    for (qint64 id : ids) m_prefetching.insert(id);
+    ShotHistoryStorage* storage = m_storage;
+    const int generation = m_cacheGeneration;
+
+    storage->runRead([storage, ids]() {
+        // Decode on the read pool too - the GUI thread only moves finished shots into the cache
+        QList<ComparisonShot> shots;
+        for (const ShotRecord& record : storage->getShotsForComparison(ids)) {
+            shots.append(fromRecord(record));
+        }
+        return shots;
+    }).then(this, [this, ids, generation](const QList<ComparisonShot>& shots) {
+        for (qint64 id : ids) m_prefetching.remove(id);
+        if (generation != m_cacheGeneration) return;  // Cleared or invalidated meanwhile
+        for (const ComparisonShot& shot : shots) {
+            if (m_cache.contains(shot.id)) continue;
+            m_cache.insert(shot.id, new ComparisonShot(shot), costKb(shot));
+            m_prefetched++;
+        }
+    });
+}
+
+void ShotComparisonModel::evictShot(qint64 shotId)
+{
+    m_cacheGeneration++;
+    m_cache.remove(shotId);
+
+    // A shown shot may have been evicted from the cache already - check the display on its own.
+    // Reloading picks up the edit, or drops the shot if it was deleted.
+    for (const ComparisonShot& shot : m_displayShots) {
+        if (shot.id == shotId) {
+            loadDisplayWindow();
+            emit shotsChanged();
+            return;
+        }
+    }
+}
+
+ShotComparisonModel::ComparisonShot ShotComparisonModel::fromRecord(const ShotRecord& record)
+{
+    ComparisonShot shot;
+    shot.id = record.summary.id;
+    shot.profileName = record.summary.profileName;
+    shot.beanBrand = record.summary.beanBrand;
+    shot.beanType = record.summary.beanType;
+    shot.roastDate = record.roastDate;
+    shot.roastLevel = record.roastLevel;
+    shot.grinderModel = record.grinderModel;
+    shot.grinderSetting = record.grinderSetting;
+    shot.duration = record.summary.duration;
+    shot.doseWeight = record.summary.doseWeight;
+    shot.finalWeight = record.summary.finalWeight;
+    shot.drinkTds = record.drinkTds;
+    shot.drinkEy = record.drinkEy;
+    shot.enjoyment = record.summary.enjoyment;
+    shot.timestamp = record.summary.timestamp;
+    shot.notes = record.espressoNotes;
+    shot.barista = record.barista;
+
+    shot.pressure = record.pressure;
+    shot.flow = record.flow;
+    shot.temperature = record.temperature;
+    shot.weight = record.weight;
+
+    for (const auto& phase : record.phases) {
+        ComparisonShot::PhaseMarker marker;
+        marker.time = phase.time;
+        marker.label = phase.label;
+        marker.frameNumber = phase.frameNumber;
+        shot.phases.append(marker);
+    }
+
+    return shot;
+}
+
+int ShotComparisonModel::costKb(const ComparisonShot& shot)
+{
+    qsizetype bytes = sizeof(ComparisonShot);
+    bytes += (shot.pressure.size() + shot.flow.size() + shot.temperature.size() + shot.weight.size())
+             * qsizetype(sizeof(QPointF));
+    for (const QString* text : { &shot.profileName, &shot.beanBrand, &shot.beanType, &shot.roastDate,
+                                 &shot.roastLevel, &shot.grinderModel, &shot.grinderSetting,
+                                 &shot.notes, &shot.barista }) {
+        bytes += text->size() * qsizetype(sizeof(QChar));
+    }
+    for (const auto& phase : shot.phases) {
+        bytes += qsizetype(sizeof(phase)) + phase.label.size() * qsizetype(sizeof(QChar));
+    }
+    return static_cast<int>(std::max<qsizetype>(1, (bytes + 1023) / 1024));
+}
+
+QVariantMap ShotComparisonModel::cacheStats() const
+{
+    QVariantMap result;
+    result["shots"] = static_cast<int>(m_cache.count());
+    result["costKb"] = static_cast<qint64>(m_cache.totalCost());
+    result["budgetKb"] = static_cast<qint64>(m_cache.maxCost());
+    result["hits"] = m_cacheHits;
+    result["misses"] = m_cacheMisses;
+    result["prefetched"] = m_prefetched;
+    result["prefetching"] = static_cast<int>(m_prefetching.size());
+    return result;
 }
 
 void ShotComparisonModel::calculateMaxValues()
@@ -217,10 +363,23 @@ void ShotComparisonModel::calculateMaxValues()
     }
 }
 
+void ShotComparisonModel::setViewportWidth(int pixels)
+{
+    if (pixels == m_viewportWidth) return;
+    m_viewportWidth = pixels;
+    emit shotsChanged();  // Graphs reload their curves at the new resolution
+}
+
 QVariantList ShotComparisonModel::pointsToVariant(const QVector<QPointF>& points) const
 {
+    // All shots share the time axis, so columns are laid out over [0, maxTime]
+    const QVector<QPointF> shown = SeriesDecimator::needed(points.size(), m_viewportWidth)
+        ? SeriesDecimator::minMax(points, 0.0, m_maxTime, m_viewportWidth)
+        : points;
+
     QVariantList result;
-    for (const auto& pt : points) {
+    result.reserve(shown.size());
+    for (const auto& pt : shown) {
         QVariantMap p;
         p["x"] = pt.x();
         p["y"] = pt.y();
@@ -267,6 +426,292 @@ QVariantList ShotComparisonModel::getPhaseMarkers(int index) const
     return result;
 }
 
+void ShotComparisonModel::computeAlignedCurves(const QString& channel, const QVariantMap& options)
+{
+    const int generation = ++m_alignedGeneration;
+    if (!m_storage || m_shotIds.isEmpty()) {
+        m_aligned.clear();
+        m_alignedBusy = false;
+        emit alignedChanged();
+        return;
+    }
+
+    const ShotAlignment::Anchor anchor = ShotAlignment::anchorFromString(options.value("anchor").toString());
+    const int frame = options.value("frame").toInt();
+    const double step = options.value("step", ShotAlignment::DEFAULT_STEP).toDouble();
+    const qint64 referenceId = options.value("referenceId",
+        m_displayShots.isEmpty() ? m_shotIds.first() : m_displayShots.first().id).toLongLong();
+    const double lowerPercentile = options.value("lowerPercentile", 10.0).toDouble();
+    const double upperPercentile = options.value("upperPercentile", 90.0).toDouble();
+    const QList<qint64> ids = m_shotIds;
+    ShotHistoryStorage* storage = m_storage;
+
+    // Cached shots go along as (implicitly shared) copies; only the others are read
+    QHash<qint64, ComparisonShot> cached;
+    QList<qint64> missingIds;
+    for (qint64 id : ids) {
+        if (const ComparisonShot* shot = m_cache.object(id)) {
+            cached.insert(id, *shot);
+        } else {
+            missingIds.append(id);
+        }
+    }
+
+    m_alignedBusy = true;
+    emit alignedChanged();
+
+    storage->runRead([storage, ids, cached, missingIds, channel, anchor, frame, step, referenceId,
+                      lowerPercentile, upperPercentile]() {
+        QHash<qint64, ComparisonShot> shotsById = cached;
+        if (!missingIds.isEmpty()) {
+            for (const ShotRecord& record : storage->getShotsForComparison(missingIds)) {
+                shotsById.insert(record.summary.id, fromRecord(record));
+            }
+        }
+
+        // Deleted shots have no record and are skipped
+        QVector<const QVector<QPointF>*> curves;
+        QVector<double> anchorTimes;
+        QVariantList shotIds, anchorFound;
+        int reference = -1;
+        for (qint64 id : ids) {
+            auto it = shotsById.constFind(id);
+            if (it == shotsById.constEnd()) continue;
+            bool found = false;
+            const double time = anchorTime(*it, anchor, frame, &found);
+
+            if (id == referenceId) reference = static_cast<int>(curves.size());
+            curves.append(&channelCurve(*it, channel));
+            anchorTimes.append(time);
+            shotIds.append(id);
+            anchorFound.append(found);
+        }
+
+        const ShotAlignment::Result aligned = ShotAlignment::align(curves, anchorTimes, step, reference,
+                                                                  lowerPercentile, upperPercentile);
+
+        auto rowsToVariant = [](const QVector<QVector<double>>& rows) {
+            QVariantList list;
+            list.reserve(rows.size());
+            for (const auto& row : rows) list.append(QVariant::fromValue(row));
+            return list;
+        };
+
+        QVariantMap result;
+        result["channel"] = channel;
+        result["anchor"] = ShotAlignment::anchorToString(anchor);
+        result["step"] = aligned.step;
+        result["shotIds"] = shotIds;
+        result["anchorTimes"] = QVariant::fromValue(anchorTimes);
+        result["anchorFound"] = anchorFound;
+        result["referenceId"] = reference >= 0 ? QVariant(referenceId) : QVariant();
+        result["lowerPercentile"] = lowerPercentile;
+        result["upperPercentile"] = upperPercentile;
+        result["time"] = QVariant::fromValue(aligned.time);
+        result["curves"] = rowsToVariant(aligned.rows);
+        result["delta"] = rowsToVariant(aligned.delta);
+        result["mean"] = QVariant::fromValue(aligned.mean);
+        result["min"] = QVariant::fromValue(aligned.min);
+        result["max"] = QVariant::fromValue(aligned.max);
+        result["median"] = QVariant::fromValue(aligned.median);
+        result["lower"] = QVariant::fromValue(aligned.lower);
+        result["upper"] = QVariant::fromValue(aligned.upper);
+        result["count"] = QVariant::fromValue(aligned.count);
+        return result;
+    }).then(this, [this, generation](const QVariantMap& result) {
+        if (generation != m_alignedGeneration) return;  // A newer request (or clearAll) won
+        m_aligned = result;
+        m_alignedBusy = false;
+        emit alignedChanged();
+    });
+}
+
+const QVector<QPointF>& ShotComparisonModel::channelCurve(const ComparisonShot& shot, const QString& channel)
+{
+    if (channel == QLatin1String("flow")) return shot.flow;
+    if (channel == QLatin1String("temperature")) return shot.temperature;
+    if (channel == QLatin1String("weight")) return shot.weight;
+    return shot.pressure;
+}
+
+double ShotComparisonModel::anchorTime(const ComparisonShot& shot, ShotAlignment::Anchor anchor, int frame,
+                                       bool* found)
+{
+    // Extraction start, else the first sample - as in ShotMetrics
+    double extractionStart = shot.pressure.isEmpty() ? 0.0 : shot.pressure.first().x();
+    bool hasStart = false;
+    for (const auto& phase : shot.phases) {
+        if (phase.label == QLatin1String("Start")) {
+            extractionStart = phase.time;
+            hasStart = true;
+            break;
+        }
+    }
+
+    // Shots without the event fall back to extraction start rather than dropping out
+    *found = hasStart;
+    switch (anchor) {
+    case ShotAlignment::ShotStart:
+        *found = true;
+        return 0.0;
+    case ShotAlignment::ExtractionStart:
+        break;
+    case ShotAlignment::FirstDrop:
+        *found = false;
+        for (const auto& pt : shot.weight) {
+            if (pt.x() >= extractionStart && pt.y() >= ShotMetrics::FIRST_DROP_WEIGHT) {
+                *found = true;
+                return pt.x();
+            }
+        }
+        break;
+    case ShotAlignment::FrameStart:
+        *found = false;
+        for (const auto& phase : shot.phases) {
+            if (phase.frameNumber == frame && phase.label != QLatin1String("Start")) {
+                *found = true;
+                return phase.time;
+            }
+        }
+        break;
+    }
+    return extractionStart;
+}
+
+int ShotComparisonModel::addShotsMatching(const QVariantMap& filter, int limit)
+{
+    if (!m_storage) {
+        emit errorOccurred("Storage not available");
+        return 0;
+    }
+
+    int added = 0;
+    for (const QVariant& summary : m_storage->getShotsFiltered(filter, 0, limit)) {
+        const qint64 id = summary.toMap().value("id").toLongLong();
+        if (id > 0 && !m_shotIds.contains(id)) {
+            m_shotIds.append(id);
+            added++;
+        }
+    }
+    if (added == 0) return 0;
+
+    std::sort(m_shotIds.begin(), m_shotIds.end());
+    loadDisplayWindow();
+    emit shotsChanged();
+    emit windowChanged();
+    return added;
+}
+
+void ShotComparisonModel::computeOverlay(const QString& channel, const QVariantMap& options)
+{
+    const int generation = ++m_overlayGeneration;
+    if (!m_storage || m_shotIds.isEmpty()) {
+        m_overlay.clear();
+        m_overlayBusy = false;
+        emit overlayChanged();
+        return;
+    }
+
+    const ShotAlignment::Anchor anchor = ShotAlignment::anchorFromString(options.value("anchor").toString());
+    const int frame = options.value("frame").toInt();
+    const double step = options.value("step", ShotAlignment::DEFAULT_STEP).toDouble();
+    const double lowerPercentile = options.value("lowerPercentile", 10.0).toDouble();
+    const double upperPercentile = options.value("upperPercentile", 90.0).toDouble();
+    const QList<qint64> ids = m_shotIds;
+    ShotHistoryStorage* storage = m_storage;
+
+    m_overlayBusy = true;
+    emit overlayChanged();
+
+    storage->runRead([storage, ids, channel, anchor, frame, step, lowerPercentile, upperPercentile]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // One batched read of the stored LOD level - a few hundred bytes per shot
+        QVector<ComparisonShot> shots;
+        for (const ShotRecord& record : storage->getShotsForComparison(ids, OVERLAY_POINTS)) {
+            shots.append(fromRecord(record));
+        }
+
+        QVector<const QVector<QPointF>*> curves;
+        QVector<double> anchors;
+        curves.reserve(shots.size());
+        anchors.reserve(shots.size());
+        for (const ComparisonShot& shot : shots) {
+            bool found = false;
+            anchors.append(anchorTime(shot, anchor, frame, &found));
+            curves.append(&channelCurve(shot, channel));
+        }
+        const ShotAlignment::Result aligned = ShotAlignment::align(curves, anchors, step, -1,
+                                                                  lowerPercentile, upperPercentile);
+
+        // Band floor scales with the channel: 5% of the median's peak (bar, ml/s, C or g)
+        double peak = 0;
+        for (double v : aligned.median) {
+            if (!std::isnan(v)) peak = std::max(peak, std::abs(v));
+        }
+        const QVector<double> scores = ShotAlignment::deviationScores(aligned, std::max(0.1, 0.05 * peak));
+
+        // Outliers by modified z-score (median / MAD of the scores), robust to the outliers themselves
+        QVector<double> sorted;
+        for (double score : scores) {
+            if (!std::isnan(score)) sorted.append(score);
+        }
+        QVariantList outliers;
+        if (sorted.size() >= 3) {
+            auto medianOf = [](QVector<double> values) {
+                std::sort(values.begin(), values.end());
+                const qsizetype mid = values.size() / 2;
+                return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+            };
+            const double medianScore = medianOf(sorted);
+            QVector<double> deviations;
+            for (double score : sorted) deviations.append(std::abs(score - medianScore));
+            const double mad = std::max(medianOf(deviations), 0.01);
+            for (qsizetype i = 0; i < scores.size(); ++i) {
+                if (0.6745 * (scores[i] - medianScore) / mad > OUTLIER_Z) {
+                    QVariantMap outlier;
+                    outlier["id"] = shots[i].id;
+                    outlier["score"] = scores[i];
+                    outlier["timestamp"] = shots[i].timestamp;
+                    outlier["curve"] = QVariant::fromValue(aligned.rows[i]);
+                    outliers.append(outlier);
+                }
+            }
+        }
+
+        QVariantList shotIds;
+        for (const ComparisonShot& shot : shots) shotIds.append(shot.id);
+
+        QVariantMap result;
+        result["channel"] = channel;
+        result["anchor"] = ShotAlignment::anchorToString(anchor);
+        result["shotCount"] = static_cast<int>(shots.size());
+        result["step"] = aligned.step;
+        result["lowerPercentile"] = lowerPercentile;
+        result["upperPercentile"] = upperPercentile;
+        result["time"] = QVariant::fromValue(aligned.time);
+        result["median"] = QVariant::fromValue(aligned.median);
+        result["lower"] = QVariant::fromValue(aligned.lower);
+        result["upper"] = QVariant::fromValue(aligned.upper);
+        result["mean"] = QVariant::fromValue(aligned.mean);
+        result["count"] = QVariant::fromValue(aligned.count);
+        result["shotIds"] = shotIds;
+        result["scores"] = QVariant::fromValue(scores);
+        result["outliers"] = outliers;
+        result["elapsedMs"] = timer.elapsed();
+        return result;
+    }).then(this, [this, generation](const QVariantMap& result) {
+        if (generation != m_overlayGeneration) return;  // A newer request (or clearAll) won
+        m_overlay = result;
+        m_overlayBusy = false;
+        qDebug() << "ShotComparisonModel: Overlay of" << result.value("shotCount").toInt() << "shots,"
+                 << result.value("outliers").toList().size() << "outliers, in"
+                 << result.value("elapsedMs").toLongLong() << "ms";
+        emit overlayChanged();
+    });
+}
+
 QVariantMap ShotComparisonModel::getShotInfo(int index) const
 {
     QVariantMap result;
@@ -1,15 +1,22 @@
 #pragma once
 
 #include <QObject>
+#include <QCache>
+#include <QSet>
 #include <QVector>
 #include <QPointF>
 #include <QVariantList>
 #include <QColor>
 
+#include "shotalignment.h"
+
 class ShotHistoryStorage;
 struct ShotRecord;
 
-// Model for comparing shots with sliding window display (shows 3 at a time)
+// Model for comparing shots with sliding window display (shows 3 at a time).
+// Decoded shots are kept in an LRU cache bounded by memory (CACHE_BUDGET_KB), and the
+// shots just outside the window are prefetched on the history read pool, so shifting
+// the window only touches the database for shots that were never shown or prefetched.
 class ShotComparisonModel : public QObject {
     Q_OBJECT
 
@@ -27,6 +34,17 @@ class ShotComparisonModel : public QObject {
     Q_PROPERTY(bool canShiftLeft READ canShiftLeft NOTIFY windowChanged)
     Q_PROPERTY(bool canShiftRight READ canShiftRight NOTIFY windowChanged)
 
+    // Plot width in pixels - curves are decimated to it (min/max per column); 0 = full resolution
+    Q_PROPERTY(int viewportWidth READ viewportWidth WRITE setViewportWidth NOTIFY shotsChanged)
+
+    // Overlay mode: all selected shots as a median with percentile bands (see computeOverlay)
+    Q_PROPERTY(QVariantMap overlay READ overlay NOTIFY overlayChanged)
+    Q_PROPERTY(bool overlayBusy READ overlayBusy NOTIFY overlayChanged)
+
+    // Time-aligned curves of the selection with deltas and envelope (see computeAlignedCurves)
+    Q_PROPERTY(QVariantMap aligned READ aligned NOTIFY alignedChanged)
+    Q_PROPERTY(bool alignedBusy READ alignedBusy NOTIFY alignedChanged)
+
 public:
     explicit ShotComparisonModel(QObject* parent = nullptr);
 
@@ -43,6 +61,9 @@ public:
     double maxFlow() const { return m_maxFlow; }
     double maxWeight() const { return m_maxWeight; }
 
+    int viewportWidth() const { return m_viewportWidth; }
+    void setViewportWidth(int pixels);
+
     // Window navigation
     int windowStart() const { return m_windowStart; }
     bool canShiftLeft() const { return m_windowStart > 0; }
@@ -52,6 +73,9 @@ public:
     Q_INVOKABLE bool addShot(qint64 shotId);
     Q_INVOKABLE void removeShot(qint64 shotId);
     Q_INVOKABLE void clearAll();
+    // Add up to limit shots matching filter (same keys as getShotsFiltered), newest first.
+    // Returns how many were new to the selection.
+    Q_INVOKABLE int addShotsMatching(const QVariantMap& filter, int limit = 50);
     Q_INVOKABLE bool hasShotId(qint64 shotId) const;
 
     // Window navigation (shift by 1 shot at a time)
@@ -73,13 +97,47 @@ public:
     Q_INVOKABLE QColor getShotColor(int index) const;
     Q_INVOKABLE QColor getShotColorLight(int index) const;  // For goal/secondary lines
 
+    // All selected shots resampled onto one time grid, aligned on a common event.
+    // channel: "pressure", "flow", "temperature" or "weight". options:
+    //   anchor: "extractionStart" (default), "firstDrop", "frame" (with frame: N), "start"
+    //   step: grid spacing in s (0.1), referenceId: shot the deltas are taken against
+    //   (first shot of the display window), lowerPercentile/upperPercentile (10/90)
+    // Cached shots are used as they are; the rest are read and the curves aligned on the
+    // history read pool, without going into the cache (a large selection would evict the
+    // window and its prefetched neighbours). The result lands in aligned: columnar number
+    // arrays (NaN where a shot has no data): time, curves and delta (one array per shot, in
+    // shotIds order), mean, median, min, max, lower, upper and count, plus shotIds,
+    // anchorTimes, anchorFound, referenceId and the step actually used.
+    Q_INVOKABLE void computeAlignedCurves(const QString& channel, const QVariantMap& options = QVariantMap());
+    QVariantMap aligned() const { return m_aligned; }
+    bool alignedBusy() const { return m_alignedBusy; }
+
+    // Overlay of every selected shot, however many: one batched read of the LOD curves
+    // (OVERLAY_POINTS per shot), aligned and reduced on the history read pool, so cost grows
+    // linearly with the shot count and nothing per shot crosses into QML except outliers.
+    // channel and options as computeAlignedCurves (median is always included). The result lands in
+    // overlay: time, median, lower, upper, mean, count, shotIds and per-shot scores (mean
+    // distance from the median in band widths), plus outliers - [{ id, score, curve }] for
+    // shots whose score is far above the rest (modified z-score > OUTLIER_Z).
+    Q_INVOKABLE void computeOverlay(const QString& channel = QStringLiteral("pressure"),
+                                    const QVariantMap& options = QVariantMap());
+    QVariantMap overlay() const { return m_overlay; }
+    bool overlayBusy() const { return m_overlayBusy; }
+
+    // Cached shots, their estimated size (KB) against the budget, hits/misses/prefetches
+    Q_INVOKABLE QVariantMap cacheStats() const;
+
 signals:
     void shotsChanged();
     void windowChanged();
     void errorOccurred(const QString& message);
+    void overlayChanged();
+    void alignedChanged();
 
 private:
     void loadDisplayWindow();
+    void prefetchNeighbours();
+    void evictShot(qint64 shotId);
     void calculateMaxValues();
     QVariantList pointsToVariant(const QVector<QPointF>& points) const;
 
@@ -110,10 +168,19 @@ private:
         struct PhaseMarker {
             double time = 0;
             QString label;
+            int frameNumber = 0;
         };
         QList<PhaseMarker> phases;
     };
 
+    // Shots in ids order, from the cache or (one batch query for the rest) the database
+    QList<ComparisonShot> loadShots(const QList<qint64>& ids);
+    static ComparisonShot fromRecord(const ShotRecord& record);
+    static int costKb(const ComparisonShot& shot);  // Estimated memory footprint
+    static const QVector<QPointF>& channelCurve(const ComparisonShot& shot, const QString& channel);
+    // Absolute time of the anchor event; found = false when the shot falls back to extraction start
+    static double anchorTime(const ComparisonShot& shot, ShotAlignment::Anchor anchor, int frame, bool* found);
+
     ShotHistoryStorage* m_storage = nullptr;
     QList<qint64> m_shotIds;              // All selected shot IDs (chronological order)
     QList<ComparisonShot> m_displayShots; // Currently displayed shots (max 3)
@@ -123,8 +190,29 @@ private:
     double m_maxPressure = 12.0;
     double m_maxFlow = 8.0;
     double m_maxWeight = 50.0;
+    int m_viewportWidth = 0;
+
+    // LRU of decoded shots, cost in KB
+    QCache<qint64, ComparisonShot> m_cache;
+    QSet<qint64> m_prefetching;       // Shot IDs being loaded on the read pool
+    int m_cacheGeneration = 0;        // Bumped on clearAll so late prefetches are dropped
+    qint64 m_cacheHits = 0;
+    qint64 m_cacheMisses = 0;
+    qint64 m_prefetched = 0;
+
+    QVariantMap m_overlay;
+    bool m_overlayBusy = false;
+    int m_overlayGeneration = 0;      // Results of superseded computeOverlay calls are dropped
+
+    QVariantMap m_aligned;
+    bool m_alignedBusy = false;
+    int m_alignedGeneration = 0;      // Results of superseded computeAlignedCurves calls are dropped
 
     static constexpr int DISPLAY_WINDOW_SIZE = 3;
+    static constexpr int PREFETCH_DISTANCE = 2;      // Shots prefetched on each side of the window
+    static constexpr int CACHE_BUDGET_KB = 16 * 1024;
+    static constexpr int OVERLAY_POINTS = 256;       // Per-shot curve detail (a stored LOD level)
+    static constexpr double OUTLIER_Z = 3.5;
     static const QList<QColor> SHOT_COLORS;
     static const QList<QColor> SHOT_COLORS_LIGHT;
 };
@@ -1,34 +1,16 @@
 #include "shotdatamodel.h"
+#include "seriesdecimator.h"
+#include "../history/shotjournal.h"
 #include <QDebug>
 
 ShotDataModel::ShotDataModel(QObject* parent)
     : QObject(parent)
+    , m_samples(INITIAL_CAPACITY)  // Pre-allocate columns to avoid reallocations during shot
 {
-    // Pre-allocate vectors to avoid reallocations during shot
-    m_pressurePoints.reserve(INITIAL_CAPACITY);
-    m_flowPoints.reserve(INITIAL_CAPACITY);
-    m_temperaturePoints.reserve(INITIAL_CAPACITY);
-    m_temperatureGoalPoints.reserve(INITIAL_CAPACITY);
-    m_weightPoints.reserve(INITIAL_CAPACITY);
-    m_cumulativeWeightPoints.reserve(INITIAL_CAPACITY);
-
-    // Initialize first segments for goal curves
-    m_pressureGoalSegments.append(QVector<QPointF>());
-    m_pressureGoalSegments[0].reserve(INITIAL_CAPACITY);
-    m_flowGoalSegments.append(QVector<QPointF>());
-    m_flowGoalSegments[0].reserve(INITIAL_CAPACITY);
-
-    // Timer for batched chart updates at 30fps
-    m_flushTimer = new QTimer(this);
-    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
-    m_flushTimer->setTimerType(Qt::PreciseTimer);
-    connect(m_flushTimer, &QTimer::timeout, this, &ShotDataModel::flushToChart);
 }
 
 ShotDataModel::~ShotDataModel() {
-    if (m_flushTimer) {
-        m_flushTimer->stop();
-    }
+    setGraphWindow(nullptr);
 }
 
 void ShotDataModel::registerSeries(QLineSeries* pressure, QLineSeries* flow, QLineSeries* temperature,
@@ -84,42 +66,25 @@ void ShotDataModel::registerSeries(QLineSeries* pressure, QLineSeries* flow, QLi
     qDebug() << "ShotDataModel: Registered series (OpenGL disabled for Windows debug)";
 #endif
 
+    // New series start empty - the next flush fills them with a full replace()
+    resetFlushState();
+
     // If we have existing data (e.g., viewing a just-completed shot on a new page),
     // immediately populate the new series with that data
-    if (!m_pressurePoints.isEmpty() || !m_flowPoints.isEmpty() || !m_weightPoints.isEmpty()) {
+    if (!m_samples.isEmpty() || m_samples.weightSize() > 0) {
         qDebug() << "ShotDataModel: Populating new series with existing data ("
-                 << m_pressurePoints.size() << " pressure points,"
-                 << m_flowPoints.size() << " flow points,"
-                 << m_weightPoints.size() << " weight points)";
+                 << m_samples.size() << " samples,"
+                 << m_samples.weightSize() << " weight points)";
         m_dirty = true;
         flushToChart();
     }
-
-    // Start the flush timer
-    m_flushTimer->start();
 }
 
 void ShotDataModel::clear() {
-    // Stop timer during clear
-    m_flushTimer->stop();
-
-    // Clear data vectors (keep capacity)
-    m_pressurePoints.clear();
-    m_flowPoints.clear();
-    m_temperaturePoints.clear();
-    m_temperatureGoalPoints.clear();
-    m_weightPoints.clear();
-    m_cumulativeWeightPoints.clear();
+    // Clear sample columns and goal segments (keeps capacity for the next shot)
+    m_samples.clear();
     m_pendingMarkers.clear();
 
-    // Reset goal segments - keep first segment with capacity
-    m_pressureGoalSegments.clear();
-    m_pressureGoalSegments.append(QVector<QPointF>());
-    m_pressureGoalSegments[0].reserve(INITIAL_CAPACITY);
-    m_flowGoalSegments.clear();
-    m_flowGoalSegments.append(QVector<QPointF>());
-    m_flowGoalSegments[0].reserve(INITIAL_CAPACITY);
-
     // Clear chart series
     if (m_pressureSeries) m_pressureSeries->clear();
     if (m_flowSeries) m_flowSeries->clear();
@@ -146,66 +111,46 @@ void ShotDataModel::clear() {
     m_rawTime = 0.0;
     m_lastPumpModeIsFlow = false;
     m_hasPumpModeData = false;
-    m_currentPressureGoalSegment = 0;
-    m_currentFlowGoalSegment = 0;
     m_dirty = false;
+    resetFlushState();
 
     emit cleared();
     emit phaseMarkersChanged();
     emit maxTimeChanged();
     emit rawTimeChanged();
-
-    // Restart timer
-    m_flushTimer->start();
 }
 
 void ShotDataModel::clearWeightData() {
     // Clear any pre-tare weight samples (race condition fix)
-    m_weightPoints.clear();
-    m_cumulativeWeightPoints.clear();
+    m_samples.clearWeight();
     if (m_weightSeries) {
         m_weightSeries->clear();
     }
+    m_weightFlushed = SeriesFlush();
+    if (m_journal) {
+        m_journal->appendWeightReset();
+    }
+    emit weightDataChanged();
     qDebug() << "ShotDataModel: Cleared pre-tare weight data";
 }
 
 void ShotDataModel::addSample(double time, double pressure, double flow, double temperature,
                               double pressureGoal, double flowGoal, double temperatureGoal,
                               int frameNumber, bool isFlowMode) {
-    Q_UNUSED(frameNumber);
-
-    // Pure vector append - no signals, no chart updates
-    m_pressurePoints.append(QPointF(time, pressure));
-    m_flowPoints.append(QPointF(time, flow));
-    m_temperaturePoints.append(QPointF(time, temperature));
-
-    // Start new segments when pump mode changes (creates visual gap in goal curves)
-    if (m_hasPumpModeData && isFlowMode != m_lastPumpModeIsFlow) {
-        if (isFlowMode) {
-            // Switching to flow mode: start new pressure goal segment
-            m_currentPressureGoalSegment++;
-            if (m_currentPressureGoalSegment >= m_pressureGoalSegments.size()) {
-                m_pressureGoalSegments.append(QVector<QPointF>());
-            }
-        } else {
-            // Switching to pressure mode: start new flow goal segment
-            m_currentFlowGoalSegment++;
-            if (m_currentFlowGoalSegment >= m_flowGoalSegments.size()) {
-                m_flowGoalSegments.append(QVector<QPointF>());
-            }
-        }
+    if (m_journal) {
+        m_journal->appendSample(time, pressure, flow, temperature,
+                                pressureGoal, flowGoal, temperatureGoal, frameNumber, isFlowMode);
     }
+
+    // Start new segments when pump mode changes (creates visual gap in goal curves):
+    // switching to flow mode ends the pressure goal line and vice versa
+    bool modeChanged = m_hasPumpModeData && isFlowMode != m_lastPumpModeIsFlow;
     m_lastPumpModeIsFlow = isFlowMode;
     m_hasPumpModeData = true;
 
-    // Add goal points to current segments
-    if (pressureGoal > 0) {
-        m_pressureGoalSegments[m_currentPressureGoalSegment].append(QPointF(time, pressureGoal));
-    }
-    if (flowGoal > 0) {
-        m_flowGoalSegments[m_currentFlowGoalSegment].append(QPointF(time, flowGoal));
-    }
-    m_temperatureGoalPoints.append(QPointF(time, temperatureGoal));
+    // Pure column append - no signals, no chart updates. Goals <= 0 are not stored.
+    m_samples.append(time, pressure, flow, temperature, pressureGoal, flowGoal, temperatureGoal,
+                     modeChanged && isFlowMode, modeChanged && !isFlowMode);
 
     // Update raw time - QML uses this to calculate axis max with pixel-based padding
     if (time > m_rawTime) {
@@ -213,7 +158,7 @@ void ShotDataModel::addSample(double time, double pressure, double flow, double
         emit rawTimeChanged();
     }
 
-    m_dirty = true;
+    requestFlush();
 }
 
 void ShotDataModel::addWeightSample(double time, double weight, double flowRate) {
@@ -236,24 +181,28 @@ void ShotDataModel::addWeightSample(double time, double weight) {
     if (++sampleCount % 10 == 1) {
         qDebug() << "[REFACTOR] ShotDataModel::addWeightSample: time=" << QString::number(time, 'f', 2)
                  << "weight=" << QString::number(weight, 'f', 2)
-                 << "totalPoints=" << m_weightPoints.size();
+                 << "totalPoints=" << m_samples.weightSize();
     }
 
-    // Store cumulative weight for export (visualizer, shot history)
-    m_cumulativeWeightPoints.append(QPointF(time, weight));
-
-    // Add initial zero point when weight curve starts (so line starts from zero at correct time)
-    if (m_weightPoints.isEmpty()) {
-        m_weightPoints.append(QPointF(time, 0.0));
-        qDebug() << "[REFACTOR] ShotDataModel: Added initial zero point at time=" << time;
+    if (m_samples.weightSize() == 0) {
+        qDebug() << "[REFACTOR] ShotDataModel: Weight curve starts at time=" << time;
     }
 
-    // Plot cumulative weight (g) - shows weight progression during shot (0g -> 36g typical)
-    m_weightPoints.append(QPointF(time, weight));
-    m_dirty = true;
+    // Cumulative weight (g) for export and graph - the graph view adds a zero point at the
+    // first sample's time so the line starts from zero (0g -> 36g typical)
+    m_samples.appendWeight(time, weight);
+    if (m_journal) {
+        m_journal->appendWeight(time, weight);
+    }
+    emit weightDataChanged();
+    requestFlush();
 }
 
 void ShotDataModel::markExtractionStart(double time) {
+    if (m_journal) {
+        m_journal->appendExtractionStart(time);
+    }
+
     m_pendingMarkers.append({time, "Start"});
 
     PhaseMarker marker;
@@ -262,11 +211,15 @@ void ShotDataModel::markExtractionStart(double time) {
     marker.frameNumber = 0;
     m_phaseMarkers.append(marker);
 
-    m_dirty = true;
+    requestFlush();
     emit phaseMarkersChanged();
 }
 
 void ShotDataModel::addPhaseMarker(double time, const QString& label, int frameNumber, bool isFlowMode) {
+    if (m_journal) {
+        m_journal->appendPhaseMarker(time, label, frameNumber, isFlowMode);
+    }
+
     m_pendingMarkers.append({time, label});
 
     PhaseMarker marker;
@@ -276,45 +229,121 @@ void ShotDataModel::addPhaseMarker(double time, const QString& label, int frameN
     marker.isFlowMode = isFlowMode;
     m_phaseMarkers.append(marker);
 
-    m_dirty = true;
+    requestFlush();
     emit phaseMarkersChanged();
 }
 
-void ShotDataModel::flushToChart() {
-    if (!m_dirty) return;
+void ShotDataModel::setViewportWidth(int pixels) {
+    if (pixels == m_viewportWidth) return;
+    m_viewportWidth = pixels;
+    // Rebuild every series at the new resolution on the next flush
+    resetFlushState();
+    requestFlush();
+    emit viewportWidthChanged();
+}
 
-    // Batch update all series with replace() - single redraw per series
-    if (m_pressureSeries && !m_pressurePoints.isEmpty()) {
-        m_pressureSeries->replace(m_pressurePoints);
+void ShotDataModel::setGraphWindow(QQuickWindow* window) {
+    if (m_graphWindow == window) return;
+    if (m_graphWindow) {
+        disconnect(m_graphWindow, &QQuickWindow::afterAnimating, this, &ShotDataModel::flushToChart);
     }
-    if (m_flowSeries && !m_flowPoints.isEmpty()) {
-        m_flowSeries->replace(m_flowPoints);
-    }
-    if (m_temperatureSeries && !m_temperaturePoints.isEmpty()) {
-        m_temperatureSeries->replace(m_temperaturePoints);
+    m_graphWindow = window;
+    m_frameRequested = false;
+    if (m_graphWindow) {
+        // afterAnimating runs on the GUI thread just before the frame is synced,
+        // so series changed here are in that same frame
+        connect(m_graphWindow, &QQuickWindow::afterAnimating, this, &ShotDataModel::flushToChart);
+        if (m_dirty) {
+            // Catch up on samples that arrived while the graph was hidden
+            requestFlush();
+        }
     }
+    emit graphWindowChanged();
+}
 
-    // Update pressure goal segments - each segment gets its own LineSeries
-    for (int i = 0; i < m_pressureGoalSegments.size() && i < m_pressureGoalSeriesList.size(); ++i) {
-        if (m_pressureGoalSeriesList[i] && !m_pressureGoalSegments[i].isEmpty()) {
-            m_pressureGoalSeriesList[i]->replace(m_pressureGoalSegments[i]);
-        }
+void ShotDataModel::requestFlush() {
+    m_dirty = true;
+    if (m_graphWindow && !m_frameRequested) {
+        m_frameRequested = true;
+        m_graphWindow->update();
     }
+}
 
-    // Update flow goal segments - each segment gets its own LineSeries
-    for (int i = 0; i < m_flowGoalSegments.size() && i < m_flowGoalSeriesList.size(); ++i) {
-        if (m_flowGoalSeriesList[i] && !m_flowGoalSegments[i].isEmpty()) {
-            m_flowGoalSeriesList[i]->replace(m_flowGoalSegments[i]);
+void ShotDataModel::syncSeries(QLineSeries* series, const ShotSeriesView& points, SeriesFlush* state,
+                               int viewportWidth) {
+    if (!series || points.size() == state->flushed) return;
+
+    if (SeriesDecimator::needed(points.size(), viewportWidth) &&
+        points.last().x() > points.first().x()) {
+        // Long sessions: a peak-preserving reduction in fixed-width time columns. Finished
+        // columns stay in the series; only the open last column is recomputed, then appended to.
+        // Once the shot spans twice the columns the viewport shows, rebuild at the new width.
+        const double span = points.last().x() - points.first().x();
+        QVector<QPointF> reduced;
+        qsizetype openOutput = 0;
+        if (state->columnWidth <= 0 || state->flushed > points.size() ||
+            span > state->columnWidth * viewportWidth * 2) {
+            state->origin = points.first().x();
+            state->columnWidth = span / viewportWidth;
+            state->openStart = SeriesDecimator::minMaxColumns(points, 0, state->origin, state->columnWidth,
+                                                              &reduced, &openOutput);
+            series->replace(reduced);
+            state->committed = openOutput;
+        } else {
+            state->openStart = SeriesDecimator::minMaxColumns(points, state->openStart, state->origin,
+                                                              state->columnWidth, &reduced, &openOutput);
+            const int stale = series->count() - static_cast<int>(state->committed);
+            if (stale > 0) series->removePoints(static_cast<int>(state->committed), stale);
+            series->append(reduced);
+            state->committed += openOutput;
         }
+    } else if (state->flushed == 0 || state->flushed > points.size() || state->columnWidth > 0) {
+        // First fill after registration/clear (or data was reset underneath): one redraw
+        *state = SeriesFlush();
+        series->replace(points.toVector());
+    } else {
+        // Steady state: cost proportional to the new points only, not the whole shot
+        series->append(points.toVector(state->flushed));
     }
+    state->flushed = points.size();
+}
 
-    if (m_temperatureGoalSeries && !m_temperatureGoalPoints.isEmpty()) {
-        m_temperatureGoalSeries->replace(m_temperatureGoalPoints);
+void ShotDataModel::resetFlushState() {
+    m_pressureFlushed = SeriesFlush();
+    m_flowFlushed = SeriesFlush();
+    m_temperatureFlushed = SeriesFlush();
+    m_pressureGoalFlushed.clear();
+    m_flowGoalFlushed.clear();
+    m_temperatureGoalFlushed = SeriesFlush();
+    m_weightFlushed = SeriesFlush();
+}
+
+void ShotDataModel::flushToChart() {
+    m_frameRequested = false;
+    if (!m_dirty) return;
+
+    // Append only what arrived since the last flush - each series redraws once
+    syncSeries(m_pressureSeries, pressureData(), &m_pressureFlushed, m_viewportWidth);
+    syncSeries(m_flowSeries, flowData(), &m_flowFlushed, m_viewportWidth);
+    syncSeries(m_temperatureSeries, temperatureData(), &m_temperatureFlushed, m_viewportWidth);
+
+    // Goal segments - each segment gets its own LineSeries
+    const qsizetype pressureSegments = m_samples.goalSegmentCount(ShotSampleStore::PressureGoal);
+    m_pressureGoalFlushed.resize(pressureSegments);
+    for (int i = 0; i < pressureSegments && i < m_pressureGoalSeriesList.size(); ++i) {
+        syncSeries(m_pressureGoalSeriesList[i], m_samples.goalSegment(ShotSampleStore::PressureGoal, i),
+                   &m_pressureGoalFlushed[i], m_viewportWidth);
     }
-    if (m_weightSeries && !m_weightPoints.isEmpty()) {
-        m_weightSeries->replace(m_weightPoints);
+    const qsizetype flowSegments = m_samples.goalSegmentCount(ShotSampleStore::FlowGoal);
+    m_flowGoalFlushed.resize(flowSegments);
+    for (int i = 0; i < flowSegments && i < m_flowGoalSeriesList.size(); ++i) {
+        syncSeries(m_flowGoalSeriesList[i], m_samples.goalSegment(ShotSampleStore::FlowGoal, i),
+                   &m_flowGoalFlushed[i], m_viewportWidth);
     }
 
+    syncSeries(m_temperatureGoalSeries, temperatureGoalData(), &m_temperatureGoalFlushed, m_viewportWidth);
+    syncSeries(m_weightSeries, weightData(), &m_weightFlushed, m_viewportWidth);
+
     // Process pending vertical markers
     for (const auto& marker : m_pendingMarkers) {
         if (marker.second == "Start") {
@@ -351,21 +380,3 @@ QVariantList ShotDataModel::phaseMarkersVariant() const {
     }
     return result;
 }
-
-QVector<QPointF> ShotDataModel::pressureGoalData() const {
-    // Combine all segments for export
-    QVector<QPointF> combined;
-    for (const auto& segment : m_pressureGoalSegments) {
-        combined.append(segment);
-    }
-    return combined;
-}
-
-QVector<QPointF> ShotDataModel::flowGoalData() const {
-    // Combine all segments for export
-    QVector<QPointF> combined;
-    for (const auto& segment : m_flowGoalSegments) {
-        combined.append(segment);
-    }
-    return combined;
-}
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <QObject>
-#include <QTimer>
+#include <QQuickWindow>
 #include <QVector>
 #include <QPointF>
 #include <QPointer>
 #include <QVariantList>
 #include <QtCharts/QLineSeries>
 
+#include "shotsamplestore.h"
+
+class ShotJournal;
+
 struct PhaseMarker {
     double time;
     QString label;
@@ -21,6 +25,8 @@ class ShotDataModel : public QObject {
     Q_PROPERTY(QVariantList phaseMarkers READ phaseMarkersVariant NOTIFY phaseMarkersChanged)
     Q_PROPERTY(double maxTime READ maxTime NOTIFY maxTimeChanged)
     Q_PROPERTY(double rawTime READ rawTime NOTIFY rawTimeChanged)
+    Q_PROPERTY(int viewportWidth READ viewportWidth WRITE setViewportWidth NOTIFY viewportWidthChanged)
+    Q_PROPERTY(QQuickWindow* graphWindow READ graphWindow WRITE setGraphWindow NOTIFY graphWindowChanged)
 
 public:
     explicit ShotDataModel(QObject* parent = nullptr);
@@ -28,7 +34,19 @@ public:
 
     double maxTime() const { return m_maxTime; }
     double rawTime() const { return m_rawTime; }
+
+    // Plot width in pixels - series with more points than it can show are decimated (min/max per column)
+    int viewportWidth() const { return m_viewportWidth; }
+    void setViewportWidth(int pixels);
+
+    // Window showing the registered series while it is visible, else null. Flushes run from its
+    // afterAnimating signal, one per rendered frame, and only request a frame when there is new
+    // data - so nothing wakes up while the graph is hidden or no samples arrive (idle machine).
+    QQuickWindow* graphWindow() const { return m_graphWindow; }
+    void setGraphWindow(QQuickWindow* window);
+
     QVariantList phaseMarkersVariant() const;
+    const QList<PhaseMarker>& phaseMarkers() const { return m_phaseMarkers; }
 
     // Register chart series - C++ takes ownership of updating them
     Q_INVOKABLE void registerSeries(QLineSeries* pressure, QLineSeries* flow, QLineSeries* temperature,
@@ -37,15 +55,20 @@ public:
                                      QLineSeries* weight, QLineSeries* extractionMarker,
                                      const QVariantList& frameMarkers);
 
-    // Data export for visualizer upload
-    const QVector<QPointF>& pressureData() const { return m_pressurePoints; }
-    const QVector<QPointF>& flowData() const { return m_flowPoints; }
-    const QVector<QPointF>& temperatureData() const { return m_temperaturePoints; }
-    QVector<QPointF> pressureGoalData() const;  // Combines all segments
-    QVector<QPointF> flowGoalData() const;      // Combines all segments
-    const QVector<QPointF>& temperatureGoalData() const { return m_temperatureGoalPoints; }
-    const QVector<QPointF>& weightData() const { return m_weightPoints; }  // Cumulative weight (g) for graph
-    const QVector<QPointF>& cumulativeWeightData() const { return m_cumulativeWeightPoints; }  // Cumulative weight for export
+    // Crash-safe journal - every ingested sample is also appended here while it is open
+    void setJournal(ShotJournal* journal) { m_journal = journal; }
+
+    // Data export (visualizer upload, history, AI) - views over the sample store, no copies.
+    // A view is invalidated by the next sample; copy samples() to keep a snapshot.
+    const ShotSampleStore& samples() const { return m_samples; }
+    ShotSeriesView pressureData() const { return m_samples.series(ShotSampleStore::Pressure); }
+    ShotSeriesView flowData() const { return m_samples.series(ShotSampleStore::Flow); }
+    ShotSeriesView temperatureData() const { return m_samples.series(ShotSampleStore::Temperature); }
+    ShotSeriesView pressureGoalData() const { return m_samples.goal(ShotSampleStore::PressureGoal); }  // All segments
+    ShotSeriesView flowGoalData() const { return m_samples.goal(ShotSampleStore::FlowGoal); }          // All segments
+    ShotSeriesView temperatureGoalData() const { return m_samples.series(ShotSampleStore::TemperatureGoal); }
+    ShotSeriesView weightData() const { return m_samples.weight(true); }  // Cumulative weight (g) for graph, starts at 0 g
+    ShotSeriesView cumulativeWeightData() const { return m_samples.weight(); }  // Cumulative weight for export
 
 public slots:
     void clear();
@@ -64,21 +87,35 @@ signals:
     void cleared();
     void maxTimeChanged();
     void rawTimeChanged();
+    void viewportWidthChanged();
+    void graphWindowChanged();
     void phaseMarkersChanged();
+    void weightDataChanged();  // Scale sample appended or weight cleared (rawTime only follows DE1 samples)
 
 private slots:
-    void flushToChart();  // Called by timer - batched update to chart
+    void flushToChart();  // Called once per frame of graphWindow - batched update to chart
 
 private:
-    // Data storage - fast vector appends
-    QVector<QPointF> m_pressurePoints;
-    QVector<QPointF> m_flowPoints;
-    QVector<QPointF> m_temperaturePoints;
-    QVector<QVector<QPointF>> m_pressureGoalSegments;  // Separate segments for clean breaks
-    QVector<QVector<QPointF>> m_flowGoalSegments;      // Separate segments for clean breaks
-    QVector<QPointF> m_temperatureGoalPoints;
-    QVector<QPointF> m_weightPoints;  // Cumulative weight (g) - for graphing
-    QVector<QPointF> m_cumulativeWeightPoints;  // Cumulative weight (g) - for export
+    // What a series already shows, so a flush only pushes what is new
+    struct SeriesFlush {
+        qsizetype flushed = 0;      // Source points already synced
+        // While decimating: fixed columns of columnWidth seconds from origin. 'committed' points
+        // in the series belong to finished columns; the open column starts at source openStart.
+        double origin = 0;
+        double columnWidth = 0;     // 0 = not decimating
+        qsizetype openStart = 0;
+        qsizetype committed = 0;
+    };
+
+    // Push points added since the last flush; full replace() when the series is new or was cleared.
+    // While the series has more points than viewportWidth can show it holds a min/max reduction,
+    // extended incrementally by recomputing only the last (open) column.
+    static void syncSeries(QLineSeries* series, const ShotSeriesView& points, SeriesFlush* state, int viewportWidth);
+    void resetFlushState();
+    void requestFlush();  // Mark dirty and ask graphWindow for a frame (coalesced)
+
+    // Data storage - one time column, a float column per channel, goal segments as index ranges
+    ShotSampleStore m_samples;
 
     // Chart series pointers (QPointer auto-nulls when QML destroys them)
     QPointer<QLineSeries> m_pressureSeries;
@@ -91,22 +128,32 @@ private:
     QPointer<QLineSeries> m_extractionMarkerSeries;
     QList<QPointer<QLineSeries>> m_frameMarkerSeries;
 
-    // Batched update timer (30fps)
-    QTimer* m_flushTimer = nullptr;
+    ShotJournal* m_journal = nullptr;
+
+    // Frame-driven batched updates
+    QPointer<QQuickWindow> m_graphWindow;
     bool m_dirty = false;
+    bool m_frameRequested = false;
+
+    // Points already in each series, so a flush only appends what is new
+    SeriesFlush m_pressureFlushed;
+    SeriesFlush m_flowFlushed;
+    SeriesFlush m_temperatureFlushed;
+    QVector<SeriesFlush> m_pressureGoalFlushed;  // Per segment
+    QVector<SeriesFlush> m_flowGoalFlushed;      // Per segment
+    SeriesFlush m_temperatureGoalFlushed;
+    SeriesFlush m_weightFlushed;
 
     double m_maxTime = 5.0;
     double m_rawTime = 0.0;
+    int m_viewportWidth = 0;  // 0 = never decimate
     int m_frameMarkerIndex = 0;
     bool m_lastPumpModeIsFlow = false;  // Track for starting new goal segments
     bool m_hasPumpModeData = false;     // True after first sample with pump mode
-    int m_currentPressureGoalSegment = 0;  // Current segment index
-    int m_currentFlowGoalSegment = 0;      // Current segment index
 
     // Phase markers for QML labels
     QList<PhaseMarker> m_phaseMarkers;
     QList<QPair<double, QString>> m_pendingMarkers;  // Pending vertical lines
 
-    static constexpr int FLUSH_INTERVAL_MS = 33;  // ~30fps
     static constexpr int INITIAL_CAPACITY = 600;  // Pre-allocate for 2min at 5Hz
 };
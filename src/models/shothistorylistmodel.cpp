@@ -0,0 +1,210 @@
+#include "shothistorylistmodel.h"
+
+#include <QDebug>
+#include <algorithm>
+
+ShotHistoryListModel::ShotHistoryListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void ShotHistoryListModel::setStorage(ShotHistoryStorage* storage)
+{
+    if (m_storage == storage) return;
+    if (m_storage) {
+        disconnect(m_storage, nullptr, this, nullptr);
+    }
+    m_storage = storage;
+    if (m_storage) {
+        // Saved or deleted shots shift the keyset pages - start over
+        connect(m_storage, &ShotHistoryStorage::shotSaved, this, &ShotHistoryListModel::refresh);
+        connect(m_storage, &ShotHistoryStorage::shotDeleted, this, &ShotHistoryListModel::refresh);
+        // Edits keep the shot's place (timestamp), so only that row changes
+        connect(m_storage, &ShotHistoryStorage::shotUpdated, this, &ShotHistoryListModel::refreshShot);
+    }
+    emit storageChanged();
+    refresh();
+}
+
+void ShotHistoryListModel::setFilter(const QVariantMap& filter)
+{
+    // Always reloads, so assigning the same filter again refreshes the list
+    const bool changed = filter != m_filter;
+    m_filter = filter;
+    if (changed) emit filterChanged();
+    refresh();
+}
+
+void ShotHistoryListModel::setPageSize(int size)
+{
+    size = qMax(1, size);
+    if (size == m_pageSize) return;
+    m_pageSize = size;
+    emit pageSizeChanged();
+}
+
+int ShotHistoryListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant ShotHistoryListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) return QVariant();
+
+    const HistoryShotSummary& shot = m_rows[index.row()];
+    switch (role) {
+    case IdRole: return shot.id;
+    case UuidRole: return shot.uuid;
+    case TimestampRole: return shot.timestamp;
+    case DateTimeRole: return ShotHistoryStorage::formatShotDateTime(shot.timestamp);
+    case Qt::DisplayRole:
+    case ProfileNameRole: return shot.profileName;
+    case DurationRole: return shot.duration;
+    case FinalWeightRole: return shot.finalWeight;
+    case DoseWeightRole: return shot.doseWeight;
+    case BeanBrandRole: return shot.beanBrand;
+    case BeanTypeRole: return shot.beanType;
+    case EnjoymentRole: return shot.enjoyment;
+    case HasVisualizerUploadRole: return shot.hasVisualizerUpload;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ShotHistoryListModel::roleNames() const
+{
+    return {
+        { IdRole, "id" },
+        { UuidRole, "uuid" },
+        { TimestampRole, "timestamp" },
+        { DateTimeRole, "dateTime" },
+        { ProfileNameRole, "profileName" },
+        { DurationRole, "duration" },
+        { FinalWeightRole, "finalWeight" },
+        { DoseWeightRole, "doseWeight" },
+        { BeanBrandRole, "beanBrand" },
+        { BeanTypeRole, "beanType" },
+        { EnjoymentRole, "enjoyment" },
+        { HasVisualizerUploadRole, "hasVisualizerUpload" },
+    };
+}
+
+bool ShotHistoryListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && !m_loading && hasMore();
+}
+
+void ShotHistoryListModel::fetchMore(const QModelIndex& parent)
+{
+    if (canFetchMore(parent)) {
+        requestPage(m_nextCursor);
+    }
+}
+
+void ShotHistoryListModel::refresh()
+{
+    m_generation++;  // Drop pages of the previous query still in flight
+    m_reset = true;
+    m_loading = false;
+    requestPage(QString());
+}
+
+void ShotHistoryListModel::loadMore()
+{
+    fetchMore(QModelIndex());
+}
+
+qint64 ShotHistoryListModel::shotIdAt(int row) const
+{
+    return row >= 0 && row < m_rows.size() ? m_rows[row].id : 0;
+}
+
+QVariantList ShotHistoryListModel::shotIds() const
+{
+    QVariantList ids;
+    ids.reserve(m_rows.size());
+    for (const HistoryShotSummary& shot : m_rows) {
+        ids.append(shot.id);
+    }
+    return ids;
+}
+
+void ShotHistoryListModel::refreshShot(qint64 shotId)
+{
+    if (!m_storage) return;
+    auto loaded = std::find_if(m_rows.cbegin(), m_rows.cend(),
+                               [shotId](const HistoryShotSummary& shot) { return shot.id == shotId; });
+    if (loaded == m_rows.cend()) return;  // Not paged in yet - it's read fresh when it is
+
+    ShotHistoryStorage* storage = m_storage;
+    const QVariantMap filter = m_filter;
+    const int generation = m_generation;
+
+    struct Row {
+        bool matches = false;
+        HistoryShotSummary summary;
+    };
+    storage->runRead([storage, filter, shotId]() {
+        Row row;
+        row.matches = storage->getShotSummary(filter, shotId, &row.summary);
+        return row;
+    }).then(this, [this, generation, shotId](const Row& row) {
+        if (generation != m_generation) return;  // The list was reloaded meanwhile
+
+        for (int i = 0; i < m_rows.size(); ++i) {
+            if (m_rows[i].id != shotId) continue;
+            if (row.matches) {
+                m_rows[i] = row.summary;
+                emit dataChanged(index(i), index(i));
+            } else {
+                // The edit took it out of the filter (or it was deleted meanwhile)
+                beginRemoveRows(QModelIndex(), i, i);
+                m_rows.removeAt(i);
+                endRemoveRows();
+                emit countChanged();
+            }
+            return;
+        }
+    });
+}
+
+void ShotHistoryListModel::requestPage(const QString& cursor)
+{
+    if (!m_storage) return;
+
+    m_loading = true;
+    emit loadingChanged();
+
+    ShotHistoryStorage* storage = m_storage;
+    const QVariantMap filter = m_filter;
+    const int limit = m_pageSize;
+    const int generation = m_generation;
+
+    struct Page {
+        QList<HistoryShotSummary> rows;
+        QString nextCursor;
+    };
+    storage->runRead([storage, filter, cursor, limit]() {
+        Page page;
+        page.rows = storage->getShotSummariesPage(filter, cursor, limit, &page.nextCursor);
+        return page;
+    }).then(this, [this, generation](const Page& page) {
+        if (generation != m_generation) return;
+
+        if (m_reset) {
+            beginResetModel();
+            m_rows = page.rows;
+            endResetModel();
+            m_reset = false;
+        } else if (!page.rows.isEmpty()) {
+            const int first = static_cast<int>(m_rows.size());
+            beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.rows.size()) - 1);
+            m_rows.append(page.rows);
+            endInsertRows();
+        }
+        m_nextCursor = page.nextCursor;
+        m_loading = false;
+        emit countChanged();
+        emit loadingChanged();
+    });
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QVariantMap>
+
+#include "../history/shothistorystorage.h"
+
+/**
+ * Shot history list for QML views, newest first, one typed HistoryShotSummary
+ * per row instead of a QVariantMap per shot.
+ *
+ * Rows are read a keyset page at a time (getShotSummariesPage) on the history
+ * read pool; views pull further pages through canFetchMore()/fetchMore() or
+ * loadMore(). Setting filter (same keys as getShotsFiltered, including
+ * searchText) reloads from the first page; the old rows stay until it arrives.
+ * Role names match the getShotsPage keys, so delegates read model.id,
+ * model.profileName, model.dateTime, ...
+ */
+class ShotHistoryListModel : public QAbstractListModel {
+    Q_OBJECT
+
+    Q_PROPERTY(ShotHistoryStorage* storage READ storage WRITE setStorage NOTIFY storageChanged)
+    Q_PROPERTY(QVariantMap filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool hasMore READ hasMore NOTIFY loadingChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        UuidRole,
+        TimestampRole,
+        DateTimeRole,
+        ProfileNameRole,
+        DurationRole,
+        FinalWeightRole,
+        DoseWeightRole,
+        BeanBrandRole,
+        BeanTypeRole,
+        EnjoymentRole,
+        HasVisualizerUploadRole
+    };
+
+    explicit ShotHistoryListModel(QObject* parent = nullptr);
+
+    ShotHistoryStorage* storage() const { return m_storage; }
+    void setStorage(ShotHistoryStorage* storage);
+    QVariantMap filter() const { return m_filter; }
+    void setFilter(const QVariantMap& filter);
+    int pageSize() const { return m_pageSize; }
+    void setPageSize(int size);
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+    bool hasMore() const { return !m_reset && !m_nextCursor.isEmpty(); }
+    bool loading() const { return m_loading; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    Q_INVOKABLE void refresh();   // Reload from the first page with the current filter
+    Q_INVOKABLE void loadMore();  // Next page, if any and none is loading
+    Q_INVOKABLE qint64 shotIdAt(int row) const;
+    Q_INVOKABLE QVariantList shotIds() const;  // Loaded rows, in order
+
+signals:
+    void storageChanged();
+    void filterChanged();
+    void pageSizeChanged();
+    void countChanged();
+    void loadingChanged();
+
+private:
+    void requestPage(const QString& cursor);
+    void refreshShot(qint64 shotId);  // Re-read one edited row in place
+
+    QPointer<ShotHistoryStorage> m_storage;
+    QVariantMap m_filter;
+    int m_pageSize = 50;
+
+    QList<HistoryShotSummary> m_rows;
+    QString m_nextCursor;      // Empty when the last page is loaded
+    bool m_reset = true;       // The next page replaces the rows (first page of a new query)
+    bool m_loading = false;
+    int m_generation = 0;      // Pages of a superseded query are dropped
+};
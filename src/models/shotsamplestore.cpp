@@ -0,0 +1,124 @@
+#include "shotsamplestore.h"
+
+QVector<QPointF> ShotSeriesView::toVector(qsizetype from, qsizetype length) const
+{
+    const qsizetype total = size();
+    if (from < 0) from = 0;
+    if (from > total) from = total;
+    if (length < 0 || from + length > total) length = total - from;
+
+    QVector<QPointF> points;
+    points.reserve(length);
+    for (qsizetype i = from; i < from + length; ++i) {
+        points.append(QPointF(x(i), y(i)));
+    }
+    return points;
+}
+
+ShotSampleStore::ShotSampleStore(qsizetype capacity)
+{
+    reserve(capacity);
+    clear();
+}
+
+void ShotSampleStore::reserve(qsizetype capacity)
+{
+    if (capacity <= 0) return;
+
+    m_times.reserve(capacity);
+    for (auto& column : m_columns) {
+        column.reserve(capacity);
+    }
+    for (int g = 0; g < GoalCount; ++g) {
+        m_goalRows[g].reserve(capacity);
+        m_goalValues[g].reserve(capacity);
+    }
+    m_weightTimes.reserve(capacity);
+    m_weights.reserve(capacity);
+}
+
+void ShotSampleStore::clear()
+{
+    // QVector::clear() keeps the allocation unless it is shared
+    m_times.clear();
+    for (auto& column : m_columns) {
+        column.clear();
+    }
+    for (int g = 0; g < GoalCount; ++g) {
+        m_goalRows[g].clear();
+        m_goalValues[g].clear();
+        m_goalSegmentStarts[g].clear();
+        m_goalSegmentStarts[g].append(0);  // There is always a first (possibly empty) segment
+    }
+    clearWeight();
+}
+
+void ShotSampleStore::clearWeight()
+{
+    m_weightTimes.clear();
+    m_weights.clear();
+}
+
+void ShotSampleStore::append(double time, float pressure, float flow, float temperature,
+                             float pressureGoal, float flowGoal, float temperatureGoal,
+                             bool startPressureGoalSegment, bool startFlowGoalSegment)
+{
+    const qint32 row = static_cast<qint32>(m_times.size());
+    m_times.append(time);
+    m_columns[Pressure].append(pressure);
+    m_columns[Flow].append(flow);
+    m_columns[Temperature].append(temperature);
+    m_columns[TemperatureGoal].append(temperatureGoal);
+
+    const bool startSegment[GoalCount] = { startPressureGoalSegment, startFlowGoalSegment };
+    const float goalValue[GoalCount] = { pressureGoal, flowGoal };
+    for (int g = 0; g < GoalCount; ++g) {
+        if (startSegment[g]) {
+            m_goalSegmentStarts[g].append(m_goalValues[g].size());
+        }
+        if (goalValue[g] > 0) {
+            m_goalRows[g].append(row);
+            m_goalValues[g].append(goalValue[g]);
+        }
+    }
+}
+
+void ShotSampleStore::appendWeight(double time, float weight)
+{
+    m_weightTimes.append(time);
+    m_weights.append(weight);
+}
+
+ShotSeriesView ShotSampleStore::series(Channel channel) const
+{
+    return ShotSeriesView(m_times.constData(), nullptr, m_columns[channel].constData(), m_times.size());
+}
+
+ShotSeriesView ShotSampleStore::goal(Goal goal) const
+{
+    return ShotSeriesView(m_times.constData(), m_goalRows[goal].constData(),
+                          m_goalValues[goal].constData(), m_goalValues[goal].size());
+}
+
+ShotSampleStore::Range ShotSampleStore::goalSegmentRange(Goal goal, qsizetype segment) const
+{
+    const auto& starts = m_goalSegmentStarts[goal];
+    if (segment < 0 || segment >= starts.size()) {
+        return { 0, 0 };
+    }
+    qsizetype end = segment + 1 < starts.size() ? starts[segment + 1] : m_goalValues[goal].size();
+    return { starts[segment], end };
+}
+
+ShotSeriesView ShotSampleStore::goalSegment(Goal goal, qsizetype segment) const
+{
+    Range range = goalSegmentRange(goal, segment);
+    return ShotSeriesView(m_times.constData(), m_goalRows[goal].constData() + range.begin,
+                          m_goalValues[goal].constData() + range.begin, range.end - range.begin);
+}
+
+ShotSeriesView ShotSampleStore::weight(bool leadingZero) const
+{
+    return ShotSeriesView(m_weightTimes.constData(), nullptr, m_weights.constData(),
+                          m_weightTimes.size(), leadingZero);
+}
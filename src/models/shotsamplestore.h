@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+#include <cmath>
+#include <iterator>
+
+/**
+ * Read-only view of one channel of a ShotSampleStore as (time, value) points.
+ *
+ * Behaves like a const QVector<QPointF> for reading (size, operator[], last,
+ * range-for) but builds each QPointF on the fly from the store's columns, so
+ * consumers walk the live data without copying it. Goal channels are sparse:
+ * they index the shared time column through a row column. The view is only
+ * valid until the store is next modified.
+ */
+class ShotSeriesView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = QPointF;
+        using difference_type = qsizetype;
+        using pointer = void;
+        using reference = QPointF;
+
+        const_iterator() = default;
+        const_iterator(const ShotSeriesView* view, qsizetype index) : m_view(view), m_index(index) {}
+
+        QPointF operator*() const { return (*m_view)[m_index]; }
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++m_index; return old; }
+        const_iterator& operator--() { --m_index; return *this; }
+        const_iterator& operator+=(qsizetype n) { m_index += n; return *this; }
+        const_iterator operator+(qsizetype n) const { return const_iterator(m_view, m_index + n); }
+        qsizetype operator-(const const_iterator& other) const { return m_index - other.m_index; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const ShotSeriesView* m_view = nullptr;
+        qsizetype m_index = 0;
+    };
+
+    ShotSeriesView() = default;
+    ShotSeriesView(const double* times, const qint32* rows, const float* values, qsizetype count,
+                   bool leadingZero = false)
+        : m_times(times), m_rows(rows), m_values(values), m_count(count)
+        , m_leadingZero(leadingZero && count > 0) {}
+
+    qsizetype size() const { return m_count + (m_leadingZero ? 1 : 0); }
+    bool isEmpty() const { return size() == 0; }
+
+    double x(qsizetype i) const {
+        if (m_leadingZero && i-- == 0) i = 0;
+        return m_times[m_rows ? m_rows[i] : i];
+    }
+    double y(qsizetype i) const {
+        if (m_leadingZero && i-- == 0) return 0.0;
+        return widen(m_values[i]);
+    }
+
+    QPointF operator[](qsizetype i) const { return QPointF(x(i), y(i)); }
+    QPointF at(qsizetype i) const { return (*this)[i]; }
+    QPointF first() const { return (*this)[0]; }
+    QPointF last() const { return (*this)[size() - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // Materialize points [from, from + length) - for APIs that need a QList (QLineSeries, ShotRecord)
+    QVector<QPointF> toVector(qsizetype from = 0, qsizetype length = -1) const;
+
+    // Values are stored as float; widen back at the 0.001 resolution the history
+    // codec keeps so exports print clean decimals instead of float noise
+    static double widen(float value) { return std::round(double(value) * 1000.0) / 1000.0; }
+
+private:
+    const double* m_times = nullptr;
+    const qint32* m_rows = nullptr;   // Row into m_times per point (sparse goal channels), or null
+    const float* m_values = nullptr;
+    qsizetype m_count = 0;
+    bool m_leadingZero = false;       // Synthetic (first time, 0) point before the data
+};
+
+/**
+ * Structure-of-arrays sample storage for the live shot.
+ *
+ * DE1 samples share one time column with a float column per channel. The
+ * pressure/flow goals only exist while positive, so they are kept compact with a
+ * row index into the time column, and their pump-mode segments (separate chart
+ * lines) are index ranges into that compact column rather than separate vectors.
+ * Scale samples arrive on their own clock and get their own time column.
+ *
+ * Columns are pre-sized and clear() keeps capacity, so one store is reused
+ * for every shot without reallocating. Copies share the columns (Qt implicit
+ * sharing), which lets a consumer keep a snapshot alive cheaply.
+ */
+class ShotSampleStore {
+public:
+    enum Channel {
+        Pressure = 0,
+        Flow,
+        Temperature,
+        TemperatureGoal,
+        ChannelCount
+    };
+
+    enum Goal {
+        PressureGoal = 0,
+        FlowGoal,
+        GoalCount
+    };
+
+    struct Range {
+        qsizetype begin;
+        qsizetype end;
+    };
+
+    explicit ShotSampleStore(qsizetype capacity = 0);
+
+    void reserve(qsizetype capacity);
+    void clear();        // Drop all samples, keep capacity
+    void clearWeight();  // Drop scale samples only (tare)
+
+    // Append one DE1 sample. Goals <= 0 are not stored; startPressureGoalSegment /
+    // startFlowGoalSegment open a new segment before this sample's goal point.
+    void append(double time, float pressure, float flow, float temperature,
+                float pressureGoal, float flowGoal, float temperatureGoal,
+                bool startPressureGoalSegment, bool startFlowGoalSegment);
+    void appendWeight(double time, float weight);
+
+    qsizetype size() const { return m_times.size(); }
+    bool isEmpty() const { return m_times.isEmpty(); }
+    qsizetype weightSize() const { return m_weightTimes.size(); }
+
+    // Raw columns
+    const QVector<double>& times() const { return m_times; }
+    const QVector<float>& column(Channel channel) const { return m_columns[channel]; }
+    const QVector<double>& weightTimes() const { return m_weightTimes; }
+    const QVector<float>& weights() const { return m_weights; }
+
+    // Point views over the columns
+    ShotSeriesView series(Channel channel) const;
+    ShotSeriesView goal(Goal goal) const;                        // All segments, in order
+    ShotSeriesView goalSegment(Goal goal, qsizetype segment) const;
+    qsizetype goalSegmentCount(Goal goal) const { return m_goalSegmentStarts[goal].size(); }
+    Range goalSegmentRange(Goal goal, qsizetype segment) const;
+    ShotSeriesView weight(bool leadingZero = false) const;      // leadingZero: graph starts from 0 g
+
+private:
+    QVector<double> m_times;
+    QVector<float> m_columns[ChannelCount];
+
+    QVector<qint32> m_goalRows[GoalCount];
+    QVector<float> m_goalValues[GoalCount];
+    QVector<qsizetype> m_goalSegmentStarts[GoalCount];  // Index into m_goalValues where each segment begins
+
+    QVector<double> m_weightTimes;
+    QVector<float> m_weights;
+};
@@ -0,0 +1,129 @@
+#include "shotseries.h"
+#include "../history/shothistorystorage.h"
+
+#include <QDebug>
+
+ShotSeries::ShotSeries(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void ShotSeries::setStorage(ShotHistoryStorage* storage)
+{
+    if (m_storage == storage) return;
+    m_storage = storage;
+    emit storageChanged();
+    reload();
+}
+
+void ShotSeries::setShotId(qint64 shotId)
+{
+    if (m_shotId == shotId) return;
+    m_shotId = shotId;
+    emit shotIdChanged();
+    reload();
+}
+
+void ShotSeries::setMaxPoints(int maxPoints)
+{
+    maxPoints = qMax(0, maxPoints);
+    if (m_maxPoints == maxPoints) return;
+    m_maxPoints = maxPoints;
+    emit maxPointsChanged();
+    reload();
+}
+
+const QVector<QPointF>* ShotSeries::curve(const QString& channel) const
+{
+    if (channel == QLatin1String("pressure")) return &m_pressure;
+    if (channel == QLatin1String("flow")) return &m_flow;
+    if (channel == QLatin1String("temperature")) return &m_temperature;
+    if (channel == QLatin1String("weight")) return &m_weight;
+    if (channel == QLatin1String("pressureGoal")) return &m_pressureGoal;
+    if (channel == QLatin1String("flowGoal")) return &m_flowGoal;
+    if (channel == QLatin1String("temperatureGoal")) return &m_temperatureGoal;
+    return nullptr;
+}
+
+bool ShotSeries::fill(QXYSeries* series, const QString& channel, double yScale) const
+{
+    if (!series) return false;
+
+    const QVector<QPointF>* points = curve(channel);
+    if (!points) {
+        qWarning() << "ShotSeries: unknown channel" << channel;
+        series->clear();
+        return false;
+    }
+
+    if (yScale == 1.0) {
+        series->replace(*points);
+        return true;
+    }
+    QVector<QPointF> scaled;
+    scaled.reserve(points->size());
+    for (const QPointF& pt : *points) {
+        scaled.append(QPointF(pt.x(), pt.y() * yScale));
+    }
+    series->replace(scaled);
+    return true;
+}
+
+void ShotSeries::reload()
+{
+    const int generation = ++m_generation;
+
+    if (!m_storage || m_shotId <= 0) {
+        m_pressure.clear();
+        m_flow.clear();
+        m_temperature.clear();
+        m_weight.clear();
+        m_pressureGoal.clear();
+        m_flowGoal.clear();
+        m_temperatureGoal.clear();
+        m_maxTime = m_maxWeight = 0;
+        if (m_loading) {
+            m_loading = false;
+            emit loadingChanged();
+        }
+        emit loaded();
+        return;
+    }
+
+    if (!m_loading) {
+        m_loading = true;
+        emit loadingChanged();
+    }
+
+    ShotHistoryStorage* storage = m_storage;
+    const QList<qint64> ids{ m_shotId };
+    const int maxPoints = m_maxPoints;
+    storage->runRead([storage, ids, maxPoints]() {
+        const QList<ShotRecord> records = storage->getShotsForComparison(ids, maxPoints);
+        return records.isEmpty() ? ShotRecord() : records.first();
+    }).then(this, [this, generation](const ShotRecord& record) {
+        if (generation != m_generation) return;
+
+        if (record.summary.id == 0) {
+            qWarning() << "ShotSeries: shot" << m_shotId << "not found";
+        }
+        m_pressure = record.pressure;
+        m_flow = record.flow;
+        m_temperature = record.temperature;
+        m_weight = record.weight;
+        m_pressureGoal = record.pressureGoal;
+        m_flowGoal = record.flowGoal;
+        m_temperatureGoal = record.temperatureGoal;
+
+        m_maxTime = record.summary.duration;
+        if (!m_pressure.isEmpty()) m_maxTime = qMax(m_maxTime, m_pressure.last().x());
+        m_maxWeight = 0;
+        for (const QPointF& pt : std::as_const(m_weight)) {
+            m_maxWeight = qMax(m_maxWeight, pt.y());
+        }
+
+        m_loading = false;
+        emit loadingChanged();
+        emit loaded();
+    });
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QPointF>
+#include <QVector>
+#include <QtCharts/QXYSeries>
+
+class ShotHistoryStorage;
+
+/**
+ * Curves of one stored shot, kept as typed point arrays for charts.
+ *
+ * getShot() hands QML a map per sample point, which the chart then walks and
+ * appends one point at a time. ShotSeries reads the shot on the history read
+ * pool (getShotsForComparison, from the LOD pyramid when maxPoints allows) and
+ * fill() pushes a channel into a LineSeries with a single replace(), so no
+ * per-point JS objects are ever created.
+ */
+class ShotSeries : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(ShotHistoryStorage* storage READ storage WRITE setStorage NOTIFY storageChanged)
+    Q_PROPERTY(qint64 shotId READ shotId WRITE setShotId NOTIFY shotIdChanged)
+    Q_PROPERTY(int maxPoints READ maxPoints WRITE setMaxPoints NOTIFY maxPointsChanged)  // 0 = full resolution
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+    Q_PROPERTY(bool empty READ isEmpty NOTIFY loaded)
+    Q_PROPERTY(double maxTime READ maxTime NOTIFY loaded)
+    Q_PROPERTY(double maxWeight READ maxWeight NOTIFY loaded)
+
+public:
+    explicit ShotSeries(QObject* parent = nullptr);
+
+    ShotHistoryStorage* storage() const { return m_storage; }
+    void setStorage(ShotHistoryStorage* storage);
+    qint64 shotId() const { return m_shotId; }
+    void setShotId(qint64 shotId);
+    int maxPoints() const { return m_maxPoints; }
+    void setMaxPoints(int maxPoints);
+
+    bool loading() const { return m_loading; }
+    bool isEmpty() const { return m_pressure.isEmpty() && m_weight.isEmpty(); }
+    double maxTime() const { return m_maxTime; }
+    double maxWeight() const { return m_maxWeight; }
+
+    // Replace the series' points with a channel ("pressure", "flow", "temperature",
+    // "weight", "pressureGoal", "flowGoal", "temperatureGoal"), y multiplied by yScale.
+    // Returns false (and clears the series) for an unknown channel.
+    Q_INVOKABLE bool fill(QXYSeries* series, const QString& channel, double yScale = 1.0) const;
+
+    const QVector<QPointF>* curve(const QString& channel) const;
+
+signals:
+    void storageChanged();
+    void shotIdChanged();
+    void maxPointsChanged();
+    void loadingChanged();
+    void loaded();
+
+private:
+    void reload();
+
+    QPointer<ShotHistoryStorage> m_storage;
+    qint64 m_shotId = 0;
+    int m_maxPoints = 0;
+    bool m_loading = false;
+    int m_generation = 0;  // Results for a superseded shotId are dropped
+
+    QVector<QPointF> m_pressure;
+    QVector<QPointF> m_flow;
+    QVector<QPointF> m_temperature;
+    QVector<QPointF> m_weight;
+    QVector<QPointF> m_pressureGoal;
+    QVector<QPointF> m_flowGoal;
+    QVector<QPointF> m_temperatureGoal;
+    double m_maxTime = 0;
+    double m_maxWeight = 0;
+};
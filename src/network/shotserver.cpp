@@ -2,6 +2,8 @@
 #include "webdebuglogger.h"
 #include "webtemplates.h"
 #include "../history/shothistorystorage.h"
+#include "../history/shotexportformat.h"
+#include "../models/seriesdecimator.h"
 #include "../ble/de1device.h"
 #include "../machine/machinestate.h"
 #include "../screensaver/screensavervideomanager.h"
@@ -32,24 +34,46 @@
 #endif
 #include <QCoreApplication>
 #include <QRegularExpression>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QPointer>
+#include <QThreadPool>
 
 #ifdef Q_OS_ANDROID
 #include <QJniObject>
 #endif
 
+// Flow control between a stream's producer thread and its socket on the GUI thread:
+// 'unsent' counts bytes handed over but not yet taken by the OS
+struct ShotServer::StreamState {
+    QMutex mutex;
+    QWaitCondition drained;
+    qint64 unsent = 0;
+    bool closed = false;
+};
+
 ShotServer::ShotServer(ShotHistoryStorage* storage, DE1Device* device, QObject* parent)
     : QObject(parent)
     , m_storage(storage)
     , m_device(device)
+    , m_streamPool(new QThreadPool(this))
 {
     // Timer to cleanup stale connections
     m_cleanupTimer = new QTimer(this);
-    m_cleanupTimer->setInterval(30000);  // Check every 30 seconds
+    m_cleanupTimer->setInterval(5000);  // Check every 5 seconds (keep-alive idle timeout)
     connect(m_cleanupTimer, &QTimer::timeout, this, &ShotServer::cleanupStaleConnections);
+
+    m_streamPool->setMaxThreadCount(MAX_CONCURRENT_STREAMS);
+    m_streamPool->setObjectName("ShotServerStreamPool");
+    // Producers read through the storage - they must be done before it is torn down
+    if (m_storage) {
+        connect(m_storage, &ShotHistoryStorage::closing, this, &ShotServer::closeStreams);
+    }
 }
 
 ShotServer::~ShotServer()
 {
+    closeStreams();
     stop();
     // Cleanup any pending requests
     for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); ++it) {
@@ -132,6 +156,7 @@ void ShotServer::onNewConnection()
         QTcpSocket* socket = m_server->nextPendingConnection();
         connect(socket, &QTcpSocket::readyRead, this, &ShotServer::onReadyRead);
         connect(socket, &QTcpSocket::disconnected, this, &ShotServer::onDisconnected);
+        m_connections[socket].idleSince.start();
         emit clientConnected(socket->peerAddress().toString());
     }
 }
@@ -139,21 +164,39 @@ void ShotServer::onNewConnection()
 void ShotServer::onReadyRead()
 {
     QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
+    if (socket) {
+        readRequest(socket);
+    }
+}
+
+void ShotServer::readRequest(QTcpSocket* socket)
+{
+    auto connIt = m_connections.find(socket);
+    if (connIt == m_connections.end()) return;
+    // Pipelined request: left in the socket until the current response is written
+    // (finishResponse comes back here), so responses go out in request order
+    if (connIt->responding) return;
 
     try {
         PendingRequest& pending = m_pendingRequests[socket];
         pending.lastActivity.start();
 
-        // Read available data
-        QByteArray chunk = socket->readAll();
+        // Read available data, after whatever the previous request left over
+        QByteArray chunk = connIt->carryOver + socket->readAll();
+        connIt->carryOver.clear();
+        if (chunk.isEmpty() && pending.headerData.isEmpty()) {
+            m_pendingRequests.remove(socket);
+            return;
+        }
 
         // If we haven't found headers yet, accumulate header data
         if (pending.headerEnd < 0) {
             pending.headerData.append(chunk);
+            pending.headerEnd = static_cast<int>(pending.headerData.indexOf("\r\n\r\n"));
 
             // Check header size limit
-            if (pending.headerData.size() > MAX_HEADER_SIZE) {
+            if ((pending.headerEnd < 0 && pending.headerData.size() > MAX_HEADER_SIZE) ||
+                pending.headerEnd > MAX_HEADER_SIZE) {
                 qWarning() << "ShotServer: Headers too large, rejecting";
                 sendResponse(socket, 413, "text/plain", "Headers too large");
                 cleanupPendingRequest(socket);
@@ -162,7 +205,6 @@ void ShotServer::onReadyRead()
                 return;
             }
 
-            pending.headerEnd = static_cast<int>(pending.headerData.indexOf("\r\n\r\n"));
             if (pending.headerEnd < 0) {
                 // Headers not complete yet
                 return;
@@ -173,23 +215,57 @@ void ShotServer::onReadyRead()
             QStringList lines = headers.split("\r\n");
             QString requestLine = lines.isEmpty() ? "" : lines.first();
 
-            // Parse Content-Length
+            // Parse Content-Length, Transfer-Encoding and Connection
+            QString connectionHeader;
+            bool contentLengthValid = true;
+            bool hasTransferEncoding = false;
             for (const QString& line : std::as_const(lines)) {
                 if (line.startsWith("Content-Length:", Qt::CaseInsensitive)) {
-                    pending.contentLength = line.mid(15).trimmed().toLongLong();
-                    break;
+                    bool ok = false;
+                    const qint64 length = line.mid(15).trimmed().toLongLong(&ok);
+                    // Repeated headers must agree - the last one must not silently win
+                    contentLengthValid = contentLengthValid && ok && length >= 0 &&
+                                         (pending.contentLength < 0 || pending.contentLength == length);
+                    pending.contentLength = length;
+                } else if (line.startsWith("Transfer-Encoding:", Qt::CaseInsensitive)) {
+                    hasTransferEncoding = true;
+                } else if (line.startsWith("Connection:", Qt::CaseInsensitive)) {
+                    connectionHeader = line.mid(11).trimmed().toLower();
                 }
             }
 
-            if (pending.contentLength < 0) {
-                pending.contentLength = 0;
+            // A body we can't frame would desync every request after it on this connection
+            // (chunked bytes would be parsed as the next pipelined request), so answer and close
+            if (hasTransferEncoding || !contentLengthValid) {
+                qWarning() << "ShotServer:" << (hasTransferEncoding ? "Transfer-Encoding body" : "Invalid Content-Length")
+                           << ", rejecting";
+                pending.keepAlive = false;
+                connIt->keepAlive = false;
+                if (hasTransferEncoding) {
+                    sendResponse(socket, 501, "text/plain", "Transfer-Encoding not supported");
+                } else {
+                    sendResponse(socket, 400, "text/plain", "Invalid Content-Length");
+                }
+                cleanupPendingRequest(socket);
+                m_pendingRequests.remove(socket);
+                socket->close();
+                return;
             }
 
             // Check if this is a media upload (POST to /upload/media)
             pending.isMediaUpload = requestLine.contains("POST") && requestLine.contains("/upload/media");
 
-            // Check upload size limit for media uploads
-            if (pending.isMediaUpload && pending.contentLength > MAX_UPLOAD_SIZE) {
+            // HTTP/1.1 connections persist unless the client says close, HTTP/1.0 only on request.
+            // Media uploads still close - they run for minutes and are followed by a page reload.
+            if (requestLine.endsWith("HTTP/1.1")) {
+                pending.keepAlive = !connectionHeader.contains("close");
+            } else {
+                pending.keepAlive = connectionHeader.contains("keep-alive");
+            }
+            pending.keepAlive = pending.keepAlive && !pending.isMediaUpload;
+
+            // Check upload size limit (media uploads are the largest legitimate bodies)
+            if (pending.contentLength > MAX_UPLOAD_SIZE) {
                 qWarning() << "ShotServer: Upload too large:" << pending.contentLength << "bytes (max:" << MAX_UPLOAD_SIZE << ")";
                 sendResponse(socket, 413, "text/plain",
                     QString("File too large. Maximum size is %1 MB").arg(MAX_UPLOAD_SIZE / (1024*1024)).toUtf8());
@@ -228,8 +304,13 @@ void ShotServer::onReadyRead()
                 qDebug() << "ShotServer: Streaming large upload to" << pending.tempFilePath;
             }
 
-            // Handle any body data that came with headers
+            // Handle any body data that came with headers; bytes past this request's body
+            // belong to the next (pipelined) request
             int bodyStart = pending.headerEnd + 4;
+            if (pending.headerData.size() - bodyStart > pending.contentLength) {
+                connIt->carryOver = pending.headerData.mid(bodyStart + pending.contentLength);
+                pending.headerData.truncate(bodyStart + pending.contentLength);
+            }
             if (bodyStart < pending.headerData.size()) {
                 QByteArray bodyPart = pending.headerData.mid(bodyStart);
                 if (pending.tempFile) {
@@ -243,7 +324,12 @@ void ShotServer::onReadyRead()
 
             chunk.clear();  // Already processed
         } else {
-            // Headers already received, this is body data
+            // Headers already received, this is body data (up to Content-Length)
+            const qint64 remaining = pending.contentLength - pending.bodyReceived;
+            if (chunk.size() > remaining) {
+                connIt->carryOver = chunk.mid(remaining);
+                chunk.truncate(remaining);
+            }
             if (pending.tempFile) {
                 // Stream to temp file
                 pending.tempFile->write(chunk);
@@ -286,6 +372,8 @@ void ShotServer::onReadyRead()
             if (pending.isMediaUpload) {
                 m_activeMediaUploads--;
             }
+            connIt->responding = true;
+            connIt->keepAlive = false;
             m_pendingRequests.remove(socket);
             handleMediaUpload(socket, tempPath, headers);
         } else {
@@ -299,6 +387,8 @@ void ShotServer::onReadyRead()
                     request.append(f.readAll());
                 }
             }
+            connIt->responding = true;
+            connIt->keepAlive = pending.keepAlive;
             cleanupPendingRequest(socket);
             m_pendingRequests.remove(socket);
             handleRequest(socket, request);
@@ -323,6 +413,7 @@ void ShotServer::onDisconnected()
     if (socket) {
         cleanupPendingRequest(socket);
         m_pendingRequests.remove(socket);
+        m_connections.remove(socket);
         socket->deleteLater();
     }
 }
@@ -355,6 +446,14 @@ void ShotServer::cleanupStaleConnections()
             staleConnections.append(it.key());
         }
     }
+    // Connections waiting for their next request past the keep-alive timeout
+    QList<QTcpSocket*> idleConnections;
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        if (!it->responding && !m_pendingRequests.contains(it.key()) &&
+            it->idleSince.elapsed() > KEEPALIVE_TIMEOUT_MS) {
+            idleConnections.append(it.key());
+        }
+    }
 
     for (QTcpSocket* socket : staleConnections) {
         qWarning() << "ShotServer: Cleaning up stale connection from" << socket->peerAddress().toString();
@@ -363,6 +462,10 @@ void ShotServer::cleanupStaleConnections()
         socket->close();
         socket->deleteLater();
     }
+
+    for (QTcpSocket* socket : idleConnections) {
+        socket->disconnectFromHost();  // onDisconnected drops the state
+    }
 }
 
 void ShotServer::onDiscoveryDatagram()
@@ -430,10 +533,10 @@ void ShotServer::handleRequest(QTcpSocket* socket, const QByteArray& request)
 
     // Route requests
     if (path == "/" || path == "/index.html") {
-        sendHtml(socket, generateShotListPage());
+        sendDeferred(socket, "text/html; charset=utf-8", [this]() { return generateShotListPage().toUtf8(); });
     }
     else if (path == "/shots" || path == "/shots/") {
-        sendHtml(socket, generateShotListPage());
+        sendDeferred(socket, "text/html; charset=utf-8", [this]() { return generateShotListPage().toUtf8(); });
     }
     else if (path.startsWith("/compare/")) {
         // /compare/1,2,3 - compare shots with IDs 1, 2, 3
@@ -446,7 +549,7 @@ void ShotServer::handleRequest(QTcpSocket* socket, const QByteArray& request)
             if (ok) ids << id;
         }
         if (ids.size() >= 2) {
-            sendHtml(socket, generateComparisonPage(ids));
+            sendDeferred(socket, "text/html; charset=utf-8", [this, ids]() { return generateComparisonPage(ids).toUtf8(); });
         } else {
             sendResponse(socket, 400, "text/plain", "Need at least 2 shot IDs to compare");
         }
@@ -481,38 +584,163 @@ void ShotServer::handleRequest(QTcpSocket* socket, const QByteArray& request)
         bool ok;
         qint64 shotId = path.mid(6).split("?").first().toLongLong(&ok);
         if (ok) {
-            sendHtml(socket, generateShotDetailPage(shotId));
+            sendDeferred(socket, "text/html; charset=utf-8", [this, shotId]() { return generateShotDetailPage(shotId).toUtf8(); });
         } else {
             sendResponse(socket, 400, "text/plain", "Invalid shot ID");
         }
     }
     else if (path == "/api/shots") {
-        QVariantList shots = m_storage->getShots(0, 1000);
-        QJsonArray arr;
-        for (const QVariant& v : std::as_const(shots)) {
-            arr.append(QJsonObject::fromVariantMap(v.toMap()));
+        sendDeferred(socket, "application/json", [this]() {
+            QVariantList shots = m_storage->getShots(0, 1000);
+            QJsonArray arr;
+            for (const QVariant& v : std::as_const(shots)) {
+                arr.append(QJsonObject::fromVariantMap(v.toMap()));
+            }
+            return QJsonDocument(arr).toJson(QJsonDocument::Compact);
+        });
+    }
+    else if (path.startsWith("/api/shots?")) {
+        // Cursor paging: /api/shots?limit=50&cursor=<nextCursor>&profileName=...
+        // Other query items are passed through as filter keys (see getShotsFiltered)
+        QUrlQuery query(path.mid(path.indexOf("?") + 1));
+        int limit = query.hasQueryItem("limit") ? qBound(1, query.queryItemValue("limit").toInt(), 1000) : 50;
+        QString cursor = query.queryItemValue("cursor", QUrl::FullyDecoded);
+
+        QVariantMap filter;
+        const auto items = query.queryItems(QUrl::FullyDecoded);
+        for (const auto& item : items) {
+            if (item.first != "limit" && item.first != "cursor") {
+                filter.insert(item.first, item.second);
+            }
+        }
+
+        sendDeferred(socket, "application/json", [this, filter, cursor, limit]() {
+            QVariantMap page = m_storage->getShotsPage(filter, cursor, limit);
+            return QJsonDocument(QJsonObject::fromVariantMap(page)).toJson(QJsonDocument::Compact);
+        });
+    }
+    else if (path.startsWith("/api/export?")) {
+        // Full history with decoded curves: /api/export?format=ndjson|csv&<filter keys>
+        QUrlQuery query(path.mid(path.indexOf("?") + 1));
+        QString format = query.queryItemValue("format", QUrl::FullyDecoded);
+        ShotExportFormat::Format exportFormat;
+        if (!ShotExportFormat::parse(format, &exportFormat)) {
+            sendResponse(socket, 400, "application/json", R"({"error":"format must be ndjson or csv"})");
+            return;
+        }
+
+        QVariantMap filter;
+        const auto items = query.queryItems(QUrl::FullyDecoded);
+        for (const auto& item : items) {
+            if (item.first != "format") {
+                filter.insert(item.first, item.second);
+            }
+        }
+
+        QString filename = "shots_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")
+                         + "." + ShotExportFormat::fileExtension(exportFormat);
+        sendStreamed(socket, ShotExportFormat::contentType(exportFormat), filename, [this, format, filter](const StreamWriter& write) {
+            m_storage->streamShots(format, filter, write);
+        });
+    }
+    else if (path.startsWith("/api/search?")) {
+        // Ranked search: /api/search?q=ethiopia&limit=20&cursor=<nextCursor>&beanBrand=...
+        QUrlQuery query(path.mid(path.indexOf("?") + 1));
+        QString text = query.queryItemValue("q", QUrl::FullyDecoded);
+        int limit = query.hasQueryItem("limit") ? qBound(1, query.queryItemValue("limit").toInt(), 1000) : 50;
+        QString cursor = query.queryItemValue("cursor", QUrl::FullyDecoded);
+
+        QVariantMap filter;
+        const auto items = query.queryItems(QUrl::FullyDecoded);
+        for (const auto& item : items) {
+            if (item.first != "q" && item.first != "limit" && item.first != "cursor") {
+                filter.insert(item.first, item.second);
+            }
+        }
+
+        sendDeferred(socket, "application/json", [this, text, filter, cursor, limit]() {
+            QVariantMap page = m_storage->searchShots(text, filter, cursor, limit);
+            return QJsonDocument(QJsonObject::fromVariantMap(page)).toJson(QJsonDocument::Compact);
+        });
+    }
+    else if (path == "/api/stats" || path.startsWith("/api/stats?")) {
+        // /api/stats?groupBy=bean&bucket=month&metrics=count,avg:ratio&profileName=...
+        // See ShotHistoryStorage::aggregate; other query items are filter keys
+        QUrlQuery query(path.mid(path.indexOf("?") + 1));
+        QString groupBy = query.queryItemValue("groupBy", QUrl::FullyDecoded);
+        QString bucket = query.queryItemValue("bucket", QUrl::FullyDecoded);
+        QStringList metrics = query.queryItemValue("metrics", QUrl::FullyDecoded).split(",", Qt::SkipEmptyParts);
+
+        QVariantMap filter;
+        const auto items = query.queryItems(QUrl::FullyDecoded);
+        for (const auto& item : items) {
+            if (item.first != "groupBy" && item.first != "bucket" && item.first != "metrics") {
+                filter.insert(item.first, item.second);
+            }
+        }
+
+        sendDeferred(socket, "application/json", [this, groupBy, bucket, metrics, filter]() {
+            QVariantMap stats = m_storage->aggregate(groupBy, bucket, metrics, filter);
+            return QJsonDocument(QJsonObject::fromVariantMap(stats)).toJson(QJsonDocument::Compact);
+        });
+    }
+    else if (path.startsWith("/api/shot/") && path.contains("/series")) {
+        // /api/shot/123/series?maxPoints=64 - downsampled curves for sparklines
+        QString idPart = path.mid(10);
+        idPart = idPart.left(idPart.indexOf("/series"));
+        bool ok;
+        qint64 shotId = idPart.toLongLong(&ok);
+        if (ok) {
+            int maxPoints = 0;
+            if (path.contains("?")) {
+                QUrlQuery query(path.mid(path.indexOf("?") + 1));
+                maxPoints = query.queryItemValue("maxPoints").toInt();
+            }
+            sendDeferred(socket, "application/json", [this, shotId, maxPoints]() {
+                QVariantMap series = m_storage->getShotSeries(shotId, maxPoints);
+                return QJsonDocument(QJsonObject::fromVariantMap(series)).toJson(QJsonDocument::Compact);
+            });
+        } else {
+            sendResponse(socket, 400, "application/json", R"({"error":"Invalid shot ID"})");
         }
-        sendJson(socket, QJsonDocument(arr).toJson(QJsonDocument::Compact));
     }
     else if (path.startsWith("/api/shot/")) {
         bool ok;
         qint64 shotId = path.mid(10).toLongLong(&ok);
         if (ok) {
-            QVariantMap shot = m_storage->getShot(shotId);
-            sendJson(socket, QJsonDocument(QJsonObject::fromVariantMap(shot)).toJson());
+            sendDeferred(socket, "application/json", [this, shotId]() {
+                QVariantMap shot = m_storage->getShot(shotId);
+                return QJsonDocument(QJsonObject::fromVariantMap(shot)).toJson();
+            });
         } else {
             sendResponse(socket, 400, "application/json", R"({"error":"Invalid shot ID"})");
         }
     }
     else if (path == "/api/database" || path == "/database.db") {
-        // Checkpoint WAL to ensure all data is in main .db file before download
-        m_storage->checkpoint();
-        QString dbPath = m_storage->databasePath();
-        sendFile(socket, dbPath, "application/x-sqlite3");
+        sendDatabaseSnapshot(socket);
     }
     else if (path == "/debug") {
         sendHtml(socket, generateDebugPage());
     }
+    else if (path == "/api/database/stats") {
+        sendDeferred(socket, "application/json", [this]() {
+            return QJsonDocument(QJsonObject::fromVariantMap(m_storage->databaseStats())).toJson(QJsonDocument::Compact);
+        });
+    }
+    else if (path == "/api/render/stats") {
+        sendJson(socket, QJsonDocument(QJsonObject::fromVariantMap(SeriesDecimator::stats())).toJson(QJsonDocument::Compact));
+    }
+    else if (path == "/api/database/maintenance") {
+        // POST only, so a prefetcher or crawler following the link can't start a pass
+        if (method != "POST") {
+            sendResponse(socket, 405, "application/json", R"({"error":"POST required"})",
+                         "Allow: POST\r\n");
+        } else if (m_storage->runMaintenance()) {
+            sendJson(socket, R"({"queued":true})");
+        } else {
+            sendResponse(socket, 409, "application/json", R"({"error":"Maintenance only runs while the machine is asleep"})");
+        }
+    }
     else if (path == "/remote") {
         sendHtml(socket, QString(WEB_REMOTE_PAGE));
     }
@@ -784,10 +1012,7 @@ void ShotServer::handleRequest(QTcpSocket* socket, const QByteArray& request)
         }
     }
     else if (path == "/api/backup/shots") {
-        // Checkpoint WAL and send database file (reuse existing logic)
-        m_storage->checkpoint();
-        QString dbPath = m_storage->databasePath();
-        sendFile(socket, dbPath, "application/x-sqlite3");
+        sendDatabaseSnapshot(socket);
     }
     else if (path == "/api/backup/media") {
         handleBackupMediaList(socket);
@@ -810,6 +1035,9 @@ void ShotServer::sendResponse(QTcpSocket* socket, int statusCode, const QString&
         case 200: statusText = "OK"; break;
         case 400: statusText = "Bad Request"; break;
         case 404: statusText = "Not Found"; break;
+        case 405: statusText = "Method Not Allowed"; break;
+        case 409: statusText = "Conflict"; break;
+        case 501: statusText = "Not Implemented"; break;
         default: statusText = "Unknown"; break;
     }
 
@@ -818,7 +1046,20 @@ void ShotServer::sendResponse(QTcpSocket* socket, int statusCode, const QString&
     response.append(QString("Content-Type: %1\r\n").arg(contentType).toUtf8());
     response.append(QString("Content-Length: %1\r\n").arg(body.size()).toUtf8());
     response.append("Access-Control-Allow-Origin: *\r\n");
-    response.append("Connection: close\r\n");
+
+    // Keep the connection for the client's next request unless it asked otherwise,
+    // this is an error outside a request (responding unset) or the connection is used up
+    auto conn = m_connections.constFind(socket);
+    const bool keepAlive = conn != m_connections.constEnd() && conn->responding && conn->keepAlive &&
+                           conn->requestsServed + 1 < MAX_KEEPALIVE_REQUESTS;
+    if (keepAlive) {
+        response.append("Connection: keep-alive\r\n");
+        response.append(QString("Keep-Alive: timeout=%1, max=%2\r\n")
+                            .arg(KEEPALIVE_TIMEOUT_MS / 1000)
+                            .arg(MAX_KEEPALIVE_REQUESTS - conn->requestsServed - 1).toUtf8());
+    } else {
+        response.append("Connection: close\r\n");
+    }
     if (!extraHeaders.isEmpty()) {
         response.append(extraHeaders);
     }
@@ -826,8 +1067,33 @@ void ShotServer::sendResponse(QTcpSocket* socket, int statusCode, const QString&
     response.append(body);
 
     socket->write(response);
-    socket->flush();
-    socket->close();
+    finishResponse(socket, keepAlive);
+}
+
+void ShotServer::finishResponse(QTcpSocket* socket, bool keepAlive)
+{
+    if (!keepAlive) {
+        socket->flush();
+        socket->close();
+        return;
+    }
+
+    HttpConnection& conn = m_connections[socket];
+    conn.responding = false;
+    conn.keepAlive = false;
+    conn.requestsServed++;
+    conn.idleSince.start();
+
+    // A pipelined request may already be buffered (carryOver or unread socket data);
+    // readyRead won't fire again for it. Queued so a synchronous handler doesn't recurse.
+    QPointer<QTcpSocket> target(socket);
+    QMetaObject::invokeMethod(this, [this, target]() {
+        if (!target) return;
+        auto it = m_connections.constFind(target.data());
+        if (it != m_connections.constEnd() && (target->bytesAvailable() > 0 || !it->carryOver.isEmpty())) {
+            readRequest(target);
+        }
+    }, Qt::QueuedConnection);
 }
 
 void ShotServer::sendJson(QTcpSocket* socket, const QByteArray& json)
@@ -840,6 +1106,90 @@ void ShotServer::sendHtml(QTcpSocket* socket, const QString& html)
     sendResponse(socket, 200, "text/html; charset=utf-8", html.toUtf8());
 }
 
+void ShotServer::sendDeferred(QTcpSocket* socket, const QString& contentType, std::function<QByteArray()> produce)
+{
+    // Shot history reads run on the storage read pool so a large page never blocks
+    // the event loop (BLE notifications). The reply is written back on this thread;
+    // if the client disconnected meanwhile the socket is gone and nothing is sent.
+    m_storage->runRead(std::move(produce)).then(socket, [this, socket, contentType](const QByteArray& body) {
+        sendResponse(socket, 200, contentType, body);
+    });
+}
+
+void ShotServer::sendStreamed(QTcpSocket* socket, const QString& contentType, const QString& filename,
+                              std::function<void(const StreamWriter&)> produce)
+{
+    QByteArray header;
+    header.append("HTTP/1.1 200 OK\r\n");
+    header.append(QString("Content-Type: %1\r\n").arg(contentType).toUtf8());
+    header.append("Transfer-Encoding: chunked\r\n");
+    header.append(QString("Content-Disposition: attachment; filename=\"%1\"\r\n").arg(filename).toUtf8());
+    header.append("Access-Control-Allow-Origin: *\r\n");
+    // Exports are one-off downloads - not worth keeping the connection around for
+    header.append("Connection: close\r\n\r\n");
+
+    auto state = std::make_shared<StreamState>();
+    state->unsent = header.size();
+    m_streams.append(state);
+
+    auto release = [state](qint64 bytes, bool closed) {
+        QMutexLocker lock(&state->mutex);
+        state->unsent -= bytes;
+        state->closed = state->closed || closed;
+        state->drained.wakeAll();
+    };
+    connect(socket, &QTcpSocket::bytesWritten, socket, [release](qint64 bytes) { release(bytes, false); });
+    connect(socket, &QTcpSocket::disconnected, socket, [release]() { release(0, true); });
+    connect(socket, &QObject::destroyed, this, [release]() { release(0, true); });
+    socket->write(header);
+
+    // 'this' outlives the producer: closeStreams() waits for it before ShotServer goes away
+    QPointer<QTcpSocket> target(socket);
+    auto write = [this, state, target](const QByteArray& data) -> bool {
+        if (data.isEmpty()) return true;  // A zero-length chunk would end the response
+        QByteArray chunk = QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n";
+        {
+            QMutexLocker lock(&state->mutex);
+            while (!state->closed && state->unsent > STREAM_WINDOW) {
+                state->drained.wait(&state->mutex);
+            }
+            if (state->closed) return false;
+            state->unsent += chunk.size();
+        }
+        QMetaObject::invokeMethod(this, [target, chunk]() {
+            if (target) target->write(chunk);
+        }, Qt::QueuedConnection);
+        return true;
+    };
+
+    m_streamPool->start([this, state, target, produce = std::move(produce), write]() {
+        produce(write);
+        QMetaObject::invokeMethod(this, [this, state, target]() {
+            m_streams.removeOne(state);
+            if (!target) return;
+            {
+                QMutexLocker lock(&state->mutex);
+                if (state->closed) {
+                    target->abort();  // Cut short - no terminating chunk, so it can't pass as complete
+                    return;
+                }
+            }
+            target->write("0\r\n\r\n");
+            target->disconnectFromHost();  // Flushes what is still buffered first
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ShotServer::closeStreams()
+{
+    for (const auto& state : std::as_const(m_streams)) {
+        QMutexLocker lock(&state->mutex);
+        state->closed = true;
+        state->drained.wakeAll();
+    }
+    m_streamPool->waitForDone();
+}
+
 void ShotServer::sendFile(QTcpSocket* socket, const QString& path, const QString& contentType)
 {
     QFile file(path);
@@ -853,6 +1203,29 @@ void ShotServer::sendFile(QTcpSocket* socket, const QString& path, const QString
     sendResponse(socket, 200, contentType, data, extraHeaders);
 }
 
+void ShotServer::sendDatabaseSnapshot(QTcpSocket* socket)
+{
+    // shots.db alone lacks the samples moved to the archive file, so serve a folded
+    // snapshot built on the read pool instead of the live file
+    const QString snapshotPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+        + "/shots_snapshot_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".db";
+    ShotHistoryStorage* storage = m_storage;
+    QPointer<QTcpSocket> target(socket);
+    storage->runRead([storage, snapshotPath]() {
+        return storage->snapshotDatabase(snapshotPath);
+    }).then(this, [this, target, snapshotPath](const QString& error) {
+        if (target) {
+            if (error.isEmpty()) {
+                sendFile(target, snapshotPath, "application/x-sqlite3");
+            } else {
+                qWarning() << "ShotServer: Database snapshot failed:" << error;
+                sendResponse(target, 500, "text/plain", "Failed to snapshot database");
+            }
+        }
+        QFile::remove(snapshotPath);
+    });
+}
+
 QString ShotServer::getLocalIpAddress() const
 {
     // First, try to determine the primary IP by checking which local address
@@ -3030,6 +3403,17 @@ QString ShotServer::generateDebugPage() const
             padding: 1px 0;
         }
         .log-line:hover { background: rgba(255,255,255,0.05); }
+        .db-stats {
+            background: var(--surface);
+            border: 1px solid var(--border);
+            border-radius: 8px;
+            padding: 0.5rem 0.75rem;
+            margin-bottom: 1rem;
+            font-family: "Consolas", "Monaco", "Courier New", monospace;
+            font-size: 12px;
+            color: var(--text-secondary);
+            white-space: pre-wrap;
+        }
         .DEBUG { color: #8b949e; }
         .INFO { color: #58a6ff; }
         .WARN { color: #d29922; }
@@ -3058,7 +3442,10 @@ QString ShotServer::generateDebugPage() const
         <div style="margin-bottom:1rem;display:flex;gap:0.5rem;flex-wrap:wrap;">
             <a href="/database.db" class="btn" style="text-decoration:none;">&#128190; Download Database</a>
             <a href="/upload" class="btn" style="text-decoration:none;">&#128230; Upload APK</a>
+            <button class="btn" onclick="runMaintenance()">&#129529; Run DB Maintenance</button>
         </div>
+        <div class="db-stats" id="dbStats">Loading database stats...</div>
+        <div class="db-stats" id="renderStats"></div>
         <div class="log-container" id="logContainer"></div>
     </main>
     <script>
@@ -3150,9 +3537,59 @@ QString ShotServer::generateDebugPage() const
                 });
         }
 
+        function formatBytes(bytes) {
+            if (bytes >= 1048576) return (bytes / 1048576).toFixed(1) + " MB";
+            return Math.round(bytes / 1024) + " KB";
+        }
+
+        function loadDbStats() {
+            fetch("/api/database/stats")
+                .then(function(r) { return r.json(); })
+                .then(function(s) {
+                    var text = "shots.db " + formatBytes(s.dbBytes || 0) + ", WAL " + formatBytes(s.walBytes || 0) +
+                               ", archive " + formatBytes(s.archiveBytes || 0) + " | " + s.page_count + " pages of " +
+                               s.page_size + " B, " + s.freelist_count + " free | schema v" + s.schemaVersion;
+                    var runs = s.maintenance || [];
+                    if (runs.length === 0) text += "\nMaintenance: never run";
+                    for (var i = 0; i < runs.length; i++) {
+                        var m = runs[i];
+                        text += "\nMaintenance " + new Date(m.startedAt * 1000).toLocaleString() +
+                                (m.cancelled ? " (cancelled)" : "") + ": " + m.durationMs + " ms" +
+                                " [analyze " + (m.analyzeMs || 0) + ", vacuum " + (m.vacuumMs || 0) + " " + (m.vacuum || "") +
+                                (m.vacuumPagesFreed ? " -" + m.vacuumPagesFreed + " pages" : "") +
+                                ", checkpoint " + (m.checkpointMs || 0) + ", integrity " + (m.integrityMs || 0) + "]" +
+                                " pages " + m.pagesBefore + " -> " + m.pagesAfter +
+                                ", free " + m.freePagesBefore + " -> " + m.freePagesAfter +
+                                ", integrity " + (m.integrity || "-");
+                    }
+                    document.getElementById("dbStats").textContent = text;
+                });
+            fetch("/api/render/stats")
+                .then(function(r) { return r.json(); })
+                .then(function(s) {
+                    document.getElementById("renderStats").textContent = s.runs === 0
+                        ? "Chart decimation: not needed yet"
+                        : "Chart decimation: " + s.runs + " runs, " + s.inputPoints + " -> " + s.outputPoints +
+                          " points (" + s.ratio.toFixed(1) + "x), mean " + s.meanUs.toFixed(0) + " us" +
+                          " | last " + s.lastInputPoints + " -> " + s.lastOutputPoints + " in " + s.lastUs.toFixed(0) + " us";
+                });
+        }
+
+        function runMaintenance() {
+            fetch("/api/database/maintenance", { method: "POST" })
+                .then(function(r) {
+                    if (r.status === 409) {
+                        alert("Database maintenance only runs while the machine is asleep");
+                        return;
+                    }
+                    setTimeout(loadDbStats, 2000);
+                });
+        }
+
         // Poll every 500ms
         setInterval(fetchLogs, 500);
         fetchLogs();
+        loadDbStats();
     </script>
 </body>
 </html>
@@ -5410,4 +5847,3 @@ void ShotServer::handleSaveSettings(QTcpSocket* socket, const QByteArray& body)
 
     sendJson(socket, R"({"success": true})");
 }
-
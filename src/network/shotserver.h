@@ -8,6 +8,10 @@
 #include <QFile>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QVariantMap>
+#include <QList>
+#include <functional>
+#include <memory>
 
 class ShotHistoryStorage;
 class DE1Device;
@@ -15,6 +19,7 @@ class MachineState;
 class ScreensaverVideoManager;
 class Settings;
 class ProfileStorage;
+class QThreadPool;
 
 struct PendingRequest {
     QByteArray headerData;          // Only headers stored in memory
@@ -25,6 +30,16 @@ struct PendingRequest {
     QString tempFilePath;           // Path to temp file
     QElapsedTimer lastActivity;     // For timeout tracking
     bool isMediaUpload = false;     // Flag for media upload requests
+    bool keepAlive = false;         // Client allows the connection to be reused
+};
+
+// Per-connection HTTP/1.1 state, kept from accept until disconnect
+struct HttpConnection {
+    QElapsedTimer idleSince;        // Since accept or the last response (keep-alive timeout)
+    QByteArray carryOver;           // Bytes read past the current request (pipelined requests)
+    int requestsServed = 0;
+    bool responding = false;        // Response in progress; later requests wait their turn
+    bool keepAlive = false;         // Current request may be followed by another
 };
 
 class ShotServer : public QObject {
@@ -71,12 +86,28 @@ private slots:
     void onDiscoveryDatagram();
 
 private:
+    void readRequest(QTcpSocket* socket);
+    // Response written: close, or reset for the next request on this connection
+    void finishResponse(QTcpSocket* socket, bool keepAlive);
     void handleRequest(QTcpSocket* socket, const QByteArray& request);
     void sendResponse(QTcpSocket* socket, int statusCode, const QString& contentType,
                       const QByteArray& body, const QByteArray& extraHeaders = QByteArray());
     void sendJson(QTcpSocket* socket, const QByteArray& json);
     void sendHtml(QTcpSocket* socket, const QString& html);
+    // Produce the body off the GUI thread (may call ShotHistoryStorage read methods), then send it
+    void sendDeferred(QTcpSocket* socket, const QString& contentType, std::function<QByteArray()> produce);
     void sendFile(QTcpSocket* socket, const QString& path, const QString& contentType);
+    // Shot database download: a consistent snapshot including archived samples
+    void sendDatabaseSnapshot(QTcpSocket* socket);
+    // Chunked response produced on m_streamPool: produce() calls write() per chunk and is
+    // throttled while more than STREAM_WINDOW bytes are unsent; write() returns false once
+    // the client is gone or closeStreams() ran. Memory stays bounded however long the
+    // response is, and a slow client never holds a storage read pool thread.
+    using StreamWriter = std::function<bool(const QByteArray&)>;
+    void sendStreamed(QTcpSocket* socket, const QString& contentType, const QString& filename,
+                      std::function<void(const StreamWriter&)> produce);
+    // Stop every stream in progress and wait for their producers to return
+    void closeStreams();
 
     QString getLocalIpAddress() const;
     QString generateIndexPage() const;
@@ -123,6 +154,13 @@ private:
     int m_port = 8888;
     int m_activeMediaUploads = 0;
     QHash<QTcpSocket*, PendingRequest> m_pendingRequests;
+    QHash<QTcpSocket*, HttpConnection> m_connections;
+
+    // Streamed responses (exports) - producers block on client backpressure, so they get
+    // their own threads instead of the storage read pool
+    struct StreamState;
+    QThreadPool* m_streamPool = nullptr;
+    QList<std::shared_ptr<StreamState>> m_streams;
 
     // Limits to prevent resource exhaustion
     static constexpr qint64 MAX_HEADER_SIZE = 64 * 1024;           // 64 KB for headers
@@ -130,5 +168,9 @@ private:
     static constexpr qint64 MAX_UPLOAD_SIZE = 500 * 1024 * 1024;   // 500 MB max per file
     static constexpr int MAX_CONCURRENT_UPLOADS = 2;               // Limit concurrent media uploads
     static constexpr int CONNECTION_TIMEOUT_MS = 300000;           // 5 minute timeout
+    static constexpr int KEEPALIVE_TIMEOUT_MS = 15000;             // Idle persistent connection lifetime
+    static constexpr int MAX_KEEPALIVE_REQUESTS = 1000;            // Requests before a connection is closed
     static constexpr int DISCOVERY_PORT = 8889;                    // UDP port for device discovery
+    static constexpr qint64 STREAM_WINDOW = 1024 * 1024;           // Unsent bytes before a stream waits
+    static constexpr int MAX_CONCURRENT_STREAMS = 2;               // Exports produced at once (others queue)
 };
@@ -25,7 +25,9 @@ VisualizerUploader::VisualizerUploader(Settings* settings, QObject* parent)
 // Helper: Interpolate goal data to match elapsed timestamps
 // Goal data may have different timestamps or gaps; we need to align to the master elapsed array
 // Gaps > 0.5s between goal points indicate mode switches (flow/pressure) - return 0 during gaps
-static QJsonArray interpolateGoalData(const QVector<QPointF>& goalData, const QVector<QPointF>& masterData) {
+// Works on QVector<QPointF> (history) and ShotSeriesView (live sample store) alike
+template <typename GoalSeries, typename MasterSeries>
+static QJsonArray interpolateGoalData(const GoalSeries& goalData, const MasterSeries& masterData) {
     QJsonArray result;
 
     if (goalData.isEmpty() || masterData.isEmpty()) {
@@ -40,7 +42,7 @@ static QJsonArray interpolateGoalData(const QVector<QPointF>& goalData, const QV
     constexpr double GAP_THRESHOLD = 0.5;
 
     int goalIdx = 0;
-    for (const auto& masterPt : masterData) {
+    for (const QPointF masterPt : masterData) {
         double t = masterPt.x();
 
         // Find the goal data points surrounding this timestamp
@@ -521,15 +523,14 @@ QByteArray VisualizerUploader::buildShotJson(ShotDataModel* shotData,
 {
     QJsonObject root;
 
-    // Get data from ShotDataModel
+    // Views over ShotDataModel's sample columns - read in place, nothing is copied
     const auto& pressureData = shotData->pressureData();
-    const auto& flowData = shotData->flowData();
-    const auto& temperatureData = shotData->temperatureData();
     const auto& pressureGoalData = shotData->pressureGoalData();
     const auto& flowGoalData = shotData->flowGoalData();
     const auto& temperatureGoalData = shotData->temperatureGoalData();
     const auto& weightFlowData = shotData->weightData();  // Flow rate from scale (g/s)
     const auto& cumulativeWeightData = shotData->cumulativeWeightData();  // Cumulative weight (g)
+    const ShotSampleStore& samples = shotData->samples();
 
     // Use de1app version 2 format
     root["version"] = 2;
@@ -542,16 +543,16 @@ QByteArray VisualizerUploader::buildShotJson(ShotDataModel* shotData,
 
     // Elapsed time array
     QJsonArray elapsed;
-    for (const auto& pt : pressureData) {
-        elapsed.append(pt.x());
+    for (double t : samples.times()) {
+        elapsed.append(t);
     }
     root["elapsed"] = elapsed;
 
     // Pressure object
     QJsonObject pressure;
     QJsonArray pressureValues;
-    for (const auto& pt : pressureData) {
-        pressureValues.append(pt.y());
+    for (float value : samples.column(ShotSampleStore::Pressure)) {
+        pressureValues.append(ShotSeriesView::widen(value));
     }
     pressure["pressure"] = pressureValues;
     // Interpolate goal data to match elapsed timestamps
@@ -561,8 +562,8 @@ QByteArray VisualizerUploader::buildShotJson(ShotDataModel* shotData,
     // Flow object
     QJsonObject flow;
     QJsonArray flowValues;
-    for (const auto& pt : flowData) {
-        flowValues.append(pt.y());
+    for (float value : samples.column(ShotSampleStore::Flow)) {
+        flowValues.append(ShotSeriesView::widen(value));
     }
     flow["flow"] = flowValues;
     // Interpolate goal data to match elapsed timestamps
@@ -576,8 +577,8 @@ QByteArray VisualizerUploader::buildShotJson(ShotDataModel* shotData,
     // Temperature object
     QJsonObject temperature;
     QJsonArray basketValues;
-    for (const auto& pt : temperatureData) {
-        basketValues.append(pt.y());
+    for (float value : samples.column(ShotSampleStore::Temperature)) {
+        basketValues.append(ShotSeriesView::widen(value));
     }
     temperature["basket"] = basketValues;
     // Interpolate goal data to match elapsed timestamps
@@ -0,0 +1,108 @@
+// Re-encodes shots both ways - legacy JSON and columnar - then times decoding every
+// blob and prints bytes and decode time per shot for each format. Reads the newest
+// maxShots shots of a shots.db (hot and archived samples alike) when one is given,
+// otherwise uses synthetic 30 s shots. The database is opened read-only.
+
+#include "history/shothistorystorage.h"
+#include "syntheticshot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+
+namespace {
+
+const QString CONNECTION = QStringLiteral("CodecBench");
+
+// Sample records of the newest maxShots shots, from shots.db and its archive
+QList<ShotRecord> loadRecords(const QString& dbPath, int maxShots)
+{
+    QList<ShotRecord> records;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION);
+        db.setDatabaseName(dbPath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (!db.open()) {
+            qWarning() << "codec_bench: could not open" << dbPath << db.lastError().text();
+        } else {
+            ShotHistoryStorage::attachArchive(db, dbPath, false);
+            QSqlQuery query(db);
+            query.prepare("SELECT data_blob FROM shot_samples_all ORDER BY shot_id DESC, tier LIMIT ?");
+            query.addBindValue(maxShots);
+            if (!query.exec()) {
+                qWarning() << "codec_bench: sample query failed:" << query.lastError().text();
+            }
+            while (query.next()) {
+                ShotRecord record;
+                if (ShotHistoryStorage::decodeSampleData(query.value(0).toByteArray(), &record)) {
+                    records.append(record);
+                }
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(CONNECTION);
+    return records;
+}
+
+// Decodes every blob; returns the elapsed nanoseconds and the total size in bytes
+qint64 measure(const QList<QByteArray>& blobs, qint64* totalBytes)
+{
+    *totalBytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const QByteArray& blob : blobs) {
+        ShotRecord record;
+        ShotHistoryStorage::decodeSampleData(blob, &record);
+        *totalBytes += blob.size();
+    }
+    return timer.nsecsElapsed();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    const QString dbPath = args.size() > 1 ? args.at(1) : QString();
+    const int maxShots = qMax(1, args.size() > 2 ? args.at(2).toInt() : 100);
+
+    QList<ShotRecord> records;
+    if (dbPath.isEmpty()) {
+        for (int i = 0; i < maxShots; ++i) records.append(SyntheticShot::record(30));
+    } else if (QFileInfo::exists(dbPath)) {
+        records = loadRecords(dbPath, maxShots);
+    } else {
+        out << "No such database: " << dbPath << "\n";
+        return 1;
+    }
+    if (records.isEmpty()) {
+        out << "No shots to measure\n";
+        return 1;
+    }
+
+    QList<QByteArray> legacyBlobs, columnarBlobs;
+    for (const ShotRecord& record : std::as_const(records)) {
+        legacyBlobs.append(ShotHistoryStorage::encodeLegacySampleData(record));
+        columnarBlobs.append(ShotHistoryStorage::encodeSampleData(record));
+    }
+
+    qint64 legacyBytes = 0, columnarBytes = 0;
+    const qint64 legacyNs = measure(legacyBlobs, &legacyBytes);
+    const qint64 columnarNs = measure(columnarBlobs, &columnarBytes);
+    const qsizetype shots = records.size();
+
+    out << shots << " shots" << (dbPath.isEmpty() ? " (synthetic)" : "") << "\n";
+    out << "Legacy JSON: " << legacyBytes / shots << " bytes/shot, "
+        << legacyNs / 1000.0 / shots << " us decode/shot\n";
+    out << "Columnar:    " << columnarBytes / shots << " bytes/shot, "
+        << columnarNs / 1000.0 / shots << " us decode/shot\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "syntheticshot.h"
+
+#include "models/shotdatamodel.h"
+
+#include <QtMath>
+
+namespace SyntheticShot {
+
+Sample sample(int index)
+{
+    Sample s;
+    s.time = index / SAMPLE_HZ;
+    s.frameNumber = 1 + static_cast<int>(s.time / FRAME_SECONDS);
+    s.isFlowMode = s.frameNumber % 2 == 0;
+    s.frameStart = index > 0 && index % static_cast<int>(FRAME_SECONDS * SAMPLE_HZ) == 0;
+    s.pressure = 9.0 * (1.0 - qExp(-s.time / 4.0));
+    s.flow = 2.0 + 0.2 * qSin(s.time);
+    s.temperature = 92.0 + 0.3 * qSin(s.time / 7.0);
+    s.pressureGoal = s.isFlowMode ? 0.0 : 9.0;
+    s.flowGoal = s.isFlowMode ? 2.0 : 0.0;
+    s.temperatureGoal = 92.0;
+    s.weight = 0.2 * s.time + 0.1;
+    return s;
+}
+
+void feed(ShotDataModel* model, int index)
+{
+    const Sample s = sample(index);
+    model->addSample(s.time, s.pressure, s.flow, s.temperature,
+                     s.pressureGoal, s.flowGoal, s.temperatureGoal, s.frameNumber, s.isFlowMode);
+    model->addWeightSample(s.time, s.weight);
+    if (s.frameStart) {
+        model->addPhaseMarker(s.time, QStringLiteral("Frame"), s.frameNumber, s.isFlowMode);
+    }
+}
+
+ShotRecord record(int seconds)
+{
+    ShotRecord record;
+    const int samples = static_cast<int>(seconds * SAMPLE_HZ);
+    for (int i = 0; i < samples; ++i) {
+        const Sample s = sample(i);
+        record.pressure.append(QPointF(s.time, s.pressure));
+        record.flow.append(QPointF(s.time, s.flow));
+        record.temperature.append(QPointF(s.time, s.temperature));
+        record.pressureGoal.append(QPointF(s.time, s.pressureGoal));
+        record.flowGoal.append(QPointF(s.time, s.flowGoal));
+        record.temperatureGoal.append(QPointF(s.time, s.temperatureGoal));
+        record.weight.append(QPointF(s.time, s.weight));
+        if (i == 0 || s.frameStart) {
+            HistoryPhaseMarker marker;
+            marker.time = s.time;
+            marker.label = i == 0 ? QStringLiteral("Start") : QStringLiteral("Frame");
+            marker.frameNumber = s.frameNumber;
+            marker.isFlowMode = s.isFlowMode;
+            record.phases.append(marker);
+        }
+    }
+    record.summary.duration = seconds;
+    return record;
+}
+
+}  // namespace SyntheticShot
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "history/shothistorystorage.h"
+
+class ShotDataModel;
+
+/**
+ * Deterministic synthetic espresso shot for the benchmark tools, so every tool
+ * measures the same data. Samples arrive at the DE1's 5 Hz; frames alternate
+ * between pressure and flow control every 20 s, and the scale reports weight
+ * for every sample.
+ */
+namespace SyntheticShot {
+
+constexpr double SAMPLE_HZ = 5.0;
+constexpr double FRAME_SECONDS = 20.0;
+
+struct Sample {
+    double time = 0;
+    double pressure = 0;
+    double flow = 0;
+    double temperature = 0;
+    double pressureGoal = 0;
+    double flowGoal = 0;
+    double temperatureGoal = 0;
+    double weight = 0;
+    int frameNumber = 0;
+    bool isFlowMode = false;
+    bool frameStart = false;  // First sample of a frame after the first
+};
+
+Sample sample(int index);
+
+// Feed sample 'index' to a model as the controllers would: machine sample, weight,
+// and a phase marker when a new frame starts
+void feed(ShotDataModel* model, int index);
+
+// A whole shot of the given length as a history record
+ShotRecord record(int seconds);
+
+}  // namespace SyntheticShot
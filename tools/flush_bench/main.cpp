@@ -0,0 +1,89 @@
+// Simulates a shot at 5 Hz on offscreen series and times every flush: ShotDataModel's
+// incremental flushToChart against the old full replace() of every series. Prints the
+// mean cost per flush over the first and last 10 s - the incremental path should stay
+// flat however long the shot runs, the replace path grows with it.
+
+#include "models/shotdatamodel.h"
+#include "syntheticshot.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QLineSeries>
+#include <QTextStream>
+
+namespace {
+
+constexpr int WINDOW_SECONDS = 10;
+constexpr int GOAL_SEGMENTS = 5;
+
+QVariantList segmentList(QLineSeries* segments)
+{
+    QVariantList list;
+    for (int i = 0; i < GOAL_SEGMENTS; ++i) list.append(QVariant::fromValue<QObject*>(&segments[i]));
+    return list;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    const int seconds = qMax(2 * WINDOW_SECONDS, args.size() > 1 ? args.at(1).toInt() : 180);
+    const int samples = static_cast<int>(seconds * SyntheticShot::SAMPLE_HZ);
+    const int window = static_cast<int>(WINDOW_SECONDS * SyntheticShot::SAMPLE_HZ);
+
+    // Same data through both paths: the model (incremental) and a plain replace() per flush
+    ShotDataModel model;
+    QLineSeries pressure, flow, temperature, temperatureGoal, weight, marker;
+    QLineSeries pressureGoals[GOAL_SEGMENTS], flowGoals[GOAL_SEGMENTS];
+    model.registerSeries(&pressure, &flow, &temperature, segmentList(pressureGoals), segmentList(flowGoals),
+                         &temperatureGoal, &weight, &marker, {});
+    // No graphWindow: flushes are driven by the loop below
+
+    QLineSeries replacePressure, replaceFlow, replaceTemperature, replaceTemperatureGoal, replaceWeight;
+    QLineSeries replacePressureGoal, replaceFlowGoal;
+
+    qint64 incrementalFirst = 0, incrementalLast = 0, incrementalTotal = 0;
+    qint64 replaceFirst = 0, replaceLast = 0, replaceTotal = 0;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < samples; ++i) {
+        SyntheticShot::feed(&model, i);
+
+        timer.start();
+        // flushToChart is a private slot, normally driven by the graph window's frames
+        QMetaObject::invokeMethod(&model, "flushToChart", Qt::DirectConnection);
+        const qint64 incremental = timer.nsecsElapsed();
+
+        timer.start();
+        replacePressure.replace(model.pressureData().toVector());
+        replaceFlow.replace(model.flowData().toVector());
+        replaceTemperature.replace(model.temperatureData().toVector());
+        replacePressureGoal.replace(model.pressureGoalData().toVector());
+        replaceFlowGoal.replace(model.flowGoalData().toVector());
+        replaceTemperatureGoal.replace(model.temperatureGoalData().toVector());
+        replaceWeight.replace(model.weightData().toVector());
+        const qint64 full = timer.nsecsElapsed();
+
+        incrementalTotal += incremental;
+        replaceTotal += full;
+        if (i < window) {
+            incrementalFirst += incremental;
+            replaceFirst += full;
+        } else if (i >= samples - window) {
+            incrementalLast += incremental;
+            replaceLast += full;
+        }
+    }
+
+    auto meanUs = [window](qint64 nanos) { return nanos / 1000.0 / window; };
+    out << seconds << " s shot, " << samples << " flushes\n";
+    out << "Incremental: " << meanUs(incrementalFirst) << " -> " << meanUs(incrementalLast)
+        << " us/flush (first -> last " << WINDOW_SECONDS << " s), " << incrementalTotal / 1e6 << " ms total\n";
+    out << "Full replace: " << meanUs(replaceFirst) << " -> " << meanUs(replaceLast)
+        << " us/flush (first -> last " << WINDOW_SECONDS << " s), " << replaceTotal / 1e6 << " ms total\n";
+    return 0;
+}
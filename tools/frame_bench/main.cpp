@@ -0,0 +1,143 @@
+// Replays a shot at 5 Hz into a ShotGraph-equivalent QChart (software rendered, as on
+// iOS / Windows debug) and into a ShotChartItem, timing the per-frame CPU cost of each:
+// series flush + scene raster vs. node update. Prints the mean frame cost over the
+// first and last 10 s of the shot, plus totals.
+
+#include "models/shotchartitem.h"
+#include "models/shotdatamodel.h"
+#include "syntheticshot.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+#include <QSGNode>
+#include <QTextStream>
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+
+namespace {
+
+constexpr int WINDOW_SECONDS = 10;
+constexpr int WIDTH = 1024;
+constexpr int HEIGHT = 480;
+
+// Drives the item's paint node update without a window or render thread
+class BenchChartItem : public ShotChartItem {
+public:
+    using ShotChartItem::updatePaintNode;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    const int seconds = qMax(2 * WINDOW_SECONDS, args.size() > 1 ? args.at(1).toInt() : 180);
+    const int frames = static_cast<int>(seconds * SyntheticShot::SAMPLE_HZ);
+    const int window = static_cast<int>(WINDOW_SECONDS * SyntheticShot::SAMPLE_HZ);
+
+    ShotDataModel model;
+
+    // ShotGraph equivalent: QtCharts series fed by the model, scene rendered in software
+    QChart chart;
+    chart.legend()->hide();
+    auto* timeAxis = new QValueAxis;
+    auto* pressureAxis = new QValueAxis;
+    auto* tempAxis = new QValueAxis;
+    auto* weightAxis = new QValueAxis;
+    pressureAxis->setRange(0, 12);
+    tempAxis->setRange(80, 100);
+    weightAxis->setRange(0, 40);
+    chart.addAxis(timeAxis, Qt::AlignBottom);
+    chart.addAxis(pressureAxis, Qt::AlignLeft);
+    chart.addAxis(tempAxis, Qt::AlignRight);
+    chart.addAxis(weightAxis, Qt::AlignRight);
+
+    auto addSeries = [&](QAbstractAxis* yAxis) {
+        auto* series = new QLineSeries;
+        chart.addSeries(series);
+        series->attachAxis(timeAxis);
+        series->attachAxis(yAxis);
+        return series;
+    };
+    QLineSeries* pressure = addSeries(pressureAxis);
+    QLineSeries* flow = addSeries(pressureAxis);
+    QLineSeries* temperature = addSeries(tempAxis);
+    QLineSeries* temperatureGoal = addSeries(tempAxis);
+    QLineSeries* weight = addSeries(weightAxis);
+    QLineSeries* marker = addSeries(pressureAxis);
+    QVariantList pressureGoals, flowGoals, frameMarkers;
+    for (int i = 0; i < 5; ++i) {
+        pressureGoals.append(QVariant::fromValue<QObject*>(addSeries(pressureAxis)));
+        flowGoals.append(QVariant::fromValue<QObject*>(addSeries(pressureAxis)));
+    }
+    for (int i = 0; i < 10; ++i) {
+        frameMarkers.append(QVariant::fromValue<QObject*>(addSeries(pressureAxis)));
+    }
+    model.registerSeries(pressure, flow, temperature, pressureGoals, flowGoals,
+                         temperatureGoal, weight, marker, frameMarkers);
+    // The software path is the one that hurts (iOS, Windows debug, devices without usable GL)
+    for (QAbstractSeries* series : chart.series()) {
+        series->setUseOpenGL(false);
+    }
+
+    QGraphicsScene scene;
+    scene.addItem(&chart);
+    chart.resize(WIDTH, HEIGHT);
+    QImage image(WIDTH, HEIGHT, QImage::Format_ARGB32_Premultiplied);
+
+    BenchChartItem item;
+    item.setSize(QSizeF(WIDTH, HEIGHT));
+    item.setModel(&model);
+    QSGNode* node = nullptr;
+
+    qint64 chartFirst = 0, chartLast = 0, chartTotal = 0;
+    qint64 nativeFirst = 0, nativeLast = 0, nativeTotal = 0;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < frames; ++i) {
+        SyntheticShot::feed(&model, i);
+        const double timeMax = qMax(5.0, SyntheticShot::sample(i).time * 1.02);
+
+        timer.start();
+        timeAxis->setRange(0, timeMax);
+        // flushToChart is a private slot, normally driven by the graph window's frames
+        QMetaObject::invokeMethod(&model, "flushToChart", Qt::DirectConnection);
+        {
+            QPainter painter(&image);
+            scene.render(&painter);
+        }
+        const qint64 chartNs = timer.nsecsElapsed();
+
+        timer.start();
+        item.setTimeMax(timeMax);
+        node = item.updatePaintNode(node, nullptr);
+        const qint64 nativeNs = timer.nsecsElapsed();
+
+        chartTotal += chartNs;
+        nativeTotal += nativeNs;
+        if (i < window) {
+            chartFirst += chartNs;
+            nativeFirst += nativeNs;
+        } else if (i >= frames - window) {
+            chartLast += chartNs;
+            nativeLast += nativeNs;
+        }
+    }
+    delete node;
+    scene.removeItem(&chart);
+
+    auto meanUs = [window](qint64 nanos) { return nanos / 1000.0 / window; };
+    out << seconds << " s shot, " << frames << " frames at " << WIDTH << "x" << HEIGHT << "\n";
+    out << "QtCharts: " << meanUs(chartFirst) << " -> " << meanUs(chartLast)
+        << " us/frame (first -> last " << WINDOW_SECONDS << " s), " << chartTotal / 1e6 << " ms total\n";
+    out << "Scene graph: " << meanUs(nativeFirst) << " -> " << meanUs(nativeLast)
+        << " us/frame (first -> last " << WINDOW_SECONDS << " s), " << nativeTotal / 1e6 << " ms total\n";
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Builds a source shots.db with N synthetic 30 s shots (one set-based insert, so
+// setup time stays out of the measurement), then times ShotHistoryStorage's import
+// merging it into an empty database, and again with every shot a duplicate.
+
+#include "history/shothistorystorage.h"
+#include "syntheticshot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace {
+
+const QString SOURCE_CONNECTION = QStringLiteral("ImportBenchSource");
+const QString DEST_CONNECTION = QStringLiteral("ImportBenchDest");
+
+// Creates the shot schema at path the way the app does
+bool createSchema(const QString& path)
+{
+    ShotHistoryStorage storage;
+    return storage.initialize(path);
+}
+
+bool fillSource(QSqlDatabase& db, int shots)
+{
+    const ShotRecord record = SyntheticShot::record(30);
+    const QByteArray blob = ShotHistoryStorage::encodeSampleData(record);
+
+    QSqlQuery query(db);
+    db.transaction();
+    query.prepare(R"(
+        WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < ?)
+        INSERT INTO shots (uuid, timestamp, profile_name, duration_seconds, final_weight, dose_weight,
+                           bean_brand, bean_type, grinder_model, enjoyment)
+        SELECT lower(hex(randomblob(16))), 1600000000 + i * 3600, 'Profile ' || (i % 40), 30.0, 36.0, 18.0,
+               'Roaster ' || (i % 25), 'Bean ' || (i % 120), 'Grinder', 70 + i % 30 FROM n
+    )");
+    query.addBindValue(shots);
+    if (!query.exec()) {
+        qWarning() << "import_bench: shot insert failed:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    query.prepare("INSERT INTO shot_samples (shot_id, sample_count, data_blob, encoding) "
+                  "SELECT id, ?, ?, ? FROM shots");
+    query.addBindValue(record.pressure.size());
+    query.addBindValue(blob);
+    query.addBindValue(ShotHistoryStorage::SAMPLE_ENCODING_COLUMNAR);
+    if (!query.exec()) {
+        qWarning() << "import_bench: sample insert failed:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    for (const HistoryPhaseMarker& marker : record.phases) {
+        query.prepare("INSERT INTO shot_phases (shot_id, time_offset, label, frame_number, is_flow_mode) "
+                      "SELECT id, ?, ?, ?, ? FROM shots");
+        query.addBindValue(marker.time);
+        query.addBindValue(marker.label);
+        query.addBindValue(marker.frameNumber);
+        query.addBindValue(marker.isFlowMode ? 1 : 0);
+        if (!query.exec()) {
+            qWarning() << "import_bench: phase insert failed:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Keep the storage's journal and app data away from a real install
+    app.setApplicationName(QStringLiteral("import_bench"));
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    const int shots = qMax(1, args.size() > 1 ? args.at(1).toInt() : 50000);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        out << "Could not create a temporary directory\n";
+        return 1;
+    }
+    const QString sourcePath = dir.filePath("source.db");
+    const QString destPath = dir.filePath("dest.db");
+    if (!createSchema(sourcePath) || !createSchema(destPath)) {
+        out << "Could not create the shot schema\n";
+        return 1;
+    }
+
+    int exitCode = 0;
+    {
+        QSqlDatabase source = QSqlDatabase::addDatabase("QSQLITE", SOURCE_CONNECTION);
+        source.setDatabaseName(sourcePath);
+        const bool filled = source.open() && fillSource(source, shots);
+        source.close();
+        if (!filled) {
+            out << "Could not fill the source database\n";
+            return 1;
+        }
+    }
+    QSqlDatabase::removeDatabase(SOURCE_CONNECTION);
+
+    {
+        QSqlDatabase dest = QSqlDatabase::addDatabase("QSQLITE", DEST_CONNECTION);
+        dest.setDatabaseName(destPath);
+        if (!dest.open()) {
+            out << "Could not open " << destPath << "\n";
+            return 1;
+        }
+        QSqlQuery(dest).exec("PRAGMA foreign_keys=ON");
+
+        const auto first = ShotHistoryStorage::mergeDatabaseFile(dest, sourcePath, true);
+        const auto again = ShotHistoryStorage::mergeDatabaseFile(dest, sourcePath, true);
+        dest.close();
+
+        if (!first.errorMessage.isEmpty() || !again.errorMessage.isEmpty()) {
+            out << "Import failed: " << first.errorMessage << again.errorMessage << "\n";
+            exitCode = 2;
+        }
+        const double seconds = first.elapsedMs / 1000.0;
+        out << shots << " shots, source " << QFileInfo(sourcePath).size() / 1024 << " KiB\n";
+        out << "Merge into empty: " << first.imported << " imported in " << first.elapsedMs << " ms ("
+            << (seconds > 0 ? qRound(first.imported / seconds) : 0) << " shots/s)\n";
+        out << "Merge again: " << again.skipped << " duplicates skipped in " << again.elapsedMs << " ms\n";
+        if (first.imported != shots || again.skipped != shots) exitCode = 2;
+    }
+    QSqlDatabase::removeDatabase(DEST_CONNECTION);
+    return exitCode;
+}
@@ -0,0 +1,146 @@
+// Fires requests at a running ShotServer, first with a new connection per request
+// (the old Connection: close behaviour), then over persistent connections, then
+// pipelined. Prints requests/s for each.
+// The default path is the web UI's log poll (not logged, so logging doesn't skew it).
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QTextStream>
+
+namespace {
+
+constexpr int MAX_KEEPALIVE_REQUESTS = 1000;  // ShotServer retires a connection after this many
+
+struct Run {
+    qint64 elapsedNs = 0;
+    int completed = 0;
+    int connections = 0;
+};
+
+// One response, framed by Content-Length. Reads line by line so a pipelined
+// response behind it stays in the socket.
+bool readResponse(QTcpSocket& socket, bool* serverCloses)
+{
+    *serverCloses = false;
+    qint64 contentLength = 0;
+    bool statusOk = false;
+    bool statusSeen = false;
+    for (;;) {
+        while (!socket.canReadLine()) {
+            if (!socket.waitForReadyRead(5000)) return false;
+        }
+        const QByteArray line = socket.readLine().trimmed();
+        if (!statusSeen) {
+            statusSeen = true;
+            statusOk = line.startsWith("HTTP/1.1 2");
+            continue;
+        }
+        if (line.isEmpty()) break;
+        const QByteArray lower = line.toLower();
+        if (lower.startsWith("content-length:")) {
+            contentLength = lower.mid(15).trimmed().toLongLong();
+        } else if (lower.startsWith("connection:")) {
+            *serverCloses = lower.contains("close");
+        }
+    }
+    while (contentLength > 0) {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(5000)) return false;
+        contentLength -= socket.read(contentLength).size();
+    }
+    return statusOk;
+}
+
+Run runPerConnection(const QString& host, quint16 port, const QByteArray& request, int requests)
+{
+    Run run;
+    bool closes = false;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < requests; ++i) {
+        QTcpSocket socket;
+        socket.connectToHost(host, port);
+        if (!socket.waitForConnected(5000)) break;
+        run.connections++;
+        socket.write(request);
+        if (!readResponse(socket, &closes)) break;
+        run.completed++;
+    }
+    run.elapsedNs = timer.nsecsElapsed();
+    return run;
+}
+
+// Requests over persistent connections, reconnecting when the server retires one
+Run runPersistent(const QString& host, quint16 port, const QByteArray& request, int requests, int depth)
+{
+    Run run;
+    bool closes = false;
+    QTcpSocket socket;
+    int servedOnConnection = MAX_KEEPALIVE_REQUESTS;  // Forces the first connect
+    QElapsedTimer timer;
+    timer.start();
+    while (run.completed < requests) {
+        const int batch = qMin(depth, requests - run.completed);
+        if (servedOnConnection + batch > MAX_KEEPALIVE_REQUESTS ||
+            socket.state() != QAbstractSocket::ConnectedState) {
+            socket.abort();
+            socket.connectToHost(host, port);
+            if (!socket.waitForConnected(5000)) break;
+            run.connections++;
+            servedOnConnection = 0;
+        }
+        for (int i = 0; i < batch; ++i) {
+            socket.write(request);
+        }
+        int received = 0;
+        while (received < batch && readResponse(socket, &closes)) {
+            received++;
+        }
+        run.completed += received;
+        servedOnConnection = closes ? MAX_KEEPALIVE_REQUESTS : servedOnConnection + received;
+        if (received < batch) break;
+    }
+    run.elapsedNs = timer.nsecsElapsed();
+    return run;
+}
+
+double rate(const Run& run)
+{
+    return run.elapsedNs > 0 ? run.completed * 1e9 / double(run.elapsedNs) : 0.0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+
+    if (args.size() < 2) {
+        out << "Usage: keepalive_bench <host> [port=8888] [requests=2000] "
+               "[path=/api/debug?after=2147483647] [pipelineDepth=8]\n";
+        return 1;
+    }
+    const QString host = args.at(1);
+    const quint16 port = args.size() > 2 ? args.at(2).toUShort() : 8888;
+    const int requests = qMax(1, args.size() > 3 ? args.at(3).toInt() : 2000);
+    const QString path = args.size() > 4 ? args.at(4) : QStringLiteral("/api/debug?after=2147483647");
+    const int pipelineDepth = qBound(1, args.size() > 5 ? args.at(5).toInt() : 8, 64);
+
+    const QByteArray request = "GET " + path.toUtf8() + " HTTP/1.1\r\nHost: " + host.toUtf8() + "\r\n";
+    const Run perConnection = runPerConnection(host, port, request + "Connection: close\r\n\r\n", requests);
+    const Run keepAlive = runPersistent(host, port, request + "\r\n", requests, 1);
+    const Run pipelined = runPersistent(host, port, request + "\r\n", requests, pipelineDepth);
+
+    auto report = [&out](const char* label, const Run& run) {
+        out << label << ": " << run.completed << " requests over " << run.connections << " connections in "
+            << run.elapsedNs / 1e6 << " ms (" << qRound(rate(run)) << " req/s)\n";
+    };
+    out << requests << " x " << path << "\n";
+    report("Connection per request", perConnection);
+    report("Keep-alive", keepAlive);
+    report(QString("Pipelined %1 deep").arg(pipelineDepth).toUtf8().constData(), pipelined);
+    return perConnection.completed == requests && keepAlive.completed == requests &&
+           pipelined.completed == requests ? 0 : 2;
+}